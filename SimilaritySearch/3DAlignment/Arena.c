@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <malloc.h>
+#include <memory.h>
+
+#include "ds.h"
+
+// a linear allocator for the scratch memory of a model:
+	// once for each thread	: CreateArena()
+	// then for each model	: ArenaReset(), and ArenaAlloc() (or ArenaMark() ... ArenaRelease()) for each buffer
+	// at last				: FreeArena()
+// if "Base" is full, the block is allocated by malloc() and kept until ArenaRelease() of an earlier mark or ArenaReset(),
+// which enlarges "Base" to the most bytes used, so that there is no allocation in the steady state
+
+#define ARENA_ALIGN		16
+
+LFD_API pArena CreateArena(int Size)
+{
+	pArena		ar;
+
+	ar = (pArena) malloc(sizeof(Arena));
+	ar->Size = ( Size + ARENA_ALIGN - 1 ) & ~(ARENA_ALIGN - 1);
+	ar->Base = (unsigned char *) malloc(ar->Size);
+	ar->Used = ar->Peak = 0;
+	ar->Extra = NULL;
+
+	return ar;
+}
+
+// all blocks are given back
+LFD_API void ArenaReset(pArena ar)
+{
+	pArenaBlock		b;
+
+	while( (b = ar->Extra) != NULL )
+	{
+		ar->Extra = b->next;
+		free(b);
+	}
+	if( ar->Peak > ar->Size )
+	{
+		free(ar->Base);
+		ar->Size = ar->Peak;
+		ar->Base = (unsigned char *) malloc(ar->Size);
+	}
+	ar->Used = ar->Peak = 0;
+}
+
+LFD_API void FreeArena(pArena ar)
+{
+	ArenaReset(ar);
+	free(ar->Base);
+	free(ar);
+}
+
+// "Bytes" aligned to 16 bytes, not initialized
+LFD_API void *ArenaAlloc(pArena ar, int Bytes)
+{
+	pArenaBlock		b;
+	void			*p;
+
+	Bytes = ( Bytes + ARENA_ALIGN - 1 ) & ~(ARENA_ALIGN - 1);
+	if( ar->Used + Bytes > ar->Peak )
+		ar->Peak = ar->Used + Bytes;
+	if( ar->Used + Bytes <= ar->Size )
+	{
+		p = ar->Base + ar->Used;
+		ar->Used += Bytes;
+		return p;
+	}
+
+	// the header keeps the alignment of the block
+	b = (pArenaBlock) malloc(ARENA_ALIGN + Bytes);
+	b->next = ar->Extra;
+	b->Mark = ar->Used;
+	ar->Extra = b;
+	ar->Used += Bytes;
+	return (unsigned char *)b + ARENA_ALIGN;
+}
+
+// the same with ArenaAlloc(), and set to 0
+LFD_API void *ArenaCalloc(pArena ar, int Bytes)
+{
+	void			*p;
+
+	p = ArenaAlloc(ar, Bytes);
+	memset(p, 0, Bytes);
+	return p;
+}
+
+// the blocks allocated after ArenaMark() are given back by ArenaRelease()
+LFD_API int ArenaMark(pArena ar)
+{
+	return ar->Used;
+}
+
+LFD_API void ArenaRelease(pArena ar, int Mark)
+{
+	pArenaBlock		b;
+
+	while( (b = ar->Extra) != NULL && b->Mark >= Mark )
+	{
+		ar->Extra = b->next;
+		free(b);
+	}
+	ar->Used = Mark;
+}
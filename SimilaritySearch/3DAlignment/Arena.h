@@ -0,0 +1,7 @@
+LFD_API pArena CreateArena(int Size);
+LFD_API void ArenaReset(pArena ar);
+LFD_API void FreeArena(pArena ar);
+LFD_API void *ArenaAlloc(pArena ar, int Bytes);
+LFD_API void *ArenaCalloc(pArena ar, int Bytes);
+LFD_API int ArenaMark(pArena ar);
+LFD_API void ArenaRelease(pArena ar, int Mark);
@@ -0,0 +1,83 @@
+#include <memory.h>
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+#include "ds.h"
+
+// packed silhouette: one bit for each pixel, 1 is foreground (the pixel < 255 in depth buffer)
+// pixel (x, y) is bit (x & 63) of Mask[y * MASK_WORDS + (x >> 6)], rows in the same order of the depth buffer
+
+// number of bits set
+int BitCount64(unsigned __int64 w)
+{
+#ifdef __GNUC__
+	return __builtin_popcountll(w);
+#elif defined(_M_X64) && defined(__AVX__)
+	// popcnt instruction, there is no CPU supporting AVX without it
+	return (int)__popcnt64(w);
+#else
+	w = w - ((w >> 1) & 0x5555555555555555);
+	w = (w & 0x3333333333333333) + ((w >> 2) & 0x3333333333333333);
+	w = (w + (w >> 4)) & 0x0f0f0f0f0f0f0f0f;
+	return (int)((w * 0x0101010101010101) >> 56);
+#endif
+}
+
+// index of the lowest bit set, w must not be 0
+int LowBit64(unsigned __int64 w)
+{
+#ifdef __GNUC__
+	return __builtin_ctzll(w);
+#else
+	int		n = 0;
+
+	if( (w & 0xffffffff) == 0 )	{	n += 32;	w >>= 32;	}
+	if( (w & 0xffff) == 0 )		{	n += 16;	w >>= 16;	}
+	if( (w & 0xff) == 0 )		{	n += 8;		w >>= 8;	}
+	if( (w & 0xf) == 0 )		{	n += 4;		w >>= 4;	}
+	if( (w & 0x3) == 0 )		{	n += 2;		w >>= 2;	}
+	if( (w & 0x1) == 0 )			n += 1;
+	return n;
+#endif
+}
+
+// index of the highest bit set, w must not be 0
+int HighBit64(unsigned __int64 w)
+{
+#ifdef __GNUC__
+	return 63 - __builtin_clzll(w);
+#else
+	int		n = 0;
+
+	if( w >> 32 )	{	n += 32;	w >>= 32;	}
+	if( w >> 16 )	{	n += 16;	w >>= 16;	}
+	if( w >> 8 )	{	n += 8;		w >>= 8;	}
+	if( w >> 4 )	{	n += 4;		w >>= 4;	}
+	if( w >> 2 )	{	n += 2;		w >>= 2;	}
+	if( w >> 1 )		n += 1;
+	return n;
+#endif
+}
+
+// depth buffer (WIDTH * HEIGHT) to packed silhouette
+LFD_API void PackMask(unsigned __int64 *Mask, unsigned char *Y)
+{
+	int		i, TotalSize;
+
+	TotalSize = WIDTH * HEIGHT;
+	memset(Mask, 0, HEIGHT * MASK_WORDS * sizeof(unsigned __int64));
+	for(i=0; i<TotalSize; i++)
+		if( Y[i] < 255 )
+			Mask[i>>6] |= (unsigned __int64)1 << (i & 63);
+}
+
+// packed silhouette to image, foreground is 0 and background is 255
+LFD_API void UnpackMask(unsigned char *Y, unsigned __int64 *Mask)
+{
+	int		i, TotalSize;
+
+	TotalSize = WIDTH * HEIGHT;
+	for(i=0; i<TotalSize; i++)
+		Y[i] = ( Mask[i>>6] >> (i & 63) ) & 1 ? 0 : 255;
+}
@@ -0,0 +1,5 @@
+int BitCount64(unsigned __int64 w);
+int LowBit64(unsigned __int64 w);
+int HighBit64(unsigned __int64 w);
+LFD_API void PackMask(unsigned __int64 *Mask, unsigned char *Y);
+LFD_API void UnpackMask(unsigned char *Y, unsigned __int64 *Mask);
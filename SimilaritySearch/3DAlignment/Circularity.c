@@ -1,37 +1,15 @@
+#include <math.h>
 #include "ds.h"
-#include "edge.h"
-#include "Bitmap.h"
+#include "Span.h"
 
 #define		PI4		12.5663704
 
-char fn[100];
-int c=0;
-
-LFD_API double Circularity(unsigned char *srcBuff, int width, int height, unsigned char *edge)
+static double AreaToCircularity(double A, double p)
 {
-	int		TotalSize = width * height;
-	int		i, A, p;
 	double	cir;
 
-	A = 0;		// area
-	for(i=0; i<TotalSize; i++)
-		if( srcBuff[i] < 255 )
-			A ++;
-
-//sprintf(fn, "%02d.bmp", c++);
-//WriteBitmap8(srcBuff, width, height, fn);
-//	EdgeDetectSil(srcBuff, width, height);
-//sprintf(fn, "%03d.bmp", c++);
-//WriteBitmap8(srcBuff, width, height, fn);
-
-	p = 0;		// perimeter
-	for(i=0; i<TotalSize; i++)
-		if( edge[i] < 255 )
-			p ++;
-
 // define in MPEG-7, range [0~110], not good
 //return (double)(p*p)/(double)A;
-
 	if( p>0 )
 	{
 		cir = PI4 * A / ( p * p );
@@ -42,5 +20,20 @@ LFD_API double Circularity(unsigned char *srcBuff, int width, int height, unsign
 		cir = 0;		// if render nothing (bad)
 
 	return cir;
+}
 
+// the perimeter is the number of edge pixels of EdgeDetectSil(), from the spans of silhouette
+LFD_API double CircularitySpan(pSilSpans sp, pSilStats st)
+{
+	return AreaToCircularity(st->count, SpanPerimeter(sp));
+}
+
+// from the chain code of the outer contour (FourierDescriptor() of the same view), no edge image is needed
+// the perimeter is the number of moves, or the diagonal moves are weighted by sqrt(2) if "diagonal"
+// multi-part silhouettes use the span circularity (CircularitySpan()), because the chain is of one part only
+LFD_API double CircularityContour(pContourStats cs, int diagonal, pSilSpans sp, pSilStats st)
+{
+	if( cs->MultiPart )
+		return CircularitySpan(sp, st);
+	return AreaToCircularity(cs->area, cs->NumStraight + cs->NumDiagonal * ( diagonal ? sqrt(2.0) : 1.0 ));
 }
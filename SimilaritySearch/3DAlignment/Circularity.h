@@ -1 +1,2 @@
-LFD_API double Circularity(unsigned char *srcBuff, int width, int height, unsigned char *edge);
+LFD_API double CircularitySpan(pSilSpans sp, pSilStats st);
+LFD_API double CircularityContour(pContourStats cs, int diagonal, pSilSpans sp, pSilStats st);
@@ -0,0 +1,352 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include <memory.h>
+#include <math.h>
+
+#include "ds.h"
+#include "Mesh.h"
+#include "Thread.h"
+
+// clean a mesh after loading, CAD exports have the vertices of a seam once for each face, and triangles of zero area:
+//		1. weld the vertices within a tolerance, the neighbors are found by a spatial hash of cells of the tolerance
+//		2. remove the degenerate triangles, and the triangles of the same vertices with an earlier one
+//		3. remove the vertices not used by any triangle
+// the order of the vertices and the triangles is kept, and a vertex is welded to the first vertex within the tolerance,
+// so that the result is the same with any number of threads
+
+#define	CLEAN_CHUNK			65536				// vertices or triangles of a job
+#define	CLEAN_PARALLEL		(4 * CLEAN_CHUNK)	// smaller meshes are cleaned by one thread
+
+typedef struct CleanJob_ {
+	pMesh			m;
+	double			eps;					// welding distance, 0 welds the same positions only
+	double			InvEps, Origin[3];		// cells of the grid
+	double			MinArea2;				// triangles of (2 * area)^2 not larger than this are degenerate
+	int				reach;					// neighbor cells searched around a vertex, 0 if eps is 0
+	// vertices sorted by the slot of their cells, the vertices of a slot are in ascending order
+	unsigned int	*Slot;					// NumVer
+	int				*Start;					// HashSize + 1, the first of each slot in Order
+	int				*Order;					// NumVer
+	unsigned int	HashSize;				// power of 2
+	int				*Remap;					// the first vertex within eps of each vertex, itself if none,
+											// and then the new index of the vertices after compaction
+	unsigned char	*Keep;					// NumTri, 0 if the triangle is removed
+}CleanJob;
+
+// cell of vertex i, the bits of the position if eps is 0 (-0 and 0 are the same cell)
+static void GetCell(CleanJob *job, int i, __int64 c[3])
+{
+	float			p[3], f;
+	unsigned int	bits;
+	int				k;
+
+	p[0] = job->m->x[i];
+	p[1] = job->m->y[i];
+	p[2] = job->m->z[i];
+	for(k=0; k<3; k++)
+		if( job->reach == 0 )
+		{
+			f = p[k] + 0.0f;
+			memcpy(&bits, &f, sizeof(unsigned int));
+			c[k] = bits;
+		}
+		else
+			c[k] = (__int64)floor((p[k] - job->Origin[k]) * job->InvEps);
+}
+
+static unsigned int HashCell(__int64 cx, __int64 cy, __int64 cz)
+{
+	unsigned __int64	h;
+
+	h = (unsigned __int64)cx * 0x9E3779B97F4A7C15ULL;
+	h ^= (unsigned __int64)cy * 0xC2B2AE3D27D4EB4FULL;
+	h ^= (unsigned __int64)cz * 0x165667B19E3779F9ULL;
+	h ^= h >> 29;
+	return (unsigned int)h;
+}
+
+static int IsClose(CleanJob *job, int i, int j)
+{
+	pMesh			m = job->m;
+	double			dx, dy, dz;
+
+	if( job->reach == 0 )
+		return m->x[i] == m->x[j] && m->y[i] == m->y[j] && m->z[i] == m->z[j];
+	dx = (double)m->x[i] - m->x[j];
+	dy = (double)m->y[i] - m->y[j];
+	dz = (double)m->z[i] - m->z[j];
+	return dx * dx + dy * dy + dz * dz <= job->eps * job->eps;
+}
+
+// slot of the cell of each vertex in chunk k
+static void SlotWork(void *Param, int id, int k)
+{
+	CleanJob		*job = (CleanJob *)Param;
+	__int64			c[3];
+	int				i, end;
+
+	end = (k + 1) * CLEAN_CHUNK < job->m->NumVer ? (k + 1) * CLEAN_CHUNK : job->m->NumVer;
+	for(i=k*CLEAN_CHUNK; i<end; i++)
+	{
+		GetCell(job, i, c);
+		job->Slot[i] = HashCell(c[0], c[1], c[2]) & (job->HashSize - 1);
+	}
+}
+
+// the first vertex within eps of each vertex in chunk k, searched in the cells around it
+static void WeldWork(void *Param, int id, int k)
+{
+	CleanJob		*job = (CleanJob *)Param;
+	__int64			c[3];
+	unsigned int	h;
+	int				i, j, s, end, first, dx, dy, dz;
+
+	end = (k + 1) * CLEAN_CHUNK < job->m->NumVer ? (k + 1) * CLEAN_CHUNK : job->m->NumVer;
+	for(i=k*CLEAN_CHUNK; i<end; i++)
+	{
+		GetCell(job, i, c);
+		first = i;
+		for(dx=-job->reach; dx<=job->reach; dx++)
+		for(dy=-job->reach; dy<=job->reach; dy++)
+		for(dz=-job->reach; dz<=job->reach; dz++)
+		{
+			h = HashCell(c[0] + dx, c[1] + dy, c[2] + dz) & (job->HashSize - 1);
+			// ascending in a slot, so that the first one within eps is the smallest of the slot
+			for(s=job->Start[h]; s<job->Start[h+1] && (j=job->Order[s]) < first; s++)
+				if( IsClose(job, i, j) )
+				{
+					first = j;
+					break;
+				}
+		}
+		job->Remap[i] = first;
+	}
+}
+
+// move the triangles in chunk k to the welded vertices, and find the degenerate ones
+static void TriangleWork(void *Param, int id, int k)
+{
+	CleanJob		*job = (CleanJob *)Param;
+	pMesh			m = job->m;
+	unsigned int	*t, a, b, c;
+	double			u[3], v[3], n[3];
+	int				i, end;
+
+	end = (k + 1) * CLEAN_CHUNK < m->NumTri ? (k + 1) * CLEAN_CHUNK : m->NumTri;
+	for(i=k*CLEAN_CHUNK; i<end; i++)
+	{
+		t = m->index + 3 * i;
+		a = t[0] = job->Remap[t[0]];
+		b = t[1] = job->Remap[t[1]];
+		c = t[2] = job->Remap[t[2]];
+		if( a == b || b == c || c == a )
+		{
+			job->Keep[i] = 0;
+			continue;
+		}
+		u[0] = (double)m->x[b] - m->x[a];		v[0] = (double)m->x[c] - m->x[a];
+		u[1] = (double)m->y[b] - m->y[a];		v[1] = (double)m->y[c] - m->y[a];
+		u[2] = (double)m->z[b] - m->z[a];		v[2] = (double)m->z[c] - m->z[a];
+		n[0] = u[1] * v[2] - u[2] * v[1];
+		n[1] = u[2] * v[0] - u[0] * v[2];
+		n[2] = u[0] * v[1] - u[1] * v[0];
+		job->Keep[i] = n[0] * n[0] + n[1] * n[1] + n[2] * n[2] > job->MinArea2;
+	}
+}
+
+// new indexes of the vertices of the triangles in chunk k
+static void IndexWork(void *Param, int id, int k)
+{
+	CleanJob		*job = (CleanJob *)Param;
+	pMesh			m = job->m;
+	int				i, end;
+
+	end = (k + 1) * CLEAN_CHUNK < 3 * m->NumTri ? (k + 1) * CLEAN_CHUNK : 3 * m->NumTri;
+	for(i=k*CLEAN_CHUNK; i<end; i++)
+		m->index[i] = job->Remap[m->index[i]];
+}
+
+static void SortTriangle(unsigned int *t, unsigned int s[3])
+{
+	unsigned int	tmp;
+
+	s[0] = t[0];	s[1] = t[1];	s[2] = t[2];
+	if( s[0] > s[1] )	{	tmp = s[0];	s[0] = s[1];	s[1] = tmp;	}
+	if( s[1] > s[2] )	{	tmp = s[1];	s[1] = s[2];	s[2] = tmp;	}
+	if( s[0] > s[1] )	{	tmp = s[0];	s[0] = s[1];	s[1] = tmp;	}
+}
+
+// remove the triangles of the same vertices with an earlier one (in any order), return the number of them
+static int RemoveDuplicate(CleanJob *job)
+{
+	pMesh			m = job->m;
+	unsigned int	s[3], r[3], h, size;
+	int				*Hash;
+	int				i, n = 0;
+
+	for(size=16; size < 2 * (unsigned int)m->NumTri; size*=2)
+		;
+	Hash = (int *) malloc (size * sizeof(int));
+	memset(Hash, 0, size * sizeof(int));
+	for(i=0; i<m->NumTri; i++)
+	{
+		if( !job->Keep[i] )
+			continue;
+		SortTriangle(m->index + 3 * i, s);
+		for(h=HashCell(s[0], s[1], s[2]) & (size-1); Hash[h]; h=(h+1) & (size-1))
+		{
+			SortTriangle(m->index + 3 * (Hash[h] - 1), r);
+			if( r[0] == s[0] && r[1] == s[1] && r[2] == s[2] )
+				break;
+		}
+		if( Hash[h] )
+		{
+			job->Keep[i] = 0;
+			n ++;
+		}
+		else
+			Hash[h] = i + 1;
+	}
+	free(Hash);
+	return n;
+}
+
+// weld the vertices within "tolerance" (relative to the diagonal of the bounding box, 0 welds the same positions only),
+// remove the degenerate and duplicate triangles, and the vertices not used by any triangle
+// large meshes are cleaned by NumThread threads (0 is the number of processors), info gets the counts if not NULL
+LFD_API void CleanMesh(pMesh m, double tolerance, int NumThread, CleanInfo *info)
+{
+	CleanJob		job;
+	double			MinCoor[3], MaxCoor[3], diag;
+	unsigned int	h;
+	int				i, k, n, NumVerChunk, NumTriChunk, NumIndexChunk;
+	int				Welded = 0, Degenerate = 0, Duplicate = 0;
+
+	if( info )
+	{
+		info->NumVer = m->NumVer;
+		info->NumTri = m->NumTri;
+	}
+
+	if( NumThread <= 0 )
+		NumThread = GetCpuNum();
+	if( m->NumVer + m->NumTri < CLEAN_PARALLEL )
+		NumThread = 1;
+	NumVerChunk = ( m->NumVer + CLEAN_CHUNK - 1 ) / CLEAN_CHUNK;
+	NumTriChunk = ( m->NumTri + CLEAN_CHUNK - 1 ) / CLEAN_CHUNK;
+
+	// the cells are of the welding distance
+	memset(&job, 0, sizeof(CleanJob));
+	job.m = m;
+	for(k=0; k<3; k++)
+	{
+		MinCoor[k] = 1e300;
+		MaxCoor[k] = -1e300;
+	}
+	for(i=0; i<m->NumVer; i++)
+	{
+		if( m->x[i] < MinCoor[0] )	MinCoor[0] = m->x[i];
+		if( m->x[i] > MaxCoor[0] )	MaxCoor[0] = m->x[i];
+		if( m->y[i] < MinCoor[1] )	MinCoor[1] = m->y[i];
+		if( m->y[i] > MaxCoor[1] )	MaxCoor[1] = m->y[i];
+		if( m->z[i] < MinCoor[2] )	MinCoor[2] = m->z[i];
+		if( m->z[i] > MaxCoor[2] )	MaxCoor[2] = m->z[i];
+	}
+	diag = 0;
+	for(k=0; k<3 && m->NumVer>0; k++)
+		diag += ( MaxCoor[k] - MinCoor[k] ) * ( MaxCoor[k] - MinCoor[k] );
+	job.eps = tolerance > 0 ? tolerance * sqrt(diag) : 0;
+	job.reach = job.eps > 0;
+	if( job.reach )
+	{
+		job.InvEps = 1.0 / job.eps;
+		for(k=0; k<3; k++)
+			job.Origin[k] = MinCoor[k];
+	}
+	job.MinArea2 = job.eps * job.eps * job.eps * job.eps;
+
+	// 1. the vertices sorted by the slots of their cells, and the first vertex within eps of each one
+	for(job.HashSize=16; job.HashSize < 2 * (unsigned int)m->NumVer; job.HashSize*=2)
+		;
+	job.Slot = (unsigned int *) malloc ((m->NumVer ? m->NumVer : 1) * sizeof(unsigned int));
+	job.Start = (int *) malloc ((job.HashSize + 1) * sizeof(int));
+	job.Order = (int *) malloc ((m->NumVer ? m->NumVer : 1) * sizeof(int));
+	job.Remap = (int *) malloc ((m->NumVer ? m->NumVer : 1) * sizeof(int));
+	job.Keep = (unsigned char *) malloc ((m->NumTri ? m->NumTri : 1) * sizeof(unsigned char));
+
+	RunJobs(NumThread, NumVerChunk, SlotWork, &job);
+	memset(job.Start, 0, (job.HashSize + 1) * sizeof(int));
+	for(i=0; i<m->NumVer; i++)
+		job.Start[job.Slot[i]+1] ++;
+	for(h=0; h<job.HashSize; h++)
+		job.Start[h+1] += job.Start[h];
+	// the vertices of a slot are in ascending order, Slot[] is the next place of its slot here
+	for(i=0; i<m->NumVer; i++)
+		job.Order[job.Start[job.Slot[i]]++] = i;
+	for(h=job.HashSize; h>0; h--)
+		job.Start[h] = job.Start[h-1];
+	job.Start[0] = 0;
+	RunJobs(NumThread, NumVerChunk, WeldWork, &job);
+	free(job.Slot);
+	free(job.Start);
+	free(job.Order);
+
+	// a vertex is moved to the first one of its chain, which is before it
+	for(i=0; i<m->NumVer; i++)
+		if( job.Remap[i] != i )
+		{
+			job.Remap[i] = job.Remap[job.Remap[i]];
+			Welded ++;
+		}
+
+	// 2. the triangles of the welded vertices, without the degenerate and duplicate ones
+	RunJobs(NumThread, NumTriChunk, TriangleWork, &job);
+	for(i=0; i<m->NumTri; i++)
+		if( !job.Keep[i] )
+			Degenerate ++;
+	Duplicate = RemoveDuplicate(&job);
+	for(i=0, n=0; i<m->NumTri; i++)
+		if( job.Keep[i] )
+		{
+			if( n != i )
+			{
+				m->index[3*n] = m->index[3*i];
+				m->index[3*n+1] = m->index[3*i+1];
+				m->index[3*n+2] = m->index[3*i+2];
+				if( m->Material )
+					m->Material[n] = m->Material[i];
+			}
+			n ++;
+		}
+	m->NumTri = n;
+	free(job.Keep);
+
+	// 3. the vertices used by the triangles, in the same order
+	for(i=0; i<m->NumVer; i++)
+		job.Remap[i] = -1;
+	for(i=0; i<3*m->NumTri; i++)
+		job.Remap[m->index[i]] = 0;
+	for(i=0, n=0; i<m->NumVer; i++)
+		if( job.Remap[i] == 0 )
+		{
+			m->x[n] = m->x[i];
+			m->y[n] = m->y[i];
+			m->z[n] = m->z[i];
+			job.Remap[i] = n ++;
+		}
+	NumIndexChunk = ( 3 * m->NumTri + CLEAN_CHUNK - 1 ) / CLEAN_CHUNK;
+	RunJobs(NumThread, NumIndexChunk, IndexWork, &job);
+	free(job.Remap);
+
+	if( info )
+	{
+		info->Welded = Welded;
+		info->Unreferenced = m->NumVer - Welded - n;
+		info->Degenerate = Degenerate;
+		info->Duplicate = Duplicate;
+	}
+	m->NumVer = n;
+	TrimMaterial(m);
+}
@@ -0,0 +1 @@
+LFD_API void CleanMesh(pMesh m, double tolerance, int NumThread, CleanInfo *info);
@@ -1,6 +1,9 @@
 #include "ds.h"
 #include <stdio.h>
 #include <float.h>
+#include <malloc.h>
+#include "BitMask.h"
+#include "Thread.h"
 
 // Y Cb Cr
 double		ColorQuant[NUM_BINS][3] = { {16,145.338745,130.35675}, {16,232.913361,110.241875}, {16,159.62886,113.335052}, {16,116.436996,161.139404}, {16,191.701538,117.329231}, {16,122.648651,139.378372}, {16,173.231567,134.234985}, {16,123.987244,115.811806}, {144,75.237114,171.206192}, {144,97.367981,192.967697}, {144,74.389954,144.218903}, {144,145.439423,108.722794}, {144,101.211136,121.337814}, {144,126.956009,135.119095}, {144,104.02697,158.534225}, {144,175.581299,85.562805}, {80,99.153519,120.484306}, {80,90.457397,155.219727}, {80,191.679169,161.522919}, {80,179.630203,87.103127}, {80,124.204079,150.483521}, {80,155.035553,118.02713}, {80,131.452118,106.519249}, {80,100.848488,188.258133}, {208,16.5,158.320007}, {208,93.840477,137.627792}, {208,86.498314,161.25}, {208,112.241837,152.784866}, {208,64.122246,146.410828}, {208,132.158478,129.667084}, {208,144.561203,105.438805}, {208,106.067795,115.644066}, {48,103.464394,186.472137}, {48,104.118896,134.20401}, {48,186.751877,152.651627}, {48,203.301697,99.239548}, {48,113.30777,158.490158}, {48,115.372551,110.165115}, {48,141.001846,133.632401}, {48,161.815826,105.376053}, {176,101.22065,120.176117}, {176,55.446564,170.893127}, {176,71.792206,141.844162}, {176,99.270424,179.252106}, {176,86.5877,158.480362}, {176,158.94017,97.337608}, {176,134.888199,116.797226}, {176,115.911545,146.571732}, {112,76.475319,146.482376}, {112,147.214554,111.342636}, {112,100.020294,145.749664}, {112,179.014664,87.226059}, {112,89.045067,173.908798}, {112,126.587914,151.940659}, {112,106.692589,119.621223}, {112,110.508881,194.33757}, {240,12.102564,146.641022}, {240,102.453514,120.362808}, {240,70.724808,140.379852}, {240,112.050362,139.103119}, {240,91.427086,140.304688}, {240,134.297729,109.581818}, {240,43.7551,141.857147}, {240,130.689453,129.478516} };
@@ -28,6 +31,72 @@ int quantized_color_index(unsigned char *yuvBuff)
 	return min_index;
 }
 
+// nearest bin of the cells of YUV, 6 bits for each channel (4x4x4 values in a cell)
+// the region of a bin is convex, so all values in a cell are in the bin if its 8 corners are
+// (ties go to the smaller index, and the difference of two distances is linear in the cell),
+// BIN_SPLIT if the cell crosses the boundary of bins and quantized_color_index() is needed
+// the table is built by the first ColorHistogram() in the lock, the other threads wait for it,
+// and it's published by an interlocked store, so that the flag is never seen before the table
+#define		BIN_SPLIT	255
+static unsigned char	BinTable[64*64*64];
+static volatile __int64	BinTableReady = 0;
+static volatile __int64	BinTableLock = 0;
+
+void GenerateBinTable()
+{
+	unsigned char	*Corner, yuv[3], c;
+	int				y, u, v, i, j, k, n;
+
+	// interlocked read, a full barrier before reading the table
+	if( AtomicCompareExchange64(&BinTableReady, 1, 1) )
+		return ;
+
+	AcquireLock(&BinTableLock);
+	if( AtomicCompareExchange64(&BinTableReady, 1, 1) )
+	{
+		ReleaseLock(&BinTableLock);
+		return ;
+	}
+
+	// bins of the values 4k and 4k+3 of each channel, index is k*2 (+1)
+	Corner = (unsigned char *) malloc(128 * 128 * 128 * sizeof(unsigned char));
+	for(y=0, n=0; y<128; y++)
+		for(u=0; u<128; u++)
+			for(v=0; v<128; v++, n++)
+			{
+				yuv[0] = (unsigned char) ((y>>1) * 4 + (y&1) * 3);
+				yuv[1] = (unsigned char) ((u>>1) * 4 + (u&1) * 3);
+				yuv[2] = (unsigned char) ((v>>1) * 4 + (v&1) * 3);
+				Corner[n] = (unsigned char) quantized_color_index(yuv);
+			}
+
+	for(y=0, n=0; y<64; y++)
+		for(u=0; u<64; u++)
+			for(v=0; v<64; v++, n++)
+			{
+				c = Corner[((2*y) * 128 + 2*u) * 128 + 2*v];
+				for(i=0; i<2; i++)
+					for(j=0; j<2; j++)
+						for(k=0; k<2; k++)
+							if( Corner[((2*y+i) * 128 + 2*u+j) * 128 + 2*v+k] != c )
+								c = BIN_SPLIT;
+				BinTable[n] = c;
+			}
+
+	free(Corner);
+	AtomicCompareExchange64(&BinTableReady, 1, 0);
+	ReleaseLock(&BinTableLock);
+}
+
+// the same with quantized_color_index(), by BinTable
+static int BinIndex(unsigned char *yuvBuff)
+{
+	int		bin;
+
+	bin = BinTable[((yuvBuff[0] >> 2) << 12) | ((yuvBuff[1] >> 2) << 6) | (yuvBuff[2] >> 2)];
+	return ( bin == BIN_SPLIT ) ? quantized_color_index(yuvBuff) : bin;
+}
+
 int ColorHistogram(double *HistogramValue, unsigned char *yuvBuff, int width, int height, unsigned char *mask)
 {
 	int		i, j, k, jj, kk, numpix;
@@ -35,6 +104,8 @@ int ColorHistogram(double *HistogramValue, unsigned char *yuvBuff, int width, in
 	width3 = 3 * width;
 	total3 = width3 * height;
 
+	GenerateBinTable();
+
 	for(i=0; i<NUM_BINS; i++)
 		HistogramValue[i] = 0;
 
@@ -44,7 +115,7 @@ int ColorHistogram(double *HistogramValue, unsigned char *yuvBuff, int width, in
 			// remove background ("white" color in this case)
 			if( mask[jj+kk] < 255 )		// if background, mask==255
 			{
-				HistogramValue[ quantized_color_index(yuvBuff+j+k) ] ++;
+				HistogramValue[ BinIndex(yuvBuff+j+k) ] ++;
 				numpix ++;
 			}
 
@@ -166,15 +237,7 @@ void ExtractCCD(unsigned char *YuvBuff, unsigned __int64 *CCD, unsigned char *Sr
 
 double ColorDistance(unsigned __int64 *dest, unsigned __int64 *src)
 {
-	unsigned __int64	tmp;
-	int					count, i;
-
-	tmp = *dest ^ *src;
-	count = 0;
-	for(i=0; i<NUM_BINS; i++)
-		if( tmp & (0x8000000000000000 >> i) )
-			count ++;
-
-	return count;
+	// number of different bits (NUM_BINS = 64)
+	return BitCount64(*dest ^ *src);
 }
 
@@ -0,0 +1,270 @@
+#include <stdio.h>
+#include <malloc.h>
+#include <memory.h>
+
+#include "ds.h"
+#include "RWObj.h"
+#include "RegionShape.h"
+#include "FourierDescriptor.h"
+#include "ColorDescriptor.h"
+#include "Render.h"
+#include "SilStats.h"
+#include "Span.h"
+#include "Circularity.h"
+#include "Eccentricity.h"
+#include "Thread.h"
+#include "Arena.h"
+
+// extract feature of many models concurrently:
+	// for each thread                  : CreateLfdContext() with its own render backend
+	// then for each model (any thread) : ExtractShape()
+	// at last                          : FreeLfdContext()
+// or extract feature of one model by many threads (lower latency of a query):
+	// for each thread                  : CreateLfdContext() with its own render backend
+	// then for each model              : ExtractShapeViews() with all contexts
+// the LUTs shared by all contexts are built by the first CreateLfdContext() in the lock, the others wait for them,
+// and they are never changed after that
+
+static int				TablesReady = 0;
+static volatile __int64	TablesLock = 0;
+
+// the render backend is not freed
+LFD_API void FreeLfdContext(pLfdContext ctx)
+{
+	int		i;
+
+	for(i=0; i<ANGLE; i++)
+	{
+		free(ctx->CamVertex[i]);
+		free(ctx->CamTriangle[i]);
+	}
+	for(i=0; i<CAMNUM; i++)
+	{
+		free(ctx->srcBuff[i]);
+		free(ctx->MaskBuff[i]);
+		free(ctx->Spans[i]);
+	}
+	free(ctx->Contour);
+	free(ctx->ContourMask);
+	free(ctx->FdSignal);
+	if( ctx->Scratch )
+		FreeArena(ctx->Scratch);
+	free(ctx);
+}
+
+// CamPrefix is the path of the camera set without the number, e.g. "12_" for "12_0" ~ "12_9"
+// return NULL if the camera set can't be read
+LFD_API pLfdContext CreateLfdContext(pRenderBackend rb, char *CamPrefix, int UseMaskRender, int FdResample)
+{
+	pLfdContext		ctx;
+	char			filename[400];
+	int				i;
+
+	AcquireLock(&TablesLock);
+	if( !TablesReady )
+	{
+		GenerateBasisLUT();
+		FourierDescriptorPlan();
+		GenerateBinTable();
+		TablesReady = 1;
+	}
+	ReleaseLock(&TablesLock);
+
+	ctx = (pLfdContext) malloc(sizeof(LfdContext));
+	memset(ctx, 0, sizeof(LfdContext));
+	ctx->Backend = rb;
+	ctx->UseMaskRender = UseMaskRender;
+	ctx->FdResample = FdResample;
+
+	for(i=0; i<ANGLE; i++)
+	{
+		sprintf(filename, "%s%d", CamPrefix, i);
+		if( ReadObj(filename, ctx->CamVertex+i, ctx->CamTriangle+i, ctx->CamNumVer+i, ctx->CamNumTri+i) != 1 )
+		{
+			FreeLfdContext(ctx);
+			return NULL;
+		}
+	}
+
+	for(i=0; i<CAMNUM; i++)
+	{
+		ctx->srcBuff[i] = (unsigned char *) malloc (WIDTH * HEIGHT * sizeof(unsigned char));
+		ctx->MaskBuff[i] = (unsigned __int64 *) malloc (HEIGHT * MASK_WORDS * sizeof(unsigned __int64));
+		ctx->Spans[i] = (pSilSpans) malloc (sizeof(SilSpans));
+	}
+	ctx->Contour = (sPOINT *) malloc (WIDTH * HEIGHT * sizeof(sPOINT));
+	ctx->ContourMask = (unsigned char *) malloc (WIDTH * HEIGHT * sizeof(unsigned char));
+	ctx->FdSignal = (double *) malloc (ANGLE * CAMNUM * FD_SAMPLE * sizeof(double));
+	// enough for Fourier descriptor of the longest contour (WIDTH * HEIGHT points), enlarged by ArenaReset() if not
+	ctx->Scratch = CreateArena(WIDTH * HEIGHT * 24);
+
+	return ctx;
+}
+
+// ART and Fourier descriptor of all views of a model (translated and scaled),
+// and circularity and eccentricity if CirCoeff and EccCoeff are not NULL, the same with 'n' in Main.c
+LFD_API void ExtractShape(pLfdContext ctx, pMesh m,
+						  double ArtCoeff[ANGLE][CAMNUM][ART_ANGULAR][ART_RADIAL], double FdCoeff[ANGLE][CAMNUM][FD_COEFF_NO],
+						  double CirCoeff[ANGLE][CAMNUM], double EccCoeff[ANGLE][CAMNUM])
+{
+	int				i, srcCam;
+	double			*Signal;
+	pContourStats	cs;
+
+	ArenaReset(ctx->Scratch);
+	UploadMesh(ctx->Backend, m);
+	for(srcCam=0; srcCam<ANGLE; srcCam++)
+	{
+		for(i=0; i<CAMNUM; i++)
+			if( ctx->UseMaskRender )
+			{
+				RenderViewMaskMesh(ctx->Backend, ctx->MaskBuff[i], ctx->CamVertex[srcCam]+i, m);
+				GetSpansMask(ctx->MaskBuff[i], ctx->Spans[i]);
+			}
+			else
+			{
+				RenderViewMesh(ctx->Backend, ctx->srcBuff[i], NULL, ctx->CamVertex[srcCam]+i, m);
+				GetSpans(ctx->srcBuff[i], ctx->Spans[i]);
+			}
+		for(i=0; i<CAMNUM; i++)
+			GetSilStatsSpan(ctx->Spans[i], ctx->Stats+i);
+		FindRadius(ctx->Stats);
+		for(i=0; i<CAMNUM; i++)
+			ExtractCoefficientsSpan(ctx->Spans[i], ArtCoeff[srcCam][i], ctx->Stats+i);
+		for(i=0; i<CAMNUM; i++)
+		{
+			Signal = ctx->FdSignal + (srcCam*CAMNUM+i)*FD_SAMPLE;
+			cs = ( CirCoeff && ctx->CirContour ) ? ctx->Chain+i : NULL;
+			if( ctx->FdResample && ctx->UseMaskRender )
+				FourierSignalMask(Signal, ctx->MaskBuff[i], ctx->Contour, ctx->ContourMask, ctx->Stats+i, ctx->Spans[i], cs, ctx->Scratch);
+			else if( ctx->FdResample )
+				FourierSignal(Signal, ctx->srcBuff[i], WIDTH, HEIGHT, ctx->Contour, ctx->ContourMask, ctx->Stats+i, ctx->Spans[i], cs, ctx->Scratch);
+			else if( ctx->UseMaskRender )
+				FourierDescriptorMask(FdCoeff[srcCam][i], ctx->MaskBuff[i], ctx->Contour, ctx->ContourMask, ctx->Stats+i, ctx->Spans[i], cs, ctx->Scratch);
+			else
+				FourierDescriptor(FdCoeff[srcCam][i], ctx->srcBuff[i], WIDTH, HEIGHT, ctx->Contour, ctx->ContourMask, ctx->Stats+i, ctx->Spans[i], cs, ctx->Scratch);
+		}
+		if( EccCoeff )
+			for(i=0; i<CAMNUM; i++)
+				EccCoeff[srcCam][i] = Eccentricity(ctx->Stats+i);
+		if( CirCoeff )
+			for(i=0; i<CAMNUM; i++)
+			{
+				if( ctx->CirContour )
+					CirCoeff[srcCam][i] = CircularityContour(ctx->Chain+i, ctx->CirContour == 2, ctx->Spans[i], ctx->Stats+i);
+				else
+					CirCoeff[srcCam][i] = CircularitySpan(ctx->Spans[i], ctx->Stats+i);
+			}
+	}
+	UnloadMesh(ctx->Backend);
+	if( ctx->FdResample )
+		FourierDescriptorBatch(FdCoeff[0], ctx->FdSignal, ANGLE * CAMNUM, ctx->Scratch);
+}
+
+// the views of a model for ExtractShapeViews(), job "angle * CAMNUM + camera" is a view
+typedef struct ViewJob_ {
+	pLfdContext		*ctx;				// of each worker
+	pMesh			m;
+	SilSpans		*Spans;				// ANGLE * CAMNUM, kept until ART of the angle
+	SilStats		*Stats;
+	ContourStats	*Chain;
+	volatile long	Finish[ANGLE];		// number of views rendered of each angle
+	double			(*ArtCoeff)[CAMNUM][ART_ANGULAR][ART_RADIAL];
+	double			(*FdCoeff)[CAMNUM][FD_COEFF_NO];
+	double			(*CirCoeff)[CAMNUM];
+	double			(*EccCoeff)[CAMNUM];
+}ViewJob;
+
+// render a view and get all features but ART, which needs the radius of all views of the angle,
+// so the worker finishing the last view of an angle gets ART of the angle, while the others render
+static void ViewWork(void *Param, int id, int job)
+{
+	ViewJob			*vj = (ViewJob *)Param;
+	pLfdContext		ctx = vj->ctx[id];
+	int				i, angle, cam;
+	pSilSpans		sp = vj->Spans + job;
+	pSilStats		st = vj->Stats + job;
+	pContourStats	cs;
+	double			*Signal;
+
+	angle = job / CAMNUM;
+	cam = job % CAMNUM;
+	if( ctx->UseMaskRender )
+	{
+		RenderViewMaskMesh(ctx->Backend, ctx->MaskBuff[0], ctx->CamVertex[angle]+cam, vj->m);
+		GetSpansMask(ctx->MaskBuff[0], sp);
+	}
+	else
+	{
+		RenderViewMesh(ctx->Backend, ctx->srcBuff[0], NULL, ctx->CamVertex[angle]+cam, vj->m);
+		GetSpans(ctx->srcBuff[0], sp);
+	}
+	GetSilStatsSpan(sp, st);
+
+	// the views are written to different parts of the signals of ctx[0]
+	Signal = vj->ctx[0]->FdSignal + job * FD_SAMPLE;
+	cs = ( vj->CirCoeff && ctx->CirContour ) ? vj->Chain+job : NULL;
+	if( ctx->FdResample && ctx->UseMaskRender )
+		FourierSignalMask(Signal, ctx->MaskBuff[0], ctx->Contour, ctx->ContourMask, st, sp, cs, ctx->Scratch);
+	else if( ctx->FdResample )
+		FourierSignal(Signal, ctx->srcBuff[0], WIDTH, HEIGHT, ctx->Contour, ctx->ContourMask, st, sp, cs, ctx->Scratch);
+	else if( ctx->UseMaskRender )
+		FourierDescriptorMask(vj->FdCoeff[angle][cam], ctx->MaskBuff[0], ctx->Contour, ctx->ContourMask, st, sp, cs, ctx->Scratch);
+	else
+		FourierDescriptor(vj->FdCoeff[angle][cam], ctx->srcBuff[0], WIDTH, HEIGHT, ctx->Contour, ctx->ContourMask, st, sp, cs, ctx->Scratch);
+	if( vj->EccCoeff )
+		vj->EccCoeff[angle][cam] = Eccentricity(st);
+	if( vj->CirCoeff )
+	{
+		if( ctx->CirContour )
+			vj->CirCoeff[angle][cam] = CircularityContour(cs, ctx->CirContour == 2, sp, st);
+		else
+			vj->CirCoeff[angle][cam] = CircularitySpan(sp, st);
+	}
+
+	// the increment is a full barrier, so the views of the other workers are ready for the last one
+	if( AtomicFetchInc(vj->Finish+angle) == CAMNUM-1 )
+	{
+		FindRadius(vj->Stats + angle * CAMNUM);
+		for(i=0; i<CAMNUM; i++)
+			ExtractCoefficientsSpan(vj->Spans + angle * CAMNUM + i, vj->ArtCoeff[angle][i], vj->Stats + angle * CAMNUM + i);
+	}
+}
+
+// the same with ExtractShape(), but the ANGLE * CAMNUM views are rendered by NumThread workers at the same time,
+// ctx[i] is the context of worker i (each one has its own render backend), and all of them have the same options
+// the signals of "FdResample" are kept by ctx[0]
+LFD_API void ExtractShapeViews(pLfdContext *ctx, int NumThread, pMesh m,
+							   double ArtCoeff[ANGLE][CAMNUM][ART_ANGULAR][ART_RADIAL], double FdCoeff[ANGLE][CAMNUM][FD_COEFF_NO],
+							   double CirCoeff[ANGLE][CAMNUM], double EccCoeff[ANGLE][CAMNUM])
+{
+	ViewJob			vj;
+	int				i;
+
+	vj.ctx = ctx;
+	vj.m = m;
+	// the views are kept by the arena of ctx[0], which is used by worker 0 (the calling thread) only
+	ArenaReset(ctx[0]->Scratch);
+	vj.Spans = (SilSpans *) ArenaAlloc(ctx[0]->Scratch, (int)(ANGLE * CAMNUM * sizeof(SilSpans)));
+	vj.Stats = (SilStats *) ArenaAlloc(ctx[0]->Scratch, (int)(ANGLE * CAMNUM * sizeof(SilStats)));
+	vj.Chain = (ContourStats *) ArenaAlloc(ctx[0]->Scratch, (int)(ANGLE * CAMNUM * sizeof(ContourStats)));
+	for(i=0; i<ANGLE; i++)
+		vj.Finish[i] = 0;
+	vj.ArtCoeff = ArtCoeff;
+	vj.FdCoeff = FdCoeff;
+	vj.CirCoeff = CirCoeff;
+	vj.EccCoeff = EccCoeff;
+
+	for(i=0; i<NumThread; i++)
+	{
+		if( i > 0 )
+			ArenaReset(ctx[i]->Scratch);
+		UploadMesh(ctx[i]->Backend, m);
+	}
+	RunJobs(NumThread, ANGLE * CAMNUM, ViewWork, &vj);
+	for(i=0; i<NumThread; i++)
+		UnloadMesh(ctx[i]->Backend);
+
+	if( ctx[0]->FdResample )
+		FourierDescriptorBatch(FdCoeff[0], ctx[0]->FdSignal, ANGLE * CAMNUM, ctx[0]->Scratch);
+}
@@ -0,0 +1,8 @@
+LFD_API pLfdContext CreateLfdContext(pRenderBackend rb, char *CamPrefix, int UseMaskRender, int FdResample);
+LFD_API void FreeLfdContext(pLfdContext ctx);
+LFD_API void ExtractShape(pLfdContext ctx, pMesh m,
+						  double ArtCoeff[ANGLE][CAMNUM][ART_ANGULAR][ART_RADIAL], double FdCoeff[ANGLE][CAMNUM][FD_COEFF_NO],
+						  double CirCoeff[ANGLE][CAMNUM], double EccCoeff[ANGLE][CAMNUM]);
+LFD_API void ExtractShapeViews(pLfdContext *ctx, int NumThread, pMesh m,
+							   double ArtCoeff[ANGLE][CAMNUM][ART_ANGULAR][ART_RADIAL], double FdCoeff[ANGLE][CAMNUM][FD_COEFF_NO],
+							   double CirCoeff[ANGLE][CAMNUM], double EccCoeff[ANGLE][CAMNUM]);
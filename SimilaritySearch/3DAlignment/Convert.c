@@ -1,23 +1,73 @@
 #include "ds.h"
 
+// SIMD for 4 pixels at a time, the same double arithmetic with the scalar one (no fused multiply-add),
+// so the result is exactly the same
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define YUV_SSE2
+#endif
+
+static void YuvPixel(unsigned char *yuv, unsigned char *rgb)
+{
+	// Y
+	yuv[0] = (unsigned char) (0.299*rgb[0] + 0.587*rgb[1] + 0.114 * rgb[2]);
+	// U = 0.493(B-Y)
+	// Cb = B-Y
+	yuv[1] = 128 + (unsigned char) (-0.16874*rgb[0] - 0.33126*rgb[1] + 0.5 * rgb[2]);
+	// V = 0.877(R-Y)
+	// Cr = R-Y
+	yuv[2] = 128 + (unsigned char) (0.5*rgb[0] - 0.41869 *rgb[1] -0.08131 * rgb[2]);
+}
+
+#ifdef YUV_SSE2
+// truncate 2+2 channel values to 4 integers
+static __m128i Truncate4(__m128d lo, __m128d hi)
+{
+	return _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi));
+}
+
+// a * r + b * g + c * b of 2 pixels
+static __m128d Combine2(__m128d r, __m128d g, __m128d b, double a, double bb, double c)
+{
+	return _mm_add_pd(_mm_add_pd(_mm_mul_pd(_mm_set1_pd(a), r), _mm_mul_pd(_mm_set1_pd(bb), g)), _mm_mul_pd(_mm_set1_pd(c), b));
+}
+#endif
+
 void  RGB_To_YUV(unsigned char *yuvBuff, unsigned char *rgbBuff, int width, int height)
 {
+	int		i, total;
+#ifdef YUV_SSE2
+	int		k, out[3][4];
+	__m128i	r, g, b, off;
+	__m128d	rl, rh, gl, gh, bl, bh;
+#endif
 
-	int		i, j, total, width3;
+	total = width * height;
+	i = 0;
+#ifdef YUV_SSE2
+	// the negative value of -0.16874*R - 0.33126*G + 0.5*B or 0.5*R - 0.41869*G - 0.08131*B is > -128,
+	// so truncation to integer and adding 128 is the same with the scalar one
+	off = _mm_set1_epi32(128);
+	for(; i+4<=total; i+=4)
+	{
+		r = _mm_setr_epi32(rgbBuff[3*i  ], rgbBuff[3*i+3], rgbBuff[3*i+6], rgbBuff[3*i+9 ]);
+		g = _mm_setr_epi32(rgbBuff[3*i+1], rgbBuff[3*i+4], rgbBuff[3*i+7], rgbBuff[3*i+10]);
+		b = _mm_setr_epi32(rgbBuff[3*i+2], rgbBuff[3*i+5], rgbBuff[3*i+8], rgbBuff[3*i+11]);
+		rl = _mm_cvtepi32_pd(r);	rh = _mm_cvtepi32_pd(_mm_srli_si128(r, 8));
+		gl = _mm_cvtepi32_pd(g);	gh = _mm_cvtepi32_pd(_mm_srli_si128(g, 8));
+		bl = _mm_cvtepi32_pd(b);	bh = _mm_cvtepi32_pd(_mm_srli_si128(b, 8));
 
-	width3 = 3 * width;
-	total = width3 * height;
-	for(i=0; i<total; i+=width3)
-		for(j=0; j<width3; j+=3)
+		_mm_storeu_si128((__m128i *)out[0], Truncate4(Combine2(rl, gl, bl, 0.299, 0.587, 0.114), Combine2(rh, gh, bh, 0.299, 0.587, 0.114)));
+		_mm_storeu_si128((__m128i *)out[1], _mm_add_epi32(off, Truncate4(Combine2(rl, gl, bl, -0.16874, -0.33126, 0.5), Combine2(rh, gh, bh, -0.16874, -0.33126, 0.5))));
+		_mm_storeu_si128((__m128i *)out[2], _mm_add_epi32(off, Truncate4(Combine2(rl, gl, bl, 0.5, -0.41869, -0.08131), Combine2(rh, gh, bh, 0.5, -0.41869, -0.08131))));
+		for(k=0; k<4; k++)
 		{
-			// Y
-			yuvBuff[i+j  ] = (unsigned char) (0.299*rgbBuff[i+j] + 0.587*rgbBuff[i+j+1] + 0.114 * rgbBuff[i+j+2]);
-			// U = 0.493(B-Y)
-			// Cb = B-Y
-			yuvBuff[i+j+1] = 128 + (unsigned char) (-0.16874*rgbBuff[i+j] - 0.33126*rgbBuff[i+j+1] + 0.5 * rgbBuff[i+j+2]);
-			// V = 0.877(R-Y)
-			// Cr = R-Y
-			yuvBuff[i+j+2] = 128 + (unsigned char) (0.5*rgbBuff[i+j] - 0.41869 *rgbBuff[i+j+1] -0.08131 * rgbBuff[i+j+2]);
+			yuvBuff[3*(i+k)  ] = (unsigned char) out[0][k];
+			yuvBuff[3*(i+k)+1] = (unsigned char) out[1][k];
+			yuvBuff[3*(i+k)+2] = (unsigned char) out[2][k];
 		}
+	}
+#endif
+	for(; i<total; i++)
+		YuvPixel(yuvBuff+3*i, rgbBuff+3*i);
 }
-
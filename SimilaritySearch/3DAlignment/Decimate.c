@@ -0,0 +1,525 @@
+#include <stdlib.h>
+#include <malloc.h>
+#include <memory.h>
+#include <math.h>
+#include <float.h>
+
+#include "ds.h"
+
+// quadric error metric simplification (Garland and Heckbert 1997) by edge collapse
+// the silhouette of a model is its outline, so the edges at the outline of a surface patch
+// (boundary edges, which CAD faces are full of) and sharp edges are protected by
+// constraint planes perpendicular to the faces, with a large weight
+
+#define	BOUNDARY_WEIGHT		1000.0		// weight of constraint plane of boundary edge
+#define	SHARP_WEIGHT		100.0		// weight of constraint plane of sharp edge
+#define	SHARP_COS			0.5			// the edge is sharp if the angle of two face normal > 60 degree
+
+// a candidate of edge collapse, the heap is ordered by cost
+typedef struct Collapse_ {
+	double			cost;
+	int				a, b;
+	int				stamp;		// version[a] + version[b] when pushed, out of date if changed
+}Collapse;
+
+// an edge of a face, used to find boundary and sharp edges
+typedef struct FaceEdge_ {
+	int				a, b;		// a < b
+	int				face;
+}FaceEdge;
+
+// the mesh during simplification
+typedef struct DMesh_ {
+	double			*pos;		// 3 * nv
+	double			*Q;			// quadric of each vertex, 10 * nv
+	int				*alive, *version;
+	int				nv;
+	int				*f;			// 3 * nf, vertex of each triangle
+	int				*mat;		// material of each triangle
+	int				*fAlive;
+	int				nf, live;
+	int				**vf, *vfNum, *vfMax;	// faces of each vertex
+	Collapse		*heap;
+	int				HeapNum, HeapMax;
+	int				*mark;		// to collect neighbor vertex
+	int				MarkStamp;
+}DMesh;
+
+// quadric of plane n.p + d = 0 with weight w, symmetric 4x4 matrix in 10 doubles
+static void AddPlane(double *q, double *n, double d, double w)
+{
+	q[0] += w * n[0] * n[0];	q[1] += w * n[0] * n[1];	q[2] += w * n[0] * n[2];	q[3] += w * n[0] * d;
+	q[4] += w * n[1] * n[1];	q[5] += w * n[1] * n[2];	q[6] += w * n[1] * d;
+	q[7] += w * n[2] * n[2];	q[8] += w * n[2] * d;
+	q[9] += w * d * d;
+}
+
+static double QuadricError(double *q, double *p)
+{
+	return	q[0]*p[0]*p[0] + 2*q[1]*p[0]*p[1] + 2*q[2]*p[0]*p[2] + 2*q[3]*p[0]
+		+	q[4]*p[1]*p[1] + 2*q[5]*p[1]*p[2] + 2*q[6]*p[1]
+		+	q[7]*p[2]*p[2] + 2*q[8]*p[2]
+		+	q[9];
+}
+
+static void Cross(double *a, double *b, double *c)
+{
+	c[0] = a[1]*b[2] - a[2]*b[1];
+	c[1] = a[2]*b[0] - a[0]*b[2];
+	c[2] = a[0]*b[1] - a[1]*b[0];
+}
+
+// normal of triangle (p0, p1, p2), return twice of the area
+static double FaceNormal(double *p0, double *p1, double *p2, double *n)
+{
+	double		e1[3], e2[3], len;
+	int			k;
+
+	for(k=0; k<3; k++)
+	{
+		e1[k] = p1[k] - p0[k];
+		e2[k] = p2[k] - p0[k];
+	}
+	Cross(e1, e2, n);
+	len = sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+	if( len > 0 )
+		for(k=0; k<3; k++)
+			n[k] /= len;
+	return len;
+}
+
+// the position of minimum error, or the best one of a, b and the middle if the quadric is singular
+static double OptimalPosition(DMesh *m, int a, int b, double *p)
+{
+	double		q[10], det, e, MinErr, c[3];
+	int			i, k;
+
+	for(i=0; i<10; i++)
+		q[i] = m->Q[10*a+i] + m->Q[10*b+i];
+
+	// A p = -b, A = | q0 q1 q2 |
+	//				 | q1 q4 q5 |
+	//				 | q2 q5 q7 |
+	det =	q[0] * (q[4]*q[7] - q[5]*q[5])
+		-	q[1] * (q[1]*q[7] - q[5]*q[2])
+		+	q[2] * (q[1]*q[5] - q[4]*q[2]);
+	if( fabs(det) > 1e-12 * (fabs(q[0]) + fabs(q[4]) + fabs(q[7])) * (fabs(q[0]) + fabs(q[4]) + fabs(q[7])) * (fabs(q[0]) + fabs(q[4]) + fabs(q[7])) )
+	{
+		p[0] = -(	q[3] * (q[4]*q[7] - q[5]*q[5])
+				-	q[1] * (q[6]*q[7] - q[5]*q[8])
+				+	q[2] * (q[6]*q[5] - q[4]*q[8]) ) / det;
+		p[1] = -(	q[0] * (q[6]*q[7] - q[8]*q[5])
+				-	q[3] * (q[1]*q[7] - q[5]*q[2])
+				+	q[2] * (q[1]*q[8] - q[6]*q[2]) ) / det;
+		p[2] = -(	q[0] * (q[4]*q[8] - q[5]*q[6])
+				-	q[1] * (q[1]*q[8] - q[6]*q[2])
+				+	q[3] * (q[1]*q[5] - q[4]*q[2]) ) / det;
+		return QuadricError(q, p);
+	}
+
+	MinErr = DBL_MAX;
+	for(i=0; i<3; i++)
+	{
+		for(k=0; k<3; k++)
+			c[k] = i==0 ? m->pos[3*a+k] : ( i==1 ? m->pos[3*b+k] : (m->pos[3*a+k] + m->pos[3*b+k]) / 2 );
+		e = QuadricError(q, c);
+		if( e < MinErr )
+		{
+			MinErr = e;
+			p[0] = c[0];	p[1] = c[1];	p[2] = c[2];
+		}
+	}
+	return MinErr;
+}
+
+static void HeapPush(DMesh *m, int a, int b)
+{
+	Collapse	c, tmp;
+	double		p[3];
+	int			i, parent;
+
+	c.a = a;
+	c.b = b;
+	c.stamp = m->version[a] + m->version[b];
+	c.cost = OptimalPosition(m, a, b, p);
+
+	if( m->HeapNum == m->HeapMax )
+	{
+		m->HeapMax *= 2;
+		m->heap = (Collapse *) realloc (m->heap, m->HeapMax * sizeof(Collapse));
+	}
+	i = m->HeapNum++;
+	m->heap[i] = c;
+	while( i > 0 )
+	{
+		parent = (i-1) / 2;
+		if( m->heap[parent].cost <= m->heap[i].cost )
+			break;
+		tmp = m->heap[parent];	m->heap[parent] = m->heap[i];	m->heap[i] = tmp;
+		i = parent;
+	}
+}
+
+static Collapse HeapPop(DMesh *m)
+{
+	Collapse	top, tmp;
+	int			i, l, r, s;
+
+	top = m->heap[0];
+	m->heap[0] = m->heap[--m->HeapNum];
+	i = 0;
+	while( 1 )
+	{
+		l = 2*i + 1;
+		r = l + 1;
+		s = i;
+		if( l < m->HeapNum && m->heap[l].cost < m->heap[s].cost )	s = l;
+		if( r < m->HeapNum && m->heap[r].cost < m->heap[s].cost )	s = r;
+		if( s == i )
+			break;
+		tmp = m->heap[s];	m->heap[s] = m->heap[i];	m->heap[i] = tmp;
+		i = s;
+	}
+	return top;
+}
+
+static void AddVertexFace(DMesh *m, int v, int face)
+{
+	if( m->vfNum[v] == m->vfMax[v] )
+	{
+		m->vfMax[v] = m->vfMax[v] ? 2 * m->vfMax[v] : 8;
+		m->vf[v] = (int *) realloc (m->vf[v], m->vfMax[v] * sizeof(int));
+	}
+	m->vf[v][m->vfNum[v]++] = face;
+}
+
+static int CompareFaceEdge(const void *p1, const void *p2)
+{
+	FaceEdge	*e1 = (FaceEdge *)p1, *e2 = (FaceEdge *)p2;
+
+	if( e1->a != e2->a )	return e1->a < e2->a ? -1 : 1;
+	if( e1->b != e2->b )	return e1->b < e2->b ? -1 : 1;
+	return e1->face - e2->face;
+}
+
+// plane through edge (a, b) and perpendicular to the face, added to quadric of a and b
+static void AddConstraint(DMesh *m, int a, int b, int face, double weight)
+{
+	double		n[3], e[3], c[3], len, d;
+	int			*fv, k;
+
+	fv = m->f + 3*face;
+	FaceNormal(m->pos+3*fv[0], m->pos+3*fv[1], m->pos+3*fv[2], n);
+	for(k=0; k<3; k++)
+		e[k] = m->pos[3*b+k] - m->pos[3*a+k];
+	Cross(e, n, c);
+	len = sqrt(c[0]*c[0] + c[1]*c[1] + c[2]*c[2]);
+	if( len == 0 )
+		return;
+	for(k=0; k<3; k++)
+		c[k] /= len;
+	d = -(c[0]*m->pos[3*a] + c[1]*m->pos[3*a+1] + c[2]*m->pos[3*a+2]);
+	// weight by squared length, so that it is in the same unit with area of face
+	weight *= e[0]*e[0] + e[1]*e[1] + e[2]*e[2];
+	AddPlane(m->Q+10*a, c, d, weight);
+	AddPlane(m->Q+10*b, c, d, weight);
+}
+
+// collapse b to a at p is rejected if any face around them is flipped
+static int IsFlipped(DMesh *m, int a, int b, double *p)
+{
+	double		n0[3], n1[3], *q[3];
+	int			i, j, k, v, face, *fv, list[2];
+
+	list[0] = a;
+	list[1] = b;
+	for(i=0; i<2; i++)
+	{
+		v = list[i];
+		for(j=0; j<m->vfNum[v]; j++)
+		{
+			face = m->vf[v][j];
+			if( !m->fAlive[face] )
+				continue;
+			fv = m->f + 3*face;
+			// this face will be removed
+			if( (fv[0]==a || fv[1]==a || fv[2]==a) && (fv[0]==b || fv[1]==b || fv[2]==b) )
+				continue;
+			if( FaceNormal(m->pos+3*fv[0], m->pos+3*fv[1], m->pos+3*fv[2], n0) == 0 )
+				continue;
+			for(k=0; k<3; k++)
+				q[k] = fv[k]==v ? p : m->pos+3*fv[k];
+			if( FaceNormal(q[0], q[1], q[2], n1) == 0 )
+				return 1;
+			if( n0[0]*n1[0] + n0[1]*n1[1] + n0[2]*n1[2] < 0.2 )
+				return 1;
+		}
+	}
+	return 0;
+}
+
+// number of live faces of edge (a, b)
+static int EdgeFaceNum(DMesh *m, int a, int b)
+{
+	int			j, n, *fv;
+
+	for(j=0, n=0; j<m->vfNum[a]; j++)
+	{
+		fv = m->f + 3*m->vf[a][j];
+		if( m->fAlive[m->vf[a][j]] && (fv[0]==b || fv[1]==b || fv[2]==b) )
+			n ++;
+	}
+	return n;
+}
+
+// collapse (a, b) is rejected if it removes a face whose 3 edges are all boundary edges,
+// the face isn't connected to any other one (e.g. a triangle soup), and its area is lost from the silhouette
+static int IsIsolated(DMesh *m, int a, int b)
+{
+	int			j, *fv;
+
+	for(j=0; j<m->vfNum[a]; j++)
+	{
+		if( !m->fAlive[m->vf[a][j]] )
+			continue;
+		fv = m->f + 3*m->vf[a][j];
+		if( !(fv[0]==b || fv[1]==b || fv[2]==b) )
+			continue;
+		if( EdgeFaceNum(m, fv[0], fv[1]) == 1 && EdgeFaceNum(m, fv[1], fv[2]) == 1 && EdgeFaceNum(m, fv[2], fv[0]) == 1 )
+			return 1;
+	}
+	return 0;
+}
+
+static void CollapseEdge(DMesh *m, int a, int b, double *p)
+{
+	int			i, j, k, face, *fv, n;
+
+	for(k=0; k<3; k++)
+		m->pos[3*a+k] = p[k];
+	for(i=0; i<10; i++)
+		m->Q[10*a+i] += m->Q[10*b+i];
+	m->alive[b] = 0;
+	m->version[a] ++;
+
+	for(j=0; j<m->vfNum[b]; j++)
+	{
+		face = m->vf[b][j];
+		if( !m->fAlive[face] )
+			continue;
+		fv = m->f + 3*face;
+		if( fv[0]==a || fv[1]==a || fv[2]==a )
+		{
+			m->fAlive[face] = 0;
+			m->live --;
+		}
+		else
+		{
+			for(k=0; k<3; k++)
+				if( fv[k] == b )
+					fv[k] = a;
+			AddVertexFace(m, a, face);
+		}
+	}
+	free(m->vf[b]);
+	m->vf[b] = NULL;
+	m->vfNum[b] = m->vfMax[b] = 0;
+
+	// remove dead faces of a
+	for(j=0, n=0; j<m->vfNum[a]; j++)
+		if( m->fAlive[m->vf[a][j]] )
+			m->vf[a][n++] = m->vf[a][j];
+	m->vfNum[a] = n;
+
+	// only Q[a] is changed, so only the edges of a are out of date (by version[a]) and pushed again with the new cost,
+	// the edges between two neighbors keep their cost and stay in the heap
+	m->MarkStamp ++;
+	m->mark[a] = m->MarkStamp;
+	for(j=0; j<m->vfNum[a]; j++)
+	{
+		fv = m->f + 3*m->vf[a][j];
+		for(k=0; k<3; k++)
+			if( m->mark[fv[k]] != m->MarkStamp )
+			{
+				m->mark[fv[k]] = m->MarkStamp;
+				HeapPush(m, a, fv[k]);
+			}
+	}
+}
+
+// simplify the mesh to at most "target" triangles, the vertices and triangles are replaced in place,
+// and the materials are kept
+// the mesh should be welded (CleanMesh()), the separate triangles are kept, so a triangle soup isn't simplified
+// return the number of triangles, or 0 if the mesh is not changed (already no more than target)
+LFD_API int DecimateMesh(pMesh mesh, int target)
+{
+	DMesh		m;
+	FaceEdge	*edge;
+	Collapse	c;
+	double		p[3], n0[3], n1[3];
+	int			i, j, k, ne, a, b, *fv, *remap, NewNumVer, NewNumTri;
+
+	if( mesh->NumTri <= target || target < 1 )
+		return 0;
+
+	memset(&m, 0, sizeof(DMesh));
+	m.nv = mesh->NumVer;
+	m.pos = (double *) malloc (3 * m.nv * sizeof(double));
+	m.Q = (double *) malloc (10 * m.nv * sizeof(double));
+	m.alive = (int *) malloc (m.nv * sizeof(int));
+	m.version = (int *) malloc (m.nv * sizeof(int));
+	m.mark = (int *) malloc (m.nv * sizeof(int));
+	m.vf = (int **) malloc (m.nv * sizeof(int *));
+	m.vfNum = (int *) malloc (m.nv * sizeof(int));
+	m.vfMax = (int *) malloc (m.nv * sizeof(int));
+	for(i=0; i<m.nv; i++)
+	{
+		m.pos[3*i] = mesh->x[i];
+		m.pos[3*i+1] = mesh->y[i];
+		m.pos[3*i+2] = mesh->z[i];
+		for(k=0; k<10; k++)
+			m.Q[10*i+k] = 0;
+		m.alive[i] = 1;
+		m.version[i] = 0;
+		m.mark[i] = 0;
+		m.vf[i] = NULL;
+		m.vfNum[i] = m.vfMax[i] = 0;
+	}
+
+	// skip degenerate and invalid index
+	m.f = (int *) malloc (3 * mesh->NumTri * sizeof(int));
+	m.mat = (int *) malloc (mesh->NumTri * sizeof(int));
+	m.fAlive = (int *) malloc (mesh->NumTri * sizeof(int));
+	m.nf = 0;
+	for(i=0; i<mesh->NumTri; i++)
+	{
+		if( mesh->index[3*i] >= (unsigned int)m.nv || mesh->index[3*i+1] >= (unsigned int)m.nv || mesh->index[3*i+2] >= (unsigned int)m.nv )
+			continue;
+		fv = m.f + 3*m.nf;
+		for(k=0; k<3; k++)
+			fv[k] = (int)mesh->index[3*i+k];
+		if( fv[0]==fv[1] || fv[1]==fv[2] || fv[2]==fv[0] )
+			continue;
+		m.mat[m.nf] = mesh->Material ? mesh->Material[i] : 0;
+		m.fAlive[m.nf] = 1;
+		for(k=0; k<3; k++)
+			AddVertexFace(&m, fv[k], m.nf);
+		m.nf ++;
+	}
+	m.live = m.nf;
+
+	// quadric of each face weighted by area
+	for(i=0; i<m.nf; i++)
+	{
+		fv = m.f + 3*i;
+		p[0] = FaceNormal(m.pos+3*fv[0], m.pos+3*fv[1], m.pos+3*fv[2], n0) / 2;
+		if( p[0] == 0 )
+			continue;
+		p[1] = -(n0[0]*m.pos[3*fv[0]] + n0[1]*m.pos[3*fv[0]+1] + n0[2]*m.pos[3*fv[0]+2]);
+		for(k=0; k<3; k++)
+			AddPlane(m.Q+10*fv[k], n0, p[1], p[0]);
+	}
+
+	// boundary edges (only one face) and sharp edges
+	edge = (FaceEdge *) malloc (3 * m.nf * sizeof(FaceEdge));
+	for(i=0, ne=0; i<m.nf; i++)
+		for(k=0; k<3; k++, ne++)
+		{
+			a = m.f[3*i+k];
+			b = m.f[3*i+(k+1)%3];
+			edge[ne].a = a<b ? a : b;
+			edge[ne].b = a<b ? b : a;
+			edge[ne].face = i;
+		}
+	qsort(edge, ne, sizeof(FaceEdge), CompareFaceEdge);
+
+	m.HeapMax = ne > 16 ? ne : 16;
+	m.heap = (Collapse *) malloc (m.HeapMax * sizeof(Collapse));
+	for(i=0; i<ne; i=j)
+	{
+		for(j=i+1; j<ne && edge[j].a==edge[i].a && edge[j].b==edge[i].b; j++)
+			;
+		if( j-i == 1 )
+			AddConstraint(&m, edge[i].a, edge[i].b, edge[i].face, BOUNDARY_WEIGHT);
+		else if( j-i == 2 )
+		{
+			fv = m.f + 3*edge[i].face;
+			FaceNormal(m.pos+3*fv[0], m.pos+3*fv[1], m.pos+3*fv[2], n0);
+			fv = m.f + 3*edge[i+1].face;
+			FaceNormal(m.pos+3*fv[0], m.pos+3*fv[1], m.pos+3*fv[2], n1);
+			if( n0[0]*n1[0] + n0[1]*n1[1] + n0[2]*n1[2] < SHARP_COS )
+			{
+				AddConstraint(&m, edge[i].a, edge[i].b, edge[i].face, SHARP_WEIGHT);
+				AddConstraint(&m, edge[i].a, edge[i].b, edge[i+1].face, SHARP_WEIGHT);
+			}
+		}
+	}
+	// cost of each edge after all quadrics are ready
+	for(i=0; i<ne; i=j)
+	{
+		for(j=i+1; j<ne && edge[j].a==edge[i].a && edge[j].b==edge[i].b; j++)
+			;
+		HeapPush(&m, edge[i].a, edge[i].b);
+	}
+	free(edge);
+
+	// collapse the edge of minimum cost until target
+	while( m.live > target && m.HeapNum > 0 )
+	{
+		c = HeapPop(&m);
+		if( !m.alive[c.a] || !m.alive[c.b] || c.stamp != m.version[c.a] + m.version[c.b] )
+			continue;
+		if( IsIsolated(&m, c.a, c.b) )
+			continue;
+		OptimalPosition(&m, c.a, c.b, p);
+		if( IsFlipped(&m, c.a, c.b, p) )
+			continue;
+		CollapseEdge(&m, c.a, c.b, p);
+	}
+
+	// new mesh, only the vertex used by faces, in place (the new arrays are never longer)
+	remap = m.mark;
+	for(i=0; i<m.nv; i++)
+		remap[i] = -1;
+	NewNumVer = NewNumTri = 0;
+	for(i=0; i<m.nf; i++)
+		if( m.fAlive[i] )
+		{
+			for(k=0; k<3; k++)
+			{
+				if( remap[m.f[3*i+k]] < 0 )
+					remap[m.f[3*i+k]] = NewNumVer++;
+				mesh->index[3*NewNumTri+k] = remap[m.f[3*i+k]];
+			}
+			if( mesh->Material )
+				mesh->Material[NewNumTri] = m.mat[i];
+			NewNumTri ++;
+		}
+	for(i=0; i<m.nv; i++)
+		if( remap[i] >= 0 )
+		{
+			mesh->x[remap[i]] = (float)m.pos[3*i];
+			mesh->y[remap[i]] = (float)m.pos[3*i+1];
+			mesh->z[remap[i]] = (float)m.pos[3*i+2];
+		}
+	mesh->NumVer = NewNumVer;
+	mesh->NumTri = NewNumTri;
+
+	for(i=0; i<m.nv; i++)
+		if( m.vf[i] )
+			free(m.vf[i]);
+	free(m.vf);
+	free(m.vfNum);
+	free(m.vfMax);
+	free(m.pos);
+	free(m.Q);
+	free(m.alive);
+	free(m.version);
+	free(m.mark);
+	free(m.f);
+	free(m.mat);
+	free(m.fAlive);
+	free(m.heap);
+
+	return NewNumTri;
+}
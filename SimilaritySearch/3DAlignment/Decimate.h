@@ -0,0 +1 @@
+LFD_API int DecimateMesh(pMesh mesh, int target);
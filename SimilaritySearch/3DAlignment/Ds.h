@@ -152,10 +152,133 @@ typedef struct Meterial_ {
 	pMeterial		pointer;
 }Meterial;
 
+// triangle mesh, see Mesh.c
+// positions are float in separate arrays, polygons are triangulated as fans when loaded,
+// so that triangle i is vertex index[3*i], index[3*i+1] and index[3*i+2]
+typedef struct Mesh_ *pMesh;
+typedef struct Mesh_ {
+	int				NumVer, NumTri;
+	float			*x, *y, *z;			// NumVer
+	unsigned int	*index;				// 3 * NumTri
+	int				*Material;			// material of each triangle, NULL if all of them are material 0
+	double			*Color;				// r, g, b of each material, 3 * NumMaterial, material 0 is black
+	int				NumMaterial;
+}Mesh;
+
+// tolerance of CleanMesh() by default ("-weld"), relative to the size of the model
+// the mesh to be simplified by DecimateMesh() is always welded, a triangle soup has boundary edges only
+#define	WELD_TOLERANCE	1e-6
+
+// counts of CleanMesh(), the counts after cleaning are those of the mesh
+typedef struct CleanInfo_ {
+	int				NumVer, NumTri;		// before cleaning
+	int				Welded;				// vertices merged into a vertex within the tolerance
+	int				Unreferenced;		// the other vertices removed, which aren't used by any triangle
+	int				Degenerate;			// triangles of zero area, or of less than 3 vertices after welding
+	int				Duplicate;			// triangles of the same vertices with an earlier one
+}CleanInfo;
+
+// a file mapped to memory for reading, see MapFile()
+typedef struct MappedFile_ *pMappedFile;
+typedef struct MappedFile_ {
+	const char		*data;				// NULL if the file is empty
+	__int64			size;
+	void			*file, *map;		// handles of the file and the mapping (Windows only)
+}MappedFile;
+
+// workers started once and run by RunPool() many times, defined in Thread.c
+typedef struct ThreadPool_ *pThreadPool;
+
+// buffers of the software rasterizer, create once and use for all views
+typedef struct Raster_ *pRaster;
+typedef struct Raster_ {
+	float			*depth;			// depth buffer, WIDTH * HEIGHT
+	int				*px, *py;		// window coordinate of each vertex (fixed point)
+	float			*pz;			// depth of each vertex
+	int				MaxVer;			// size of px, py and pz
+	// tile-binned multi-thread rendering, see SetRasterThread()
+	int				NumThread;		// 1 is single thread
+	pThreadPool		Pool;			// workers of NumThread > 1, started by SetRasterThread()
+	int				**Bin;			// triangles of a tile binned by a thread, Bin[thread * TILE_NUM + tile]
+	int				*BinNum, *BinMax;	// used and allocated size of each Bin
+}Raster;
+
+// render backend, see Render.c
+#define	RENDER_GLUT		0		// OpenGL in a GLUT window
+#define	RENDER_FBO		1		// offscreen OpenGL, a framebuffer object of a context without window
+#define	RENDER_SOFT		2		// software rasterizer
+
+// mesh uploaded once and drawn for all views, see UploadMesh() in Render.c
+typedef struct RenderMesh_ {
+	pMesh			m;				// the loaded mesh, NULL if nothing
+	int				OwnMesh;		// "m" is converted from the polygons of LoadMesh(), and freed by UnloadMesh()
+	pVer			v;				// polygons of LoadMesh(), NULL if loaded by UploadMesh()
+	pTri			t;
+	int				nv, nt;
+	float			*coor;			// vertex interleaved for the vertex array, 3 * NumVer
+	int				*RunStart;		// triangles [RunStart[i], RunStart[i+1]) have the same material, NumRun + 1
+	float			*RunColor;		// 3 * NumRun
+	int				NumRun;
+	unsigned int	list;			// OpenGL display list
+}RenderMesh;
+
+typedef struct RenderBackend_ *pRenderBackend;
+typedef struct RenderBackend_ {
+	int				type;
+	void			(*SetCamera)(pRenderBackend rb, pVer CamVertex);
+	void			(*DrawMesh)(pRenderBackend rb, pMesh m);
+	void			(*ReadDepth)(pRenderBackend rb, unsigned char *bmBits);		// WIDTH * HEIGHT
+	void			(*ReadColor)(pRenderBackend rb, unsigned char *bmColor);		// 3 * WIDTH * HEIGHT, read before depth
+	void			(*ReadMask)(pRenderBackend rb, unsigned __int64 *Mask);		// HEIGHT * MASK_WORDS
+	void			(*LoadMesh)(pRenderBackend rb, pMesh m);
+	void			(*UnloadMesh)(pRenderBackend rb);
+	void			(*Free)(pRenderBackend rb);
+	// camera and mesh of the last SetCamera() and DrawMesh()
+	pVer			CamVertex;
+	pMesh			m;
+	unsigned char	*depth;			// depth buffer read back, WIDTH * HEIGHT
+	int				DepthReady;		// the software rasterizer has drawn the mesh to "depth"
+	pRaster			ras;			// software rasterizer
+	void			*wnd, *dc, *ctx;	// hidden window, device context and WGL context of RENDER_FBO (EGL display and context if not Windows)
+	unsigned int	fbo, FboColor, FboDepth;	// framebuffer object and its render buffers
+	RenderMesh		mesh;			// DrawMesh() of this mesh doesn't send it again
+}RenderBackend;
+
+// statistics of a silhouette (the pixel < 255) from one pass, used by all feature extractors
+typedef struct SilStats_ *pSilStats;
+typedef struct SilStats_ {
+	int				count;						// number of pixels, i.e., area
+	int				MinX, MaxX, MinY, MaxY;		// bounding box, MaxY is -1 if nothing rendered
+	double			CenX, CenY;					// center of bounding box, -1 if nothing rendered
+	double			MaxR2;						// max squared distance from the center
+	double			i20, i02, i11;				// second-order moments about the center
+	double			ArtScale;					// pixel to ART basis function, the same for all views of an angle (FindRadius())
+}SilStats;
+
+// connected components of the pixels < 255, see LabelComponents()
+// the arrays are indexed by label, 1 ~ NumComp (0 is the other pixels)
+typedef struct Components_ *pComponents;
+typedef struct Components_ {
+	int				NumComp;
+	int				*Area;			// number of pixels
+	int				*MinX, *MaxX, *MinY, *MaxY;		// bounding box
+	int				*Border;		// 1 if the component touches the image border
+	int				*NumHole;		// holes (other pixels not connected to the image border) enclosed by the component
+	int				*HoleArea;		// total pixels of the holes
+}Components;
+
 #ifndef	PARA_
 #define PARA_
 	#define	WIDTH			256
 	#define HEIGHT			256
+	#define	MASK_WORDS		4		// (WIDTH/64) unsigned __int64 in each row of packed silhouette
+	#define	TILE_W			64		// tile size of multi-thread rendering, multiple of 64 so that a tile never share a word of packed silhouette
+	#define	TILE_H			32
+	#define	TILE_X			4		// (WIDTH/TILE_W)
+	#define	TILE_Y			8		// (HEIGHT/TILE_H)
+	#define	TILE_NUM		32		// (TILE_X*TILE_Y)
+	#define	MAX_THREAD		64
+	#define	SPAN_MAX		32768	// (WIDTH*HEIGHT/2) foreground spans of a silhouette at most
 //	#define	TOTAL_PIXEL		65025	// 255x255 (WIDTH*HEIGHT)
 	#define ANGLE			10		// for dest
 	#define CAMNUM			10
@@ -169,6 +292,7 @@ typedef struct Meterial_ {
 	#define ART_COEF_2 		18
 	#define	ART_LUT_RADIUS	50		// Zernike basis function radius
 	#define	ART_LUT_SIZE	101		// (ART_LUT_RADIUS*2+1)
+	#define	ART_BASIS_NUM	36		// (ART_ANGULAR*ART_RADIAL)
 	#define PI				3.141592653
 
 	// circularity and eccentricity (from MPEG-7 XM)
@@ -187,6 +311,7 @@ typedef struct Meterial_ {
 
 // for fourier descriptor
 	#define		FD_COEFF_NO	10
+	#define		FD_SAMPLE	128		// points of the resampled contour, power of 2 (see FourierSignal())
 
 	typedef struct sPOINT_
 	{	
@@ -195,3 +320,60 @@ typedef struct Meterial_ {
 
 #endif
 
+// chain code of a traced outer contour, see TraceContourSpan()
+typedef struct ContourStats_ *pContourStats;
+typedef struct ContourStats_ {
+	int				NumStraight, NumDiagonal;	// moves to the 4-neighbors and to the diagonal neighbors
+	double			area;						// pixels enclosed by the contour
+	int				MultiPart;					// the silhouette has more parts, the chain is of one part only
+}ContourStats;
+
+// foreground spans of each row of a silhouette, pixels x0[i] ~ x1[i] of row y are foreground,
+// for RowStart[y] <= i < RowStart[y+1], see GetSpans()
+typedef struct SilSpans_ *pSilSpans;
+typedef struct SilSpans_ {
+	int				NumSpan;
+	int				RowStart[HEIGHT+1];
+	short			x0[SPAN_MAX], x1[SPAN_MAX];
+}SilSpans;
+
+// scratch memory of the extractors and matchers, see CreateArena()
+// a block is taken from "Base" by ArenaAlloc(), and given back by ArenaRelease() or ArenaReset()
+typedef struct ArenaBlock_ *pArenaBlock;
+typedef struct ArenaBlock_ {
+	pArenaBlock		next;
+	int				Mark;						// "Used" of the arena before the block, freed by ArenaRelease() of an earlier mark
+}ArenaBlock;
+
+typedef struct Arena_ *pArena;
+typedef struct Arena_ {
+	unsigned char	*Base;
+	int				Size, Used;
+	int				Peak;						// the most bytes used since the last ArenaReset()
+	pArenaBlock		Extra;						// allocated when "Base" is full (the latest first), freed by ArenaRelease() or ArenaReset()
+}Arena;
+
+// state of extracting the features of one model, see CreateLfdContext()
+// a thread owns a context, so that models are processed concurrently, the LUTs are shared (read only)
+typedef struct LfdContext_ *pLfdContext;
+typedef struct LfdContext_ {
+	pRenderBackend	Backend;					// one for each context, not freed by FreeLfdContext()
+	pVer			CamVertex[ANGLE];			// camera set, 12_0 ~ 12_9
+	pTri			CamTriangle[ANGLE];
+	int				CamNumVer[ANGLE], CamNumTri[ANGLE];
+	int				UseMaskRender;				// render packed silhouette instead of depth
+	int				FdResample;					// Fourier descriptor of the resampled contour, all views in one batch
+	int				CirContour;					// circularity from the contour (2 weights diagonal by sqrt(2)), set after creating
+	// buffers of the views of an angle
+	unsigned char	*srcBuff[CAMNUM];
+	unsigned __int64 *MaskBuff[CAMNUM];
+	pSilSpans		Spans[CAMNUM];
+	SilStats		Stats[CAMNUM];
+	ContourStats	Chain[CAMNUM];
+	sPOINT			*Contour;
+	unsigned char	*ContourMask;
+	double			*FdSignal;					// ANGLE * CAMNUM * FD_SAMPLE
+	pArena			Scratch;					// the other buffers, reset for each model
+}LfdContext;
+
+
@@ -2,29 +2,10 @@
 #include "ds.h"
 #define	POW2(a)		((a)*(a))
 
-LFD_API double Eccentricity(unsigned char *srcBuff, int width, int height, double CenX, double CenY)
+static double MomentToEccentricity(double i11, double i02, double i20, int count)
 {
-	int					x, y, count;
-	unsigned char		*pImage;
-	double				i11, i02, i20;
 	double				ecc;
 
-	count = 0;
-	pImage = srcBuff;
-	i11 = i02 = i20 = 0;
-	for (y=0 ; y<height ; y++)
-	for (x=0 ; x<width; x++)
-	{
-		if( *pImage < 255 )
-		{
-			i02 += POW2(y-CenY);
-			i11 += (x-CenX) * (y-CenY);
-			i20 += POW2(x-CenX);
-			count ++;		// how many pixels
-		}
-		pImage++;
-	}
-
 	if( count > 1 )
 	{
 		// defined in MPEG-7, seen not good
@@ -44,3 +25,9 @@ LFD_API double Eccentricity(unsigned char *srcBuff, int width, int height, doubl
 
 	return ecc;
 }
+
+// the moments about the center are from GetSilStats() (or GetSilStatsSpan())
+LFD_API double Eccentricity(pSilStats st)
+{
+	return MomentToEccentricity(st->i11, st->i02, st->i20, st->count);
+}
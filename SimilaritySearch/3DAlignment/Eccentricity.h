@@ -1 +1 @@
-LFD_API double Eccentricity(unsigned char *srcBuff, int width, int height, double CenX, double CenY);
+LFD_API double Eccentricity(pSilStats st);
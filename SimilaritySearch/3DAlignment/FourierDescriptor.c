@@ -10,12 +10,19 @@
 #include "Thin.h"
 #include "Bitmap.h"
 #include "Morphology.h"
-
-int IsMultiPart(unsigned char *ContourMask, unsigned char *Y, int width, int height)
+#include "BitMask.h"
+#include "Span.h"
+#include "Label.h"
+#include "Arena.h"
+#include "Thread.h"
+
+// mark the pixels outside the contour as 128
+// the outside is the pixels (not contour) 4-connected to the image border, found by labelling in linear time
+static void MarkOutside(unsigned char *ContourMask, int width, int height, pArena ar)
 {
-	int		insideArea, outsideArea;
-	int		i, j, k, change, total;
-	int		MaskCoor[4] = {-1, 1, -width, width};
+	int		i, n, total, mark;
+	int		*Label, *parent;
+	char	*Outside;
 
 	total = width * height;
 
@@ -26,35 +33,32 @@ int IsMultiPart(unsigned char *ContourMask, unsigned char *Y, int width, int hei
 		ContourMask[i] = 128;
 	for(i=0; i<total; i+=width)
 		ContourMask[i] = ContourMask[i+width-1] = 128;
-	
-	do
-	{
-		change = 0;
-
-		// left-right, top-bottom
-		for(j=width; j<total-width; j+=width)
-			for(k=1; k<width-1; k++)
-				if( ContourMask[j+k] == 0 )
-					for(i=0; i<4; i++)
-						if( ContourMask[j+k+MaskCoor[i]] == 128 )
-						{
-							ContourMask[j+k] = 128;
-							change = 1;
-						}
-		// right-left, bottom-top
-		for(j=total-2-width; j>0; j-=width)
-			for(k=width-1; k>0; k--)
-				if( ContourMask[j+k] == 0 )
-					for(i=0; i<4; i++)
-						if( ContourMask[j+k+MaskCoor[i]] == 128 )
-						{
-							ContourMask[j+k] = 128;
-							change = 1;
-						}
-
-	}while( change );
 
+	mark = ArenaMark(ar);
+	Label = (int *) ArenaAlloc(ar, (int)(total * sizeof(int)));
+	parent = (int *) ArenaAlloc(ar, (int)((total / 2 + 2) * sizeof(int)));
+	n = LabelComponentsBuff(Label, parent, ContourMask, width, height, 4);
+	Outside = (char *) ArenaCalloc(ar, (int)((n+1) * sizeof(char)));
+	for(i=0; i<width; i++)
+		Outside[Label[i]] = Outside[Label[total-width+i]] = 1;
+	for(i=0; i<total; i+=width)
+		Outside[Label[i]] = Outside[Label[i+width-1]] = 1;
+
+	for(i=0; i<total; i++)
+		if( Outside[Label[i]] )
+			ContourMask[i] = 128;
+
+	ArenaRelease(ar, mark);
 //WriteBitmap8(ContourMask, width, height, "ttt2.bmp");
+}
+
+int IsMultiPart(unsigned char *ContourMask, unsigned char *Y, int width, int height, pArena ar)
+{
+	int		insideArea, outsideArea;
+	int		i, total;
+
+	total = width * height;
+	MarkOutside(ContourMask, width, height, ar);
 
 	// get area of contour area
 	insideArea = outsideArea = 0;
@@ -70,65 +74,114 @@ int IsMultiPart(unsigned char *ContourMask, unsigned char *Y, int width, int hei
 	return ( (double)insideArea / (double)(insideArea+outsideArea) > 0.95 ) ? 0 : 1;
 }
 
-// *Y: 255 is background
-// input is an edge image
-LFD_API void FourierDescriptor(double FdCoeff[], unsigned char *Y, int width, int height,
-					   sPOINT *Contour, unsigned char *ContourMask, double CenX, double CenY)
+// the same with IsMultiPart(), for spans of silhouette (WIDTH * HEIGHT)
+int IsMultiPartSpan(unsigned char *ContourMask, pSilSpans sp, pArena ar)
 {
-	int				total, i, k, N;//, cenx, ceny;
-	fftw_real		*CenDist;	// the contour is the input of fourier descriptor
-    rfftw_plan		p;
-	fftw_real		*out, *power_spectrum;
-	int				num;
+	int					insideArea, outsideArea;
+	int					y, i, x;
+	unsigned char		*pRow;
+
+	MarkOutside(ContourMask, WIDTH, HEIGHT, ar);
+
+	insideArea = outsideArea = 0;
+	for(y=0; y<HEIGHT; y++)
+		for(i=sp->RowStart[y], pRow=ContourMask+y*WIDTH; i<sp->RowStart[y+1]; i++)
+			for(x=sp->x0[i]; x<=sp->x1[i]; x++)
+			{
+				if( pRow[x] == 128 )
+					outsideArea ++;
+				else
+					insideArea ++;
+			}
+
+	return ( (double)insideArea / (double)(insideArea+outsideArea) > 0.95 ) ? 0 : 1;
+}
+
+// erode the silhouette until it's not multi-part (or use the bounding box), then thin it back, and trace again
+// the buffers of erosion and thinning are taken from "ar", so that there is no allocation for each view
+static int MultiPartContour(sPOINT *Contour, unsigned char *ContourMask, unsigned char *Y, int width, int height, pArena ar)
+{
+	int				total, num, mark;
 	unsigned char	*Buff;
 	unsigned char	*flag;	// use for another mask in Thin()
+	unsigned __int64 *Morph;
 	POINT			Size={width, height};
-//FILE *fpt;
-//fpt = fopen("testfd.txt", "w");
-//for(i=0; i<width*height; i++)
-//	fprintf(fpt, "%d,", Y[i]);
-//fclose(fpt);
 
 	total = width * height;
 
-//WriteBitmap8(Y, width, height, "tt1.bmp");
-	num = TraceContour(Contour, ContourMask, Y, width, height);
-
-//fpt = fopen("testtc.txt", "w");
-//fprintf(fpt, "%d\n", num);
-//for(i=0; i<num; i++)
-//	fprintf(fpt, "%d\n", Contour[i].y*width+Contour[i].x);
-//fclose(fpt);
-
-//WriteBitmap8(ContourMask, width, height, "tt2.bmp");
-	if( IsMultiPart(ContourMask, Y, width, height) )
+	mark = ArenaMark(ar);
+	Buff = (unsigned char*) ArenaAlloc(ar, (int)(total * sizeof(unsigned char)));
+	Morph = (unsigned __int64 *) ArenaAlloc(ar, (int)(3 * ((width + 63) >> 6) * height * sizeof(unsigned __int64)));
+	memcpy(Buff, Y, total * sizeof(unsigned char));
+	BINARYErosion3x3Buff(Buff, Size, Morph);
+	// fix bug: IsMultiPart() should be run after TraceContour()
+	TraceContour(Contour, ContourMask, Buff, width, height);
+	if( IsMultiPart(ContourMask, Buff, width, height, ar) )	// fix bug: should be "Buff" NOT "Y"
 	{
-		Buff = (unsigned char*) malloc( total * sizeof(unsigned char));
-		memcpy(Buff, Y, total * sizeof(unsigned char));
-		BINARYErosion3x3(Buff, Size);
-		// fix bug: IsMultiPart() should be run after TraceContour()
+		BINARYErosion5x5Buff(Buff, Size, Morph);
 		TraceContour(Contour, ContourMask, Buff, width, height);
-		if( IsMultiPart(ContourMask, Buff, width, height) )	// fix bug: should be "Buff" NOT "Y"
+		if( IsMultiPart(ContourMask, Buff, width, height, ar) )	// fix bug: should be "Buff" NOT "Y"
 		{
-			BINARYErosion5x5(Buff, Size);
-			TraceContour(Contour, ContourMask, Buff, width, height);
-			if( IsMultiPart(ContourMask, Buff, width, height) )	// fix bug: should be "Buff" NOT "Y"
-			{
-				memcpy(Buff, Y, total * sizeof(unsigned char));
-				BoundingBox(Buff, Size);
-			}
+			memcpy(Buff, Y, total * sizeof(unsigned char));
+			BoundingBox(Buff, Size);
 		}
+	}
 
-		flag = (unsigned char *) malloc( total * sizeof(unsigned char));
+	flag = (unsigned char *) ArenaAlloc(ar, (int)(total * sizeof(unsigned char)));
 //WriteBitmap8(Y, width, height, "t3.bmp");
-		Thin(Buff, Y, flag, width, width*height);
+	Thin(Buff, Y, flag, width, width*height, ar);
 //WriteBitmap8(Buff, width, height, "t4.bmp");
 
-		num = TraceContour(Contour, ContourMask, Buff, width, height);
-		free(Buff);
-		free(flag);
+	num = TraceContour(Contour, ContourMask, Buff, width, height);
+	ArenaRelease(ar, mark);
+
+	return num;
+}
+
+// the plans of contour length N < FD_PLAN_MAX are created at the first use, and kept until the program exits,
+// the longer ones are created for each contour
+// the planner of FFTW is not thread-safe (twiddle factors are shared by all plans), so it runs in the lock,
+// and the cache is read in the lock too, a plan is seen by the other threads only after it's complete
+#define FD_PLAN_MAX		4096
+
+static rfftw_plan		ContourPlan[FD_PLAN_MAX];
+static volatile __int64	PlanLock = 0;
+
+static rfftw_plan GetContourPlan(int N)
+{
+	rfftw_plan		p;
+
+	AcquireLock(&PlanLock);
+	if( N < FD_PLAN_MAX && ContourPlan[N] )
+		p = ContourPlan[N];
+	else
+	{
+		p = rfftw_create_plan(N, FFTW_REAL_TO_COMPLEX, FFTW_ESTIMATE);
+		if( N < FD_PLAN_MAX )
+			ContourPlan[N] = p;
 	}
-//WriteBitmap8(ContourMask, width, height, "ttt_1.bmp");
+	ReleaseLock(&PlanLock);
+
+	return p;
+}
+
+static void PutContourPlan(rfftw_plan p, int N)
+{
+	if( N < FD_PLAN_MAX )
+		return ;
+
+	AcquireLock(&PlanLock);
+	rfftw_destroy_plan(p);
+	ReleaseLock(&PlanLock);
+}
+
+// fourier descriptor of the centroid distance of the contour
+static void ContourDescriptor(double FdCoeff[], sPOINT *Contour, int num, double CenX, double CenY, pArena ar)
+{
+	int				i, k, N, mark;
+	fftw_real		*CenDist;	// the contour is the input of fourier descriptor
+    rfftw_plan		p;
+	fftw_real		*out, *power_spectrum;
 
 	if( num < 8 )
 	{
@@ -138,7 +191,8 @@ LFD_API void FourierDescriptor(double FdCoeff[], unsigned char *Y, int width, in
 		return ;
 	}
 
-	CenDist = (fftw_real *) malloc( num * sizeof(fftw_real));
+	mark = ArenaMark(ar);
+	CenDist = (fftw_real *) ArenaAlloc(ar, (int)(num * sizeof(fftw_real)));
 //	cenx = width / 2;
 //	ceny = height / 2;
 	for(i=0; i<num; i++)
@@ -153,10 +207,10 @@ LFD_API void FourierDescriptor(double FdCoeff[], unsigned char *Y, int width, in
 
 	// fft, get fourier descriptor from the contour
 	N = num;
-	out = (fftw_real *) malloc(N * sizeof(fftw_real));
-	power_spectrum = (fftw_real *) malloc( (N/2+1) * sizeof(fftw_real));
+	out = (fftw_real *) ArenaAlloc(ar, (int)(N * sizeof(fftw_real)));
+	power_spectrum = (fftw_real *) ArenaAlloc(ar, (int)((N/2+1) * sizeof(fftw_real)));
 
-	p = rfftw_create_plan(N, FFTW_REAL_TO_COMPLEX, FFTW_ESTIMATE);
+	p = GetContourPlan(N);
 	rfftw_one(p, CenDist, out);
 
 	// fix bug: The image part should be 0, not out[0]
@@ -167,7 +221,7 @@ LFD_API void FourierDescriptor(double FdCoeff[], unsigned char *Y, int width, in
 		// fix bug: The image part should be 0, not out[N/2]
 		power_spectrum[N/2] = HYPOT(out[N/2], 0);	// out[N/2]*out[N/2]; // Nyquist freq.
 
-	rfftw_destroy_plan(p);
+	PutContourPlan(p, N);
 
 	N= N/2+1;		// fix bug: power_spectrum[0~N/2] only
 	for(i=1; i<=FD_COEFF_NO; i++)
@@ -192,13 +246,189 @@ LFD_API void FourierDescriptor(double FdCoeff[], unsigned char *Y, int width, in
 //fclose(fpt);
 
 	
-	free(out);
-	free(power_spectrum);
-	free(CenDist);
+	ArenaRelease(ar, mark);
 	return ;
 }
 
 
+// contour of a silhouette, the multi-part silhouette is eroded (or use the bounding box) and thinned
+// *Y: 255 is background, the spans are from Y (WIDTH * HEIGHT)
+// the chain code of the outer contour (before erosion) is saved to "cs" if it's not NULL, and "cs->MultiPart" is set if the silhouette is multi-part
+static int GetContour(sPOINT *Contour, unsigned char *ContourMask, unsigned char *Y, int width, int height, pSilSpans sp, pContourStats cs, pArena ar)
+{
+	int				num;
+//FILE *fpt;
+//fpt = fopen("testfd.txt", "w");
+//for(i=0; i<width*height; i++)
+//	fprintf(fpt, "%d,", Y[i]);
+//fclose(fpt);
+
+//WriteBitmap8(Y, width, height, "tt1.bmp");
+	num = TraceContourSpan(Contour, ContourMask, Y, sp, cs);
+
+//fpt = fopen("testtc.txt", "w");
+//fprintf(fpt, "%d\n", num);
+//for(i=0; i<num; i++)
+//	fprintf(fpt, "%d\n", Contour[i].y*width+Contour[i].x);
+//fclose(fpt);
+
+//WriteBitmap8(ContourMask, width, height, "tt2.bmp");
+	if( IsMultiPartSpan(ContourMask, sp, ar) )
+	{
+		num = MultiPartContour(Contour, ContourMask, Y, width, height, ar);
+		if( cs )
+			cs->MultiPart = 1;
+	}
+//WriteBitmap8(ContourMask, width, height, "ttt_1.bmp");
+
+	return num;
+}
+
+// the same with GetContour(), for packed silhouette (WIDTH * HEIGHT)
+// only multi-part silhouette is unpacked for erosion and thinning
+static int GetContourMask(sPOINT *Contour, unsigned char *ContourMask, unsigned __int64 *Mask, pSilSpans sp, pContourStats cs, pArena ar)
+{
+	int				num, mark;
+	unsigned char	*Y;
+
+	num = TraceContourMaskSpan(Contour, ContourMask, Mask, sp, cs);
+	if( IsMultiPartSpan(ContourMask, sp, ar) )
+	{
+		mark = ArenaMark(ar);
+		Y = (unsigned char *) ArenaAlloc(ar, (int)(WIDTH * HEIGHT * sizeof(unsigned char)));
+		UnpackMask(Y, Mask);
+		num = MultiPartContour(Contour, ContourMask, Y, WIDTH, HEIGHT, ar);
+		ArenaRelease(ar, mark);
+		if( cs )
+			cs->MultiPart = 1;
+	}
+
+	return num;
+}
+
+// input is an edge image
+// "cs" (can be NULL) is the chain code of the contour for CircularityContour(), so that the contour is traced once
+// the other buffers are taken from "ar" and given back before return
+LFD_API void FourierDescriptor(double FdCoeff[], unsigned char *Y, int width, int height,
+					   sPOINT *Contour, unsigned char *ContourMask, pSilStats st, pSilSpans sp, pContourStats cs, pArena ar)
+{
+	int				num;
+
+	num = GetContour(Contour, ContourMask, Y, width, height, sp, cs, ar);
+	ContourDescriptor(FdCoeff, Contour, num, st->CenX, st->CenY, ar);
+}
+
+// the same with FourierDescriptor(), for packed silhouette (WIDTH * HEIGHT)
+LFD_API void FourierDescriptorMask(double FdCoeff[], unsigned __int64 *Mask, sPOINT *Contour, unsigned char *ContourMask, pSilStats st, pSilSpans sp, pContourStats cs, pArena ar)
+{
+	int				num;
+
+	num = GetContourMask(Contour, ContourMask, Mask, sp, cs, ar);
+	ContourDescriptor(FdCoeff, Contour, num, st->CenX, st->CenY, ar);
+}
+
+// ***********************************************************************************************
+// resampled Fourier descriptor: the centroid distance is resampled to FD_SAMPLE points of the same
+// arc length along the closed contour, so that the coefficients are comparable across contour lengths,
+// and all views use one cached FFT plan of FD_SAMPLE points
+//	for each view			: FourierSignal() or FourierSignalMask()
+//	then for all views		: FourierDescriptorBatch()
+// the features are different from FourierDescriptor(), don't mix them in one database
+
+static void ResampleContour(double Signal[], sPOINT *Contour, int num, double CenX, double CenY)
+{
+	int				i, k, next;
+	double			len, seg, pos, t, f, x, y;
+
+	// the same with ContourDescriptor(), the coefficients are 0 (see FourierDescriptorBatch())
+	if( num < 8 )
+	{
+		for(i=0; i<FD_SAMPLE; i++)
+			Signal[i] = 0;
+		return ;
+	}
+
+	len = 0;
+	for(k=0; k<num; k++)
+	{
+		next = (k+1) % num;
+		len += HYPOT(Contour[next].x-Contour[k].x, Contour[next].y-Contour[k].y);
+	}
+
+	k = 0;
+	next = 1;
+	pos = 0;
+	seg = HYPOT(Contour[1].x-Contour[0].x, Contour[1].y-Contour[0].y);
+	for(i=0; i<FD_SAMPLE; i++)
+	{
+		t = len * i / FD_SAMPLE;
+		while( pos + seg < t && k < num-1 )
+		{
+			pos += seg;
+			k ++;
+			next = (k+1) % num;
+			seg = HYPOT(Contour[next].x-Contour[k].x, Contour[next].y-Contour[k].y);
+		}
+		f = ( seg > 0 ) ? ( t - pos ) / seg : 0;
+		x = Contour[k].x + f * ( Contour[next].x - Contour[k].x );
+		y = Contour[k].y + f * ( Contour[next].y - Contour[k].y );
+		Signal[i] = HYPOT(x-CenX, y-CenY);
+	}
+}
+
+// Signal[FD_SAMPLE] of a silhouette, the same input with FourierDescriptor()
+LFD_API void FourierSignal(double Signal[], unsigned char *Y, int width, int height,
+					   sPOINT *Contour, unsigned char *ContourMask, pSilStats st, pSilSpans sp, pContourStats cs, pArena ar)
+{
+	int				num;
+
+	num = GetContour(Contour, ContourMask, Y, width, height, sp, cs, ar);
+	ResampleContour(Signal, Contour, num, st->CenX, st->CenY);
+}
+
+// the same with FourierSignal(), for packed silhouette (WIDTH * HEIGHT)
+LFD_API void FourierSignalMask(double Signal[], unsigned __int64 *Mask, sPOINT *Contour, unsigned char *ContourMask, pSilStats st, pSilSpans sp, pContourStats cs, pArena ar)
+{
+	int				num;
+
+	num = GetContourMask(Contour, ContourMask, Mask, sp, cs, ar);
+	ResampleContour(Signal, Contour, num, st->CenX, st->CenY);
+}
+
+// the plan of FD_SAMPLE points is created at the first call, and kept until the program exits
+// (the planner of FFTW is not thread-safe, so call it once before running threads)
+static rfftw_plan		FdPlan = NULL;
+
+LFD_API void FourierDescriptorPlan()
+{
+	if( FdPlan == NULL )
+		FdPlan = rfftw_create_plan(FD_SAMPLE, FFTW_REAL_TO_COMPLEX, FFTW_ESTIMATE);
+}
+
+// fourier descriptor of "num" views, Signal[num * FD_SAMPLE] from FourierSignal(), all of them in one rfftw()
+LFD_API void FourierDescriptorBatch(double FdCoeff[][FD_COEFF_NO], double *Signal, int num, pArena ar)
+{
+	int				i, k, mark;
+	fftw_real		*out, *pOut, power0;
+
+	FourierDescriptorPlan();
+
+	mark = ArenaMark(ar);
+	out = (fftw_real *) ArenaAlloc(ar, (int)(num * FD_SAMPLE * sizeof(fftw_real)));
+	rfftw(FdPlan, num, (fftw_real *)Signal, 1, FD_SAMPLE, out, 1, FD_SAMPLE);
+
+	// the same with ContourDescriptor(), FD_COEFF_NO < FD_SAMPLE/2
+	for(i=0; i<num; i++)
+	{
+		pOut = out + i * FD_SAMPLE;
+		power0 = HYPOT(pOut[0], 0);
+		for(k=1; k<=FD_COEFF_NO; k++)
+			FdCoeff[i][k-1] = ( power0 > 0 ) ? HYPOT(pOut[k], pOut[FD_SAMPLE-k]) / power0 : 0;
+	}
+
+	ArenaRelease(ar, mark);
+}
+
 /*
 #include "rfftw.h"
 
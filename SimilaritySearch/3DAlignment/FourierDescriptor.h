@@ -1 +1,6 @@
-LFD_API void FourierDescriptor(double FdCoeff[], unsigned char *Y, int width, int height, sPOINT *Contour, unsigned char *ContourMask, double CenX, double CenY);
+LFD_API void FourierDescriptor(double FdCoeff[], unsigned char *Y, int width, int height, sPOINT *Contour, unsigned char *ContourMask, pSilStats st, pSilSpans sp, pContourStats cs, pArena ar);
+LFD_API void FourierDescriptorMask(double FdCoeff[], unsigned __int64 *Mask, sPOINT *Contour, unsigned char *ContourMask, pSilStats st, pSilSpans sp, pContourStats cs, pArena ar);
+LFD_API void FourierSignal(double Signal[], unsigned char *Y, int width, int height, sPOINT *Contour, unsigned char *ContourMask, pSilStats st, pSilSpans sp, pContourStats cs, pArena ar);
+LFD_API void FourierSignalMask(double Signal[], unsigned __int64 *Mask, sPOINT *Contour, unsigned char *ContourMask, pSilStats st, pSilSpans sp, pContourStats cs, pArena ar);
+LFD_API void FourierDescriptorPlan();
+LFD_API void FourierDescriptorBatch(double FdCoeff[][FD_COEFF_NO], double *Signal, int num, pArena ar);
@@ -0,0 +1,195 @@
+#include <stdio.h>
+#include <malloc.h>
+#include <memory.h>
+
+#include "ds.h"
+
+// connected component labelling in two raster scans with union-find, linear time
+// the first pixel of a component (in raster order) always gets a new provisional label, and the root
+// of a set is always its smallest label, so the final labels are numbered in raster order of the components
+
+// root of the provisional label, with path halving
+static int FindRoot(int *parent, int i)
+{
+	while( parent[i] != i )
+	{
+		parent[i] = parent[parent[i]];
+		i = parent[i];
+	}
+	return i;
+}
+
+// the larger root is linked to the smaller one, so that parent[i] < i if i is not a root
+static int Union(int *parent, int a, int b)
+{
+	a = FindRoot(parent, a);
+	b = FindRoot(parent, b);
+	if( a < b )
+	{
+		parent[b] = a;
+		return a;
+	}
+	parent[a] = b;
+	return b;
+}
+
+// label the pixels which ( Y[i] < 255 ) == fg, Label[i] is 0 for the other pixels
+// parent has (width * height / 2 + 2) at least, the most provisional labels of a checkerboard
+// return the number of components
+static int LabelPass(int *Label, unsigned char *Y, int width, int height, int fg, int conn, int *parent)
+{
+	int		x, y, pos, n, l, count, total;
+
+	n = 0;
+	for(y=0, pos=0; y<height; y++)
+		for(x=0; x<width; x++, pos++)
+		{
+			if( (Y[pos] < 255) != fg )
+			{
+				Label[pos] = 0;
+				continue;
+			}
+
+			l = ( x > 0 ) ? Label[pos-1] : 0;
+			if( y > 0 )
+			{
+				if( Label[pos-width] )
+					l = l ? Union(parent, l, Label[pos-width]) : Label[pos-width];
+				if( conn == 8 && x > 0 && Label[pos-width-1] )
+					l = l ? Union(parent, l, Label[pos-width-1]) : Label[pos-width-1];
+				if( conn == 8 && x < width-1 && Label[pos-width+1] )
+					l = l ? Union(parent, l, Label[pos-width+1]) : Label[pos-width+1];
+			}
+			if( l == 0 )
+			{
+				l = ++n;
+				parent[l] = l;
+			}
+			Label[pos] = l;
+		}
+
+	// final labels 1 ~ count, parent[i] (< i) is already the final label if i is not a root
+	count = 0;
+	for(l=1; l<=n; l++)
+		if( parent[l] == l )
+			parent[l] = ++count;
+		else
+			parent[l] = parent[parent[l]];
+
+	total = width * height;
+	for(pos=0; pos<total; pos++)
+		if( Label[pos] )
+			Label[pos] = parent[Label[pos]];
+
+	return count;
+}
+
+// area, bounding box, border and holes of each component
+// a hole is a component of the other pixels (with the other connectivity) not touching the image border,
+// the pixel above its first pixel belongs to the only component enclosing it
+static void MeasureComponents(int *Label, unsigned char *Y, int width, int height, int conn, int *parent, pComponents comp)
+{
+	int		x, y, pos, l, n, next, total;
+	int		*Hole, *Owner, *Area, *Border;
+
+	n = comp->NumComp;
+	comp->Area = (int *) calloc(n+1, sizeof(int));
+	comp->MinX = (int *) calloc(n+1, sizeof(int));
+	comp->MaxX = (int *) calloc(n+1, sizeof(int));
+	comp->MinY = (int *) calloc(n+1, sizeof(int));
+	comp->MaxY = (int *) calloc(n+1, sizeof(int));
+	comp->Border = (int *) calloc(n+1, sizeof(int));
+	comp->NumHole = (int *) calloc(n+1, sizeof(int));
+	comp->HoleArea = (int *) calloc(n+1, sizeof(int));
+
+	for(y=0, pos=0; y<height; y++)
+		for(x=0; x<width; x++, pos++)
+			if( (l = Label[pos]) != 0 )
+			{
+				if( comp->Area[l] == 0 )
+				{
+					comp->MinX[l] = comp->MaxX[l] = x;
+					comp->MinY[l] = y;
+				}
+				comp->Area[l] ++;
+				if( x < comp->MinX[l] )		comp->MinX[l] = x;
+				if( x > comp->MaxX[l] )		comp->MaxX[l] = x;
+				comp->MaxY[l] = y;
+				if( x == 0 || y == 0 || x == width-1 || y == height-1 )
+					comp->Border[l] = 1;
+			}
+
+	// components of the other pixels
+	total = width * height;
+	Hole = (int *) malloc(total * sizeof(int));
+	n = LabelPass(Hole, Y, width, height, 0, 12 - conn, parent);
+	Owner = (int *) calloc(n+1, sizeof(int));
+	Area = (int *) calloc(n+1, sizeof(int));
+	Border = (int *) calloc(n+1, sizeof(int));
+
+	next = 1;
+	for(y=0, pos=0; y<height; y++)
+		for(x=0; x<width; x++, pos++)
+			if( (l = Hole[pos]) != 0 )
+			{
+				if( l == next )
+				{
+					Owner[l] = ( y > 0 ) ? Label[pos-width] : 0;
+					next ++;
+				}
+				Area[l] ++;
+				if( x == 0 || y == 0 || x == width-1 || y == height-1 )
+					Border[l] = 1;
+			}
+
+	for(l=1; l<=n; l++)
+		if( !Border[l] && Owner[l] )
+		{
+			comp->NumHole[Owner[l]] ++;
+			comp->HoleArea[Owner[l]] += Area[l];
+		}
+
+	free(Hole);
+	free(Owner);
+	free(Area);
+	free(Border);
+}
+
+// label the connected components of the pixels < 255, conn is 4 or 8
+// Label (width * height) is 1 ~ NumComp for the components, and 0 for the other pixels
+// the holes use the other connectivity (8 or 4), so that a hole is enclosed by exactly one component
+// comp can be NULL if only the labels are needed, or free it by FreeComponents()
+// return the number of components
+LFD_API int LabelComponents(int *Label, unsigned char *Y, int width, int height, int conn, pComponents comp)
+{
+	int		n, *parent;
+
+	parent = (int *) malloc((width * height / 2 + 2) * sizeof(int));
+	n = LabelPass(Label, Y, width, height, 1, conn, parent);
+	if( comp )
+	{
+		comp->NumComp = n;
+		MeasureComponents(Label, Y, width, height, conn, parent, comp);
+	}
+	free(parent);
+
+	return n;
+}
+
+// the same with LabelComponents() (labels only), parent (width * height / 2 + 2) is given by the caller
+LFD_API int LabelComponentsBuff(int *Label, int *parent, unsigned char *Y, int width, int height, int conn)
+{
+	return LabelPass(Label, Y, width, height, 1, conn, parent);
+}
+
+LFD_API void FreeComponents(pComponents comp)
+{
+	free(comp->Area);
+	free(comp->MinX);
+	free(comp->MaxX);
+	free(comp->MinY);
+	free(comp->MaxY);
+	free(comp->Border);
+	free(comp->NumHole);
+	free(comp->HoleArea);
+}
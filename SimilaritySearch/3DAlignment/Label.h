@@ -0,0 +1,3 @@
+LFD_API int LabelComponents(int *Label, unsigned char *Y, int width, int height, int conn, pComponents comp);
+LFD_API void FreeComponents(pComponents comp);
+LFD_API int LabelComponentsBuff(int *Label, int *parent, unsigned char *Y, int width, int height, int conn);
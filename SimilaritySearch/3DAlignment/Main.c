@@ -3,6 +3,7 @@
 #include <gl/glu.h>
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <malloc.h>
 #include <memory.h>
 #include <time.h>
@@ -24,6 +25,19 @@
 #include "Circularity.h"
 #include "FourierDescriptor.h"
 #include "Eccentricity.h"
+#include "Rasterize.h"
+#include "BitMask.h"
+#include "Thread.h"
+#include "Render.h"
+#include "Decimate.h"
+#include "SilStats.h"
+#include "Span.h"
+#include "Context.h"
+#include "Arena.h"
+#include "Mesh.h"
+#include "ObjParse.h"
+#include "MeshCache.h"
+#include "CleanMesh.h"
 
 #define abs(a) (a>0)?(a):-(a)
 
@@ -39,144 +53,390 @@ char destfn[100];
 
 int			winw = WIDTH, winh = HEIGHT;
 
-pVer		vertex=NULL;
-pTri		triangle=NULL;
-int			NumVer=0, NumTri=0;		// total number of vertex and triangle.
-
 pVer		vertex1, vertex2;
 pTri		triangle1, triangle2;
 int			NumVer1, NumTri1, NumVer2, NumTri2;		// total number of vertex and triangle.
+// model 1 and 2 as triangle mesh, used by all but the legacy alignment
+pMesh		Mesh1, Mesh2;
 
 // translate and scale of model 1 and 2
 Ver				Translate1, Translate2;
 double			Scale1, Scale2;
 
-void FindCenter(unsigned char *srcBuff, int width, int height, double *CenX, double *CenY)
+// render backend, GLUT window is default, "-fbo" and "-soft" in command line render without window
+int				RenderType = RENDER_GLUT;
+pRenderBackend	Backend = NULL;
+// render packed silhouette only (coverage without depth), and extract features from it ( "-mask" in command line )
+int				UseMaskRender = 0;
+// software rasterizer uses all processors ( "-mt" in command line )
+int				UseMultiThread = 0;
+// simplify the model to at most this number of triangles before rendering, 0 is not simplified ( "-budget=N" in command line )
+int				DecimateBudget = 0;
+// Fourier descriptor of the contour resampled to FD_SAMPLE points, all views in one batch ( "-fdresample" in command line )
+int				FdResample = 0;
+// circularity from the chain code of the contour traced by Fourier descriptor, instead of the edge pixels
+// ( "-circontour" in command line weights the diagonal moves by sqrt(2), "-circontour=moves" counts the moves only )
+int				CirContour = 0;
+// workers of the batch indexer 'i' and the query 'q', 0 is the number of processors ( "-threads=N" in command line )
+int				NumIndexThread = 0;
+// directory of the cache of normalized models of 'n' and 'i', NULL is not cached ( "-cache=DIR" in command line )
+char			*MeshCacheDir = NULL;
+// weld the vertices of a model within this tolerance (relative to its size), and remove the degenerate and duplicate triangles,
+// negative is not cleaned ( "-weld" in command line is 1e-6, "-weld=T" is T )
+double			WeldTolerance = -1;
+
+// read a model (fname.obj), clean it by NumThread threads, simplify it to "budget" triangles, translate and scale it,
+// or load it from the cache if the .obj isn't changed since it was cached, return NULL if it can't be read
+pMesh LoadModel(char *fname, int budget, int NumThread, pVer Translate, double *Scale)
 {
-	int					x, y, count;
-	unsigned char		*pImage;
-	int					maxX, minX, maxY, minY;
-	int					MeanX, MeanY; 
-
-	count = 0;
-	pImage = srcBuff;
-
-	// ***********************************************************************************************
-	// if use "mean" to each 2D shape independnetly, the origin will be moved a lot in 3D
-	// if ues "center" to each 2D shape independnetly, the origin will be moved only a little in 3D
-	// if center can be defined in 3D, the origin will not be moved any more.
-	// But this will not very robust in 3D similarity transformation
-	// In addition, to make center of each 2D shape more close to user drawn 2D shapes,
-	// it's better to define center for each 2D shape independently
-
-	// uee center of max and min to be center
-	maxX = maxY = -1;
-	minX = minY = INT_MAX;
-	for (y=0 ; y<height ; y++)
-	for (x=0 ; x<width; x++)
+	char			SrcName[400];
+	pMesh			m;
+	CleanInfo		info;
+
+	sprintf(SrcName, "%s.obj", fname);
+	if( MeshCacheDir && (m = LoadMeshCache(MeshCacheDir, SrcName, budget, WeldTolerance, Translate, Scale)) != NULL )
+		return m;
+
+	if( ReadObjMesh(fname, &m) == 0 )
+		return NULL;
+	if( WeldTolerance >= 0 )
 	{
-		if( *pImage < 255 )
+		CleanMesh(m, WeldTolerance, NumThread, &info);
+		printf("%s ( V: %d -> %d, welded %d, unreferenced %d; T: %d -> %d, degenerate %d, duplicate %d )\n", fname,
+				info.NumVer, m->NumVer, info.Welded, info.Unreferenced, info.NumTri, m->NumTri, info.Degenerate, info.Duplicate);
+	}
+	if( budget > 0 )
+		DecimateMesh(m, budget);
+	TranslateScaleMesh(m, Translate, Scale);
+	if( MeshCacheDir )
+		SaveMeshCache(MeshCacheDir, SrcName, budget, WeldTolerance, m, Translate, *Scale);
+	return m;
+}
+
+// n x n squares in [-0.8, 0.8] of xy plane (bent as z = 0.2xy), 2 triangles in each,
+// the vertices are shared by the triangles, or each triangle has its own 3 vertices (a triangle soup) if soup
+pMesh GridMesh(int n, int soup)
+{
+	pMesh			m, s;
+	double			x, y;
+	int				i, j, k, t, v[4];
+
+	m = CreateMesh((n + 1) * (n + 1), 2 * n * n);
+	for(j=0; j<=n; j++)
+		for(i=0; i<=n; i++)
 		{
-			if( x > maxX ) maxX = x;
-			if( x < minX ) minX = x;
-			if( y > maxY ) maxY = y;
-			if( y < minY ) minY = y;
+			x = -0.8 + 1.6 * i / n;
+			y = -0.8 + 1.6 * j / n;
+			m->x[j*(n+1)+i] = (float)x;
+			m->y[j*(n+1)+i] = (float)y;
+			m->z[j*(n+1)+i] = (float)(0.2 * x * y);
 		}
-		pImage++;
-	}
+	for(j=0, t=0; j<n; j++)
+		for(i=0; i<n; i++, t+=2)
+		{
+			v[0] = j*(n+1)+i;		v[1] = v[0]+1;		v[2] = v[1]+n+1;		v[3] = v[0]+n+1;
+			m->index[3*t] = v[0];	m->index[3*t+1] = v[1];	m->index[3*t+2] = v[2];
+			m->index[3*t+3] = v[0];	m->index[3*t+4] = v[2];	m->index[3*t+5] = v[3];
+		}
+	if( !soup )
+		return m;
 
-	if( maxX > 0 )
+	s = CreateMesh(3 * m->NumTri, m->NumTri);
+	for(k=0; k<3*m->NumTri; k++)
 	{
-		*CenX = (maxX+minX) / 2.0;
-		*CenY = (maxY+minY) / 2.0;
+		s->x[k] = m->x[m->index[k]];
+		s->y[k] = m->y[m->index[k]];
+		s->z[k] = m->z[m->index[k]];
+		s->index[k] = k;
 	}
-	else
-		*CenX = *CenY = -1;		// nothing to be rendered
-
-	// use mean to be center
-/*	count = 0;
-	MeanX = MeanY = 0;
-	for (y=0 ; y<height ; y++)
-	for (x=0 ; x<width; x++)
-	{
-		if( *pImage < 255 )
+	FreeMesh(m);
+	return s;
+}
+
+// number of the pixels of the silhouette seen from +z
+int SilhouetteArea(pRaster ras, unsigned __int64 *Mask, pMesh m)
+{
+	Ver				cam;
+	unsigned __int64 w;
+	int				i, n;
+
+	cam.coor[0] = 0;
+	cam.coor[1] = 0;
+	cam.coor[2] = 1;
+	RasterizeMeshMask(ras, Mask, &cam, m);
+	for(i=0, n=0; i<HEIGHT*MASK_WORDS; i++)
+		for(w=Mask[i]; w; w&=w-1)
+			n ++;
+	return n;
+}
+
+// linear Quantization to 8 bits for each coefficient of ART and Fourier descriptor,
+// the order of ART is the same with that defined in MPEG-7, total 35 coefficients
+void QuantizeQ8(double src_ArtCoeff[ANGLE][CAMNUM][ART_ANGULAR][ART_RADIAL], double src_FdCoeff[ANGLE][CAMNUM][FD_COEFF_NO],
+				unsigned char q8_ArtCoeff[ANGLE][CAMNUM][ART_COEF], unsigned char q8_FdCoeff[ANGLE][CAMNUM][FD_COEFF_NO])
+{
+	int				i, j, k, p, r, itmp;
+
+	for(i=0; i<ANGLE; i++)
+		for(j=0; j<CAMNUM; j++)
 		{
-			MeanX += x;
-			MeanY += y;
-			count ++;
+			k = 0;
+			p = 0;
+			for(r=1 ; r<ART_RADIAL ; r++, k++)
+			{
+				itmp = (int)(QUANT8 *  src_ArtCoeff[i][j][p][r]);
+				if(itmp>255)
+					q8_ArtCoeff[i][j][k] = 255;
+				else
+					q8_ArtCoeff[i][j][k] = itmp;
+			}
+
+			for(p=1; p<ART_ANGULAR ; p++)
+				for(r=0 ; r<ART_RADIAL ; r++, k++)
+				{
+					itmp = (int)(QUANT8 *  src_ArtCoeff[i][j][p][r]);
+					if(itmp>255)
+						q8_ArtCoeff[i][j][k] = 255;
+					else
+						q8_ArtCoeff[i][j][k] = itmp;
+				}
+
+			for(k=0; k<FD_COEFF_NO; k++)
+			{
+				itmp = (int)(QUANT8 * FD_SCALE * src_FdCoeff[i][j][k]);
+				if(itmp>255)
+					q8_FdCoeff[i][j][k] = 255;
+				else
+					q8_FdCoeff[i][j][k] = itmp;
+			}
 		}
-		pImage++;
-	}
+}
 
-	if( count > 0 )
-	{
-		*CenX = (double)MeanX / (double)count;
-		*CenY = (double)MeanY / (double)count;
-	}
-	else
-		*CenX = *CenY = -1;		// nothing to be rendered
-*/
+// quantized ART and Fourier descriptor of all views of a model (translated and scaled)
+// the same with 'n', used to compare the features of simplified model with the original one
+void ExtractShapeQ8(pLfdContext ctx, pMesh m, 
+					unsigned char q8_ArtCoeff[ANGLE][CAMNUM][ART_COEF], unsigned char q8_FdCoeff[ANGLE][CAMNUM][FD_COEFF_NO])
+{
+	double			src_ArtCoeff[ANGLE][CAMNUM][ART_ANGULAR][ART_RADIAL];
+	double			src_FdCoeff[ANGLE][CAMNUM][FD_COEFF_NO];
+
+	ExtractShape(ctx, m, src_ArtCoeff, src_FdCoeff, NULL, NULL);
+	QuantizeQ8(src_ArtCoeff, src_FdCoeff, q8_ArtCoeff, q8_FdCoeff);
 }
 
-void display(void)
+// quantize the features of a model (the same with 'n'), and save to the files of the model
+// they are also written to the files of all models if those are not NULL
+// return 0 if a file can't be written
+int SaveFeatureQ8(char *fname, double src_ArtCoeff[ANGLE][CAMNUM][ART_ANGULAR][ART_RADIAL], double src_FdCoeff[ANGLE][CAMNUM][FD_COEFF_NO],
+				  double cir_Coeff[ANGLE][CAMNUM], double ecc_Coeff[ANGLE][CAMNUM],
+				  FILE *fpt_art_q8, FILE *fpt_art_q4, FILE *fpt_cir_q8, FILE *fpt_ecc_q8, FILE *fpt_fd_q8)
 {
-	int				i, j;
-	glClear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	FILE			*fpt;
+	char			filename[400];
+	int				i, j, k, p, r, a, itmp;
+	unsigned char	q8_ArtCoeff[ANGLE][CAMNUM][ART_COEF];
+	unsigned char	q4_ArtCoeff[ANGLE][CAMNUM][ART_COEF_2];
+	unsigned char	q8_cirCoeff[ANGLE][CAMNUM];
+	unsigned char	q8_FdCoeff[ANGLE][CAMNUM][FD_COEFF_NO];
+	unsigned char	q8_eccCoeff[ANGLE][CAMNUM];
+ 	int				high, low, middle;
+	double			QuantTable[17] = {	0.000000000, 0.003585473, 0.007418411, 0.011535520, 
+										0.015982337, 0.020816302, 0.026111312, 0.031964674, 
+										0.038508176, 0.045926586, 0.054490513, 0.064619488, 
+										0.077016351, 0.092998687, 0.115524524, 0.154032694, 1.000000000};
+
+	// **********************************************************************
+	// save ART feature to file
+//	sprintf(filename, "%s_v1.7.art", fname);
+//	fpt = fopen(filename, "wb");
+//	fwrite(src_ArtCoeff, ANGLE * CAMNUM * ART_ANGULAR * ART_RADIAL, sizeof(double), fpt);
+//	fclose(fpt);
+
+	// linear Quantization to 8 bits for each coefficient (and of Fourier descriptor, saved later)
+	QuantizeQ8(src_ArtCoeff, src_FdCoeff, q8_ArtCoeff, q8_FdCoeff);
+	// save to disk
+	if( fpt_art_q8 )
+		fwrite(q8_ArtCoeff, sizeof(unsigned char), ANGLE * CAMNUM * ART_COEF, fpt_art_q8);
+	sprintf(filename, "%s_q8_v1.8.art", fname);
+	if( (fpt = fopen(filename, "wb")) == NULL )	{	printf("Write %s error!!\n", filename);	return 0;	}
+	fwrite(q8_ArtCoeff, sizeof(unsigned char), ANGLE * CAMNUM * ART_COEF, fpt);
+	fclose(fpt);
+
+	// non-linear Quantization to 4 bits for each coefficient using MPEG-7 quantization table
+	for(i=0; i<ANGLE; i++)
+		for(j=0; j<CAMNUM; j++)
+		{
+			// the order is the same with that defined in MPEG-7, total 35 coefficients
+			k = 0;
+			p = 0;
+			for(r=1 ; r<ART_RADIAL ; r++, k++)
+			{
+				high = 17;
+				low = 0;
+				while(high-low > 1)
+				{
+					middle = (high+low) / 2;
+
+					if(QuantTable[middle] < src_ArtCoeff[i][j][p][r])
+						low = middle;
+					else
+						high = middle;
+				}
+				q8_ArtCoeff[i][j][k] = low;
+			}
+			for(p=1; p<ART_ANGULAR ; p++)
+				for(r=0 ; r<ART_RADIAL ; r++, k++)
+				{
+					high = 17;
+					low = 0;
+					while(high-low > 1)
+					{
+						middle = (high+low) / 2;
 
-	glPushMatrix();				
-//		glColor3f((GLfloat)0.0, (GLfloat)0.0, (GLfloat)0.0);
-		for(i = 0; i<NumTri; i++)
+						if(QuantTable[middle] < src_ArtCoeff[i][j][p][r])
+							low = middle;
+						else
+							high = middle;
+					}
+					q8_ArtCoeff[i][j][k] = low;
+				}
+		}
+
+	for(i=0; i<ANGLE; i++)
+		for(j=0; j<CAMNUM; j++)
+			for(k=0, a=0; k<ART_COEF; k+=2, a++)
+				if( k+1 < ART_COEF )
+					q4_ArtCoeff[i][j][a] = ( (q8_ArtCoeff[i][j][k] << 4) & 0xf0 ) | 
+										( q8_ArtCoeff[i][j][k+1] & 0x0f );
+				else
+					q4_ArtCoeff[i][j][a] = ( (q8_ArtCoeff[i][j][k] << 4) & 0xf0 );
+
+	// save to disk
+	if( fpt_art_q4 )
+		fwrite(q4_ArtCoeff, sizeof(unsigned char), ANGLE * CAMNUM * ART_COEF_2, fpt_art_q4);
+	sprintf(filename, "%s_q4_v1.8.art", fname);
+	if( (fpt = fopen(filename, "wb")) == NULL )	{	printf("Write %s error!!\n", filename);	return 0;	}
+	fwrite(q4_ArtCoeff, sizeof(unsigned char), ANGLE * CAMNUM * ART_COEF_2, fpt);
+	fclose(fpt);
+
+	// **********************************************************************
+	// save color descriptor to disk
+//	fwrite(CompactColor, sizeof(unsigned char), ANGLE * CAMNUM * sizeof(unsigned __int64), fpt_ccd);
+//	sprintf(filename, "%s.ccd", fname);
+//	if( (fpt = fopen(filename, "wb")) == NULL )	{	printf("Write %s error!!\n", filename);	return 0;	}
+//	fwrite(CompactColor, sizeof(unsigned char), ANGLE * CAMNUM * sizeof(unsigned __int64), fpt);
+//	fclose(fpt);
+
+	// **********************************************************************
+	// save circularity feature to file
+//	sprintf(filename, "%s.cir", fname);
+//	fpt = fopen(filename, "wb");
+//	fwrite(cir_Coeff, ANGLE * CAMNUM, sizeof(double), fpt);
+//	fclose(fpt);
+
+	// linear Quantization to 8 bits for each coefficient
+	for(i=0; i<ANGLE; i++)
+		for(j=0; j<CAMNUM; j++)
+		{
+			itmp = (int)(QUANT8 *  cir_Coeff[i][j]);
+			if(itmp>255)		q8_cirCoeff[i][j] = 255;
+			else				q8_cirCoeff[i][j] = itmp;
+		}
+	// save to disk
+	if( fpt_cir_q8 )
+		fwrite(q8_cirCoeff, sizeof(unsigned char), ANGLE * CAMNUM, fpt_cir_q8);
+	sprintf(filename, "%s_q8_v1.8.cir", fname);
+	if( (fpt = fopen(filename, "wb")) == NULL )	{	printf("Write %s error!!\n", filename);	return 0;	}
+	fwrite(q8_cirCoeff, sizeof(unsigned char), ANGLE * CAMNUM, fpt);
+	fclose(fpt);
+
+	// **********************************************************************
+	// save eccentricity feature to file
+	// linear Quantization to 8 bits for each coefficient
+	for(i=0; i<ANGLE; i++)
+		for(j=0; j<CAMNUM; j++)
 		{
-		//	glColor3f((GLfloat)triangle[i].r, (GLfloat)triangle[i].g, (GLfloat)triangle[i].b);
-			glBegin(GL_POLYGON);
-				for(j=0; j<triangle[i].NodeName; j++)
-					glVertex3d(vertex[triangle[i].v[j]].coor[0], vertex[triangle[i].v[j]].coor[1], vertex[triangle[i].v[j]].coor[2]);
-			glEnd();
+			itmp = (int)(QUANT8 * ecc_Coeff[i][j]);
+			if(itmp>255)		q8_eccCoeff[i][j] = 255;
+			else				q8_eccCoeff[i][j] = itmp;
 		}
-	glPopMatrix();				
+	// save to disk
+	if( fpt_ecc_q8 )
+		fwrite(q8_eccCoeff, sizeof(unsigned char), ANGLE * CAMNUM, fpt_ecc_q8);
+	sprintf(filename, "%s_q8_v1.8.ecc", fname);
+	if( (fpt = fopen(filename, "wb")) == NULL )	{	printf("Write %s error!!\n", filename);	return 0;	}
+	fwrite(q8_eccCoeff, sizeof(unsigned char), ANGLE * CAMNUM, fpt);
+	fclose(fpt);
+
+	// **********************************************************************
+	// save Fourier descriptor feature to file
+//	fwrite(src_FdCoeff, ANGLE * CAMNUM * FD_COEFF_NO, sizeof(double), fpt_fd);
+//	sprintf(filename, "%s.fd", fname);
+//	fpt = fopen(filename, "wb");
+//	fwrite(src_FdCoeff, ANGLE * CAMNUM * FD_COEFF_NO, sizeof(double), fpt);
+//	fclose(fpt);
+
+	// quantized by QuantizeQ8() with ART
+	if( fpt_fd_q8 )
+		fwrite(q8_FdCoeff, ANGLE * CAMNUM * FD_COEFF_NO, sizeof(unsigned char), fpt_fd_q8);
+	sprintf(filename, "%s_q8_v1.8.fd", fname);
+	if( (fpt = fopen(filename, "wb")) == NULL )	{	printf("Write %s error!!\n", filename);	return 0;	}
+	fwrite(q8_FdCoeff, ANGLE * CAMNUM * FD_COEFF_NO, sizeof(unsigned char), fpt);
+	fclose(fpt);
+
+	return 1;
+}
 
-	glutSwapBuffers();
+// models of list.txt for the workers of 'i', each worker has its own context (renderer and buffers)
+typedef struct IndexJob_ {
+	char			**Name;
+	pLfdContext		Context[MAX_THREAD];
+	int				*Done;			// 1 if the files of the model are written, -1 if failed, 0 if the model can't be read
+	int				*NumVer, *NumTri;
+	double			*Time;
+}IndexJob;
+
+// the same with a model of 'n', run by worker "id"
+void IndexModel(void *Param, int id, int job)
+{
+	IndexJob		*ij = (IndexJob *)Param;
+	pMesh			m;
+	Ver				Translate;
+	double			Scale, t0;
+	double			ArtCoeff[ANGLE][CAMNUM][ART_ANGULAR][ART_RADIAL];
+	double			FdCoeff[ANGLE][CAMNUM][FD_COEFF_NO];
+	double			CirCoeff[ANGLE][CAMNUM], EccCoeff[ANGLE][CAMNUM];
+
+	t0 = WallClock();
+	// simplify before rendering, the models are in parallel, so that each one is cleaned in one thread
+	if( (m = LoadModel(ij->Name[job], DecimateBudget, 1, &Translate, &Scale)) == NULL )
+		return;
+	ExtractShape(ij->Context[id], m, ArtCoeff, FdCoeff, CirCoeff, EccCoeff);
+	ij->NumVer[job] = m->NumVer;
+	ij->NumTri[job] = m->NumTri;
+	FreeMesh(m);
+
+	ij->Time[job] = WallClock() - t0;
+	ij->Done[job] = SaveFeatureQ8(ij->Name[job], ArtCoeff, FdCoeff, CirCoeff, EccCoeff, NULL, NULL, NULL, NULL, NULL) ? 1 : -1;
 }
 
-void RenderToMem(unsigned char *bmBits, unsigned char *bmColor, pVer CamVertex, pVer v, pTri t, int nv, int nt)
+// append the file of a model (fname + suffix, "size" bytes) to the file of all models
+int AppendFeature(FILE *dst, char *fname, char *suffix, int size)
 {
-/*	
-	// this is the same with reshape(), so this didn't do again
-	glMatrixMode (GL_PROJECTION);
-	glLoadIdentity ();
-	gluPerspective(100.0, (GLfloat) winw/(GLfloat) winh, 0.1, 10.0);
-//	glOrtho(-1, 1, -1, 1, 0.1, 100.0);
-	glViewport (0, 0, (GLsizei) winw, (GLsizei) winh);
-*/
-	// test LookAt Up
-/*	vector	v1, v2, v3;
-	v1.x = CamVertex->coor[0];
-	v1.y = CamVertex->coor[1];
-	v1.z = CamVertex->coor[2];
-	v2.x = 0;
-	v2.y = 1;
-	v2.z = 0;
-	v3 = cross(v1, v2);*/
-
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-//	gluLookAt(CAMSCALE*CamVertex->coor[0], CAMSCALE*CamVertex->coor[1], CAMSCALE*CamVertex->coor[2],
-	gluLookAt(CamVertex->coor[0], CamVertex->coor[1], CamVertex->coor[2],
-				0, 0, 0,
-				0, 1, 0);
-//				v3.x, v3.y, v3.z);
-
-	vertex = v;
-	triangle = t;
-	NumVer = nv;
-	NumTri = nt;
-	display();
-
-	glReadBuffer(GL_BACK);
-//	glReadPixels(0, 0, winw, winh, GL_RED, GL_UNSIGNED_BYTE, bmBits);
-	glReadPixels(0, 0, winw, winh, GL_DEPTH_COMPONENT, GL_UNSIGNED_BYTE, bmBits);
-	if( bmColor )
-		glReadPixels(0, 0, winw, winh, GL_RGB, GL_UNSIGNED_BYTE, bmColor);
+	unsigned char	buf[ANGLE * CAMNUM * ART_COEF];		// the largest one
+	char			filename[400];
+	FILE			*fpt;
+	int				n;
+
+	sprintf(filename, "%s%s", fname, suffix);
+	if( (fpt = fopen(filename, "rb")) == NULL )
+		return 0;
+	n = (int)fread(buf, sizeof(unsigned char), size, fpt);
+	fclose(fpt);
+	if( n != size )
+		return 0;
+	fwrite(buf, sizeof(unsigned char), size, dst);
+	return 1;
 }
 
 void keyboard (unsigned char key, int x, int y)
@@ -188,18 +448,17 @@ void keyboard (unsigned char key, int x, int y)
 	int				CamNumVer[ANGLE], CamNumTri[ANGLE];		// total number of vertex and triangle.
 	FILE			*fpt, *fpt1, *fpt2, *fpt3, *fpt4, *fpt_art_q8, *fpt_art_q4, *fpt_fd_q8, *fpt_fd, *fpt_cir_q8, *fpt_ecc_q8;//, *fpt_ccd;
 	int				i, j, k, srcCam, destCam, p, r, a, itmp;
-	double			cost[ANGLE][ANGLE][CAMNUM_2][CAMNUM_2];
+	double			(*cost)[ANGLE][CAMNUM_2][CAMNUM_2];
 	double			**matrix;
 	static int		UseCam = 2;
 	clock_t			start, finish;
 	double			Err;
 	// for region shape descriptor
-	double			src_ArtCoeff[ANGLE][CAMNUM][ART_ANGULAR][ART_RADIAL];
-	double			dest_ArtCoeff[ANGLE][CAMNUM][ART_ANGULAR][ART_RADIAL];
+	double			(*src_ArtCoeff)[CAMNUM][ART_ANGULAR][ART_RADIAL];
+	double			(*dest_ArtCoeff)[CAMNUM][ART_ANGULAR][ART_RADIAL];
 	double			MinErr, err;
 	int				align[60][CAMNUM_2];
 	unsigned char	q8_ArtCoeff[ANGLE][CAMNUM][ART_COEF];
-	unsigned char	q4_ArtCoeff[ANGLE][CAMNUM][ART_COEF_2];
 	// for color decsriptor
 	unsigned __int64 CompactColor[ANGLE][CAMNUM];	// 63 bits for each image
 	unsigned __int64 dest_CompactColor[ANGLE][CAMNUM];	// 63 bits for each image
@@ -207,10 +466,8 @@ void keyboard (unsigned char key, int x, int y)
 	double			cir_Coeff[ANGLE][CAMNUM];
 	unsigned char	q8_cirCoeff[ANGLE][CAMNUM], dest_cirCoeff[ANGLE][CAMNUM];
 	// for fourier descriptor
-	double			src_FdCoeff[ANGLE][CAMNUM][FD_COEFF_NO], dest_FdCoeff[ANGLE][CAMNUM][FD_COEFF_NO];
+	double			(*src_FdCoeff)[CAMNUM][FD_COEFF_NO], (*dest_FdCoeff)[CAMNUM][FD_COEFF_NO];
 	unsigned char	q8_FdCoeff[ANGLE][CAMNUM][FD_COEFF_NO];
-	sPOINT			*Contour;
-	unsigned char	*ContourMask;
 	// for eccentricity
 	double			ecc_Coeff[ANGLE][CAMNUM];
 	unsigned char	q8_eccCoeff[ANGLE][CAMNUM], dest_eccCoeff[ANGLE][CAMNUM];
@@ -220,13 +477,40 @@ void keyboard (unsigned char key, int x, int y)
 	// quantization version
 	char			fname[400];
 //	char			fn[200];
- 	int				high, low, middle;
-	double			QuantTable[17] = {	0.000000000, 0.003585473, 0.007418411, 0.011535520, 
-										0.015982337, 0.020816302, 0.026111312, 0.031964674, 
-										0.038508176, 0.045926586, 0.054490513, 0.064619488, 
-										0.077016351, 0.092998687, 0.115524524, 0.154032694, 1.000000000};
-	double			CenX[CAMNUM], CenY[CAMNUM];
-	int				total;
+	// for scaling of multi-thread rendering
+	pRaster			BenchRaster;
+	unsigned char	*RefBuff, *ThreadBuff;
+	unsigned __int64 *RefMask, *ThreadMask;
+	int				MaxThread, NumThread, Same;
+	double			t0, t1, t2, DepthTime1, MaskTime1;
+	// for benchmark of render backend
+	pRenderBackend	RefBackend;
+	int				DiffPixel;
+	// for fidelity of simplified model
+	unsigned char	dec_ArtCoeff[ANGLE][CAMNUM][ART_COEF], dec_FdCoeff[ANGLE][CAMNUM][FD_COEFF_NO];
+	int				Budget[4], NumBudget, ArtMax, FdMax;
+	int				Area0, Area1;
+	pLfdContext		Context;
+	// for batch indexer
+	IndexJob		ij;
+	int				NumName, MaxName, Fail;
+	pRenderBackend	WorkBackend;
+	double			ArtMean, FdMean;
+	// for latency of a query
+	pLfdContext		ViewContext[MAX_THREAD];
+	double			view_cirCoeff[ANGLE][CAMNUM], view_eccCoeff[ANGLE][CAMNUM];
+	// scratch memory of the large arrays, kept by all keys
+	static pArena	Scratch = NULL;
+
+	// the large arrays are not on the stack, the buffers of the views are of LfdContext
+	if( Scratch == NULL )
+		Scratch = CreateArena((int)(ANGLE * ( sizeof(*cost) + 2 * sizeof(*src_ArtCoeff) + 2 * sizeof(*src_FdCoeff) ) + 64));
+	ArenaReset(Scratch);
+	cost = (double (*)[ANGLE][CAMNUM_2][CAMNUM_2]) ArenaAlloc(Scratch, (int)(ANGLE * sizeof(*cost)));
+	src_ArtCoeff = (double (*)[CAMNUM][ART_ANGULAR][ART_RADIAL]) ArenaAlloc(Scratch, (int)(ANGLE * sizeof(*src_ArtCoeff)));
+	dest_ArtCoeff = (double (*)[CAMNUM][ART_ANGULAR][ART_RADIAL]) ArenaAlloc(Scratch, (int)(ANGLE * sizeof(*dest_ArtCoeff)));
+	src_FdCoeff = (double (*)[CAMNUM][FD_COEFF_NO]) ArenaAlloc(Scratch, (int)(ANGLE * sizeof(*src_FdCoeff)));
+	dest_FdCoeff = (double (*)[CAMNUM][FD_COEFF_NO]) ArenaAlloc(Scratch, (int)(ANGLE * sizeof(*dest_FdCoeff)));
 
 	switch (key) 
 	{
@@ -286,7 +570,7 @@ void keyboard (unsigned char key, int x, int y)
 				// capture CAMNUM silhouette of srcfn to memory
 				// 0.24 sec for an example (3012 triangles)
 				for(i=0; i<CAMNUM; i++)
-					RenderToMem(srcBuff[i], NULL, CamVertex[srcCam]+i, vertex1, triangle1, NumVer1, NumTri1);
+					RenderView(Backend, srcBuff[i], NULL, CamVertex[srcCam]+i, vertex1, triangle1, NumVer1, NumTri1);
 
 				// 0.02 sec for an example
 				FindRadius(srcBuff);
@@ -310,7 +594,7 @@ void keyboard (unsigned char key, int x, int y)
 				// capture CAMNUM silhouette of dest to memory
 				// 0.47 sec for an example (18110 triangles)
 				for(i=0; i<CAMNUM; i++)
-					RenderToMem(destBuff[i], NULL, CamVertex[destCam]+i, vertex2, triangle2, NumVer2, NumTri2);
+					RenderView(Backend, destBuff[i], NULL, CamVertex[destCam]+i, vertex2, triangle2, NumVer2, NumTri2);
 
 				// 0.02 sec for an example
 				FindRadius(destBuff);
@@ -340,7 +624,7 @@ void keyboard (unsigned char key, int x, int y)
 			matrix[0][0] = matrix[1][1] = matrix[2][2] = matrix[3][3] = 1;
 
 			// get the transformation matrix of model 2 based on model 1
-			Err = RecoverAffine(matrix, cost, &UseCam);
+			Err = RecoverAffine(matrix, cost, &UseCam, srcfn, destfn);
 
 			Rotate(vertex2, NumVer2, matrix);
 
@@ -390,7 +674,7 @@ void keyboard (unsigned char key, int x, int y)
 
 			// refine rotate of model 2 to fit the model 1
 			Err = Refine(src_ArtCoeff[UseCam], vertex2, triangle2, NumVer2, NumTri2, UseCam,
-						 CamVertex[UseCam], CamTriangle[UseCam], CamNumVer[UseCam], CamNumTri[UseCam]);
+						 CamVertex[UseCam], CamTriangle[UseCam], CamNumVer[UseCam], CamNumTri[UseCam], Backend, srcfn, destfn);
 
 			// refine Translate and scale of model 2 again
 			TranslateScale(vertex2, NumVer2, destfn, &Translate2, &Scale2);
@@ -444,28 +728,13 @@ void keyboard (unsigned char key, int x, int y)
 // *************************************************************************************************
 	// calculate feature and save to file
 	case 'n':
-		// initialize ART
-		GenerateBasisLUT();
-		// initialize: read camera set
-		for(destCam=0; destCam<ANGLE; destCam++)
+		// initialize ART and the other tables, read camera set, and buffers of the views
+		if( (Context = CreateLfdContext(Backend, "12_", UseMaskRender, FdResample)) == NULL )
 		{
-			sprintf(filename, "12_%d", destCam);
-			ReadObj(filename, CamVertex+destCam, CamTriangle+destCam, CamNumVer+destCam, CamNumTri+destCam);
-		}
-
-		for(i=0; i<CAMNUM; i++)
-		{
-			srcBuff[i] = (unsigned char *) malloc (winw * winh * sizeof(unsigned char));
-			ColorBuff[i] = (unsigned char *) malloc (3 * winw * winh * sizeof(unsigned char));
+			printf("Camera set 12_*.obj does not exist.\n");
+			break;
 		}
-		YuvBuff = (unsigned char *) malloc (3 * winw * winh * sizeof(unsigned char));
-		// add edge to test retrieval
-		EdgeBuff = (unsigned char *) malloc (winw * winh * sizeof(unsigned char));
-
-		// for Fourier Descriptor
-		total = winw * winh;
-		Contour = (sPOINT *) malloc( total * sizeof(sPOINT));
-		ContourMask = (unsigned char *) malloc( total * sizeof(unsigned char));
+		Context->CirContour = CirContour;
 
 		fpt1 = fopen("list.txt", "r");
 		fpt_art_q4 = fopen("all_q4_v1.8.art", "wb");
@@ -482,272 +751,28 @@ void keyboard (unsigned char key, int x, int y)
 			start = clock();
 
 			fname[strlen(fname)-1] = 0x00;
-			// get the translatation and scale of the two model
-			if( ReadObj(fname, &vertex1, &triangle1, &NumVer1, &NumTri1) == 0 )
+			// get the translatation and scale of the two model, simplify before rendering
+			if( (Mesh1 = LoadModel(fname, DecimateBudget, 0, &Translate1, &Scale1)) == NULL )
 				continue;
 
-			// ****************************************************************
-			// Corase alignment
-			// ****************************************************************
-
-			// Translate and scale model 1
-			TranslateScale(vertex1, NumVer1, triangle1, NumTri1, fname, &Translate1, &Scale1);
-
-			// read RED only, so size is winw*winh
-			for(srcCam=0; srcCam<ANGLE; srcCam++)
-			{
-				// capture CAMNUM silhouette of srcfn to memory
-				for(i=0; i<CAMNUM; i++)
-//					RenderToMem(srcBuff[i], ColorBuff[i], CamVertex[srcCam]+i, vertex1, triangle1, NumVer1, NumTri1);
-					RenderToMem(srcBuff[i], NULL, CamVertex[srcCam]+i, vertex1, triangle1, NumVer1, NumTri1);
-
-				// find center for each shape
-				for(i=0; i<CAMNUM; i++)
-					FindCenter(srcBuff[i], winw, winh, CenX+i, CenY+i);
-
-				// from silhouette
-//				for(i=0; i<CAMNUM; i++)
-//				{
-//					EdgeDetectSil(srcBuff[i], winw, winh);
-//					sprintf(fn, "%s_%2d_%02d.bmp", fname, srcCam, i);
-//					WriteBitmap8(srcBuff[i], winw, winh, fn);
-//				}
-
-				// get color descriptor
-//				for(i=0; i<CAMNUM; i++)
-//				{
-//					RGB_To_YUV(YuvBuff, ColorBuff[i], winw, winh);
-//					ExtractCCD(YuvBuff, CompactColor[srcCam]+i, srcBuff[i]);
-					// print the results of compact color
-//					for(j=0; j<NUM_BINS-1; j++)
-//						if( CompactColor[i] & (0x8000000000000000 >> j) )
-//							printf("1");
-//						else
-//							printf("0");
-//					printf("\n");
-//				}
-
-				// get Zernike moment
-				FindRadius(srcBuff, CenX, CenY);
-				for(i=0; i<CAMNUM; i++)
-				{
-					// from depth
-					// EdgeDetect(EdgeBuff, srcBuff[i], winw, winh);
-//					WriteBitmap8(srcBuff[i], winw, winh, "test1.bmp");
-//					WriteBitmap8(EdgeBuff, winw, winh, "test2.bmp");
-					ExtractCoefficients(srcBuff[i], src_ArtCoeff[srcCam][i], EdgeBuff, CenX[i], CenY[i]);
-				}
-
-				// get Fourier descriptor
-				for(i=0; i<CAMNUM; i++)
-					FourierDescriptor(src_FdCoeff[srcCam][i], srcBuff[i], winw, winh, Contour, ContourMask, CenX[i], CenY[i]);
-
-				// get eccentricity
-				for(i=0; i<CAMNUM; i++)
-					ecc_Coeff[srcCam][i] = Eccentricity(srcBuff[i], winw, winh, CenX[i], CenY[i]);
-
-				// get circularity
-				for(i=0; i<CAMNUM; i++)
-				{
-					EdgeDetectSil(EdgeBuff, srcBuff[i], winw, winh);
-					cir_Coeff[srcCam][i] = Circularity(srcBuff[i], winw, winh, EdgeBuff);
-				}
-
-			}
-
-			// free memory of 3D model
-			free(vertex1);
-			free(triangle1);
+			// ART, Fourier descriptor, circularity and eccentricity of all views, the same with 'i' and 'q'
+			ExtractShape(Context, Mesh1, src_ArtCoeff, src_FdCoeff, cir_Coeff, ecc_Coeff);
 
 			// record execute time --- end
 			finish = clock();
 			fpt = fopen("feature_time.txt", "a");
-			fprintf(fpt, "%s ( V: %d T: %d )\t: %f sec;\n", fname, NumVer1, NumTri1, (double)(finish - start) / CLOCKS_PER_SEC );
+			fprintf(fpt, "%s ( V: %d T: %d )\t: %f sec;\n", fname, Mesh1->NumVer, Mesh1->NumTri, (double)(finish - start) / CLOCKS_PER_SEC );
 			fclose(fpt);
+			FreeMesh(Mesh1);
 
-			// **********************************************************************
-			// save ART feature to file
-//			sprintf(filename, "%s_v1.7.art", fname);
-//			fpt = fopen(filename, "wb");
-//			fwrite(src_ArtCoeff, ANGLE * CAMNUM * ART_ANGULAR * ART_RADIAL, sizeof(double), fpt);
-//			fclose(fpt);
-
-			// linear Quantization to 8 bits for each coefficient
-			for(i=0; i<ANGLE; i++)
-				for(j=0; j<CAMNUM; j++)
-				{
-					// the order is the same with that defined in MPEG-7, total 35 coefficients
-					k = 0;
-					p = 0;
-					for(r=1 ; r<ART_RADIAL ; r++, k++)
-					{
-						itmp = (int)(QUANT8 *  src_ArtCoeff[i][j][p][r]);
-						if(itmp>255)
-							q8_ArtCoeff[i][j][k] = 255;
-						else
-							q8_ArtCoeff[i][j][k] = itmp;
-					}
-
-					for(p=1; p<ART_ANGULAR ; p++)
-						for(r=0 ; r<ART_RADIAL ; r++, k++)
-						{
-							itmp = (int)(QUANT8 *  src_ArtCoeff[i][j][p][r]);
-							if(itmp>255)
-								q8_ArtCoeff[i][j][k] = 255;
-							else
-								q8_ArtCoeff[i][j][k] = itmp;
-						}
-				}
-			// save to disk
-			fwrite(q8_ArtCoeff, sizeof(unsigned char), ANGLE * CAMNUM * ART_COEF, fpt_art_q8);
-			sprintf(filename, "%s_q8_v1.8.art", fname);
-			if( (fpt = fopen(filename, "wb")) == NULL )	{	printf("Write %s error!!\n", filename);	return;	}
-			fwrite(q8_ArtCoeff, sizeof(unsigned char), ANGLE * CAMNUM * ART_COEF, fpt);
-			fclose(fpt);
-
-			// non-linear Quantization to 4 bits for each coefficient using MPEG-7 quantization table
-			for(i=0; i<ANGLE; i++)
-				for(j=0; j<CAMNUM; j++)
-				{
-					// the order is the same with that defined in MPEG-7, total 35 coefficients
-					k = 0;
-					p = 0;
-					for(r=1 ; r<ART_RADIAL ; r++, k++)
-					{
-						high = 17;
-						low = 0;
-						while(high-low > 1)
-						{
-							middle = (high+low) / 2;
-
-							if(QuantTable[middle] < src_ArtCoeff[i][j][p][r])
-								low = middle;
-							else
-								high = middle;
-						}
-						q8_ArtCoeff[i][j][k] = low;
-					}
-					for(p=1; p<ART_ANGULAR ; p++)
-						for(r=0 ; r<ART_RADIAL ; r++, k++)
-						{
-							high = 17;
-							low = 0;
-							while(high-low > 1)
-							{
-								middle = (high+low) / 2;
-
-								if(QuantTable[middle] < src_ArtCoeff[i][j][p][r])
-									low = middle;
-								else
-									high = middle;
-							}
-							q8_ArtCoeff[i][j][k] = low;
-						}
-				}
-
-			for(i=0; i<ANGLE; i++)
-				for(j=0; j<CAMNUM; j++)
-					for(k=0, a=0; k<ART_COEF; k+=2, a++)
-						if( k+1 < ART_COEF )
-							q4_ArtCoeff[i][j][a] = ( (q8_ArtCoeff[i][j][k] << 4) & 0xf0 ) | 
-												( q8_ArtCoeff[i][j][k+1] & 0x0f );
-						else
-							q4_ArtCoeff[i][j][a] = ( (q8_ArtCoeff[i][j][k] << 4) & 0xf0 );
-
-			// save to disk
-			fwrite(q4_ArtCoeff, sizeof(unsigned char), ANGLE * CAMNUM * ART_COEF_2, fpt_art_q4);
-			sprintf(filename, "%s_q4_v1.8.art", fname);
-			if( (fpt = fopen(filename, "wb")) == NULL )	{	printf("Write %s error!!\n", filename);	return;	}
-			fwrite(q4_ArtCoeff, sizeof(unsigned char), ANGLE * CAMNUM * ART_COEF_2, fpt);
-			fclose(fpt);
-
-			// **********************************************************************
-			// save color descriptor to disk
-//			fwrite(CompactColor, sizeof(unsigned char), ANGLE * CAMNUM * sizeof(unsigned __int64), fpt_ccd);
-//			sprintf(filename, "%s.ccd", fname);
-//			if( (fpt = fopen(filename, "wb")) == NULL )	{	printf("Write %s error!!\n", filename);	return;	}
-//			fwrite(CompactColor, sizeof(unsigned char), ANGLE * CAMNUM * sizeof(unsigned __int64), fpt);
-//			fclose(fpt);
-
-			// **********************************************************************
-			// save circularity feature to file
-//			sprintf(filename, "%s.cir", fname);
-//			fpt = fopen(filename, "wb");
-//			fwrite(cir_Coeff, ANGLE * CAMNUM, sizeof(double), fpt);
-//			fclose(fpt);
-
-			// linear Quantization to 8 bits for each coefficient
-			for(i=0; i<ANGLE; i++)
-				for(j=0; j<CAMNUM; j++)
-				{
-					itmp = (int)(QUANT8 *  cir_Coeff[i][j]);
-					if(itmp>255)		q8_cirCoeff[i][j] = 255;
-					else				q8_cirCoeff[i][j] = itmp;
-				}
-			// save to disk
-			fwrite(q8_cirCoeff, sizeof(unsigned char), ANGLE * CAMNUM, fpt_cir_q8);
-			sprintf(filename, "%s_q8_v1.8.cir", fname);
-			if( (fpt = fopen(filename, "wb")) == NULL )	{	printf("Write %s error!!\n", filename);	return;	}
-			fwrite(q8_cirCoeff, sizeof(unsigned char), ANGLE * CAMNUM, fpt);
-			fclose(fpt);
-
-			// **********************************************************************
-			// save eccentricity feature to file
-			// linear Quantization to 8 bits for each coefficient
-			for(i=0; i<ANGLE; i++)
-				for(j=0; j<CAMNUM; j++)
-				{
-					itmp = (int)(QUANT8 * ecc_Coeff[i][j]);
-					if(itmp>255)		q8_eccCoeff[i][j] = 255;
-					else				q8_eccCoeff[i][j] = itmp;
-				}
-			// save to disk
-			fwrite(q8_eccCoeff, sizeof(unsigned char), ANGLE * CAMNUM, fpt_ecc_q8);
-			sprintf(filename, "%s_q8_v1.8.ecc", fname);
-			if( (fpt = fopen(filename, "wb")) == NULL )	{	printf("Write %s error!!\n", filename);	return;	}
-			fwrite(q8_eccCoeff, sizeof(unsigned char), ANGLE * CAMNUM, fpt);
-			fclose(fpt);
-
-			// **********************************************************************
-			// save Fourier descriptor feature to file
-//			fwrite(src_FdCoeff, ANGLE * CAMNUM * FD_COEFF_NO, sizeof(double), fpt_fd);
-//			sprintf(filename, "%s.fd", fname);
-//			fpt = fopen(filename, "wb");
-//			fwrite(src_FdCoeff, ANGLE * CAMNUM * FD_COEFF_NO, sizeof(double), fpt);
-//			fclose(fpt);
-
-			for(i=0; i<ANGLE; i++)
-				for(j=0; j<CAMNUM; j++)
-				{
-					for(k=0; k<FD_COEFF_NO; k++)
-					{
-						itmp = (int)(QUANT8 * FD_SCALE * src_FdCoeff[i][j][k]);
-						if(itmp>255)
-							q8_FdCoeff[i][j][k] = 255;
-						else
-							q8_FdCoeff[i][j][k] = itmp;
-					}
-				}
-
-			fwrite(q8_FdCoeff, ANGLE * CAMNUM * FD_COEFF_NO, sizeof(unsigned char), fpt_fd_q8);
-			sprintf(filename, "%s_q8_v1.8.fd", fname);
-			fpt = fopen(filename, "wb");
-			fwrite(q8_FdCoeff, ANGLE * CAMNUM * FD_COEFF_NO, sizeof(unsigned char), fpt);
-			fclose(fpt);
+			// quantize and save to disk
+			if( !SaveFeatureQ8(fname, src_ArtCoeff, src_FdCoeff, cir_Coeff, ecc_Coeff, fpt_art_q8, fpt_art_q4, fpt_cir_q8, fpt_ecc_q8, fpt_fd_q8) )
+				return;
 
 //			printf("%d.%s OK.\n", Count++, fname);
 			printf("%d.", Count++);
 		}
 
-		for(i=0; i<CAMNUM; i++)
-		{
-			free(srcBuff[i]);
-			free(ColorBuff[i]);
-		}
-		free(YuvBuff);
-		free(EdgeBuff);
-		free(Contour);
-		free(ContourMask);
 		fclose(fpt1);
 		fclose(fpt_art_q8);
 		fclose(fpt_art_q4);
@@ -756,12 +781,120 @@ void keyboard (unsigned char key, int x, int y)
 		fclose(fpt_ecc_q8);
 //		fclose(fpt_fd);
 		fclose(fpt_fd_q8);
-		for(destCam=0; destCam<ANGLE; destCam++)
+		FreeLfdContext(Context);
+		Backend->DrawMesh(Backend, NULL);		// the mesh is freed
+		break;
+
+// *************************************************************************************************
+	// the same with 'n' by a pool of workers with work stealing, each one has its own renderer and buffers
+	// ("-soft" only, the other backends have one context and use one worker)
+	// the files of all models are written in the order of list.txt after all models are done
+	case 'i':
+		// read all names first, so that a worker can take any of them
+		if( (fpt1 = fopen("list.txt", "r")) == NULL )
 		{
-			free(CamVertex[destCam]);
-			free(CamTriangle[destCam]);
+			printf("list.txt does not exist.\n");
+			break;
 		}
-		NumTri = 0;
+		NumName = 0;
+		MaxName = 1024;
+		ij.Name = (char **) malloc (MaxName * sizeof(char *));
+		while( fgets(fname, 400, fpt1) )
+		{
+			fname[strlen(fname)-1] = 0x00;
+			if( NumName == MaxName )
+			{
+				MaxName *= 2;
+				ij.Name = (char **) realloc (ij.Name, MaxName * sizeof(char *));
+			}
+			ij.Name[NumName] = (char *) malloc (strlen(fname) + 1);
+			strcpy(ij.Name[NumName++], fname);
+		}
+		fclose(fpt1);
+		ij.Done = (int *) calloc (NumName + 1, sizeof(int));
+		ij.NumVer = (int *) calloc (NumName + 1, sizeof(int));
+		ij.NumTri = (int *) calloc (NumName + 1, sizeof(int));
+		ij.Time = (double *) calloc (NumName + 1, sizeof(double));
+
+		// worker 0 uses the backend of the program, the others render by their own software rasterizer
+		NumThread = ( NumIndexThread > 0 ) ? NumIndexThread : GetCpuNum();
+		if( NumThread > MAX_THREAD )		NumThread = MAX_THREAD;
+		if( RenderType != RENDER_SOFT )		NumThread = 1;
+		for(i=0; i<NumThread; i++)
+		{
+			if( (WorkBackend = ( i == 0 ) ? Backend : CreateRenderBackend(RENDER_SOFT)) == NULL )
+				break;
+			if( (ij.Context[i] = CreateLfdContext(WorkBackend, "12_", UseMaskRender, FdResample)) == NULL )
+			{
+				if( i > 0 )
+					FreeRenderBackend(WorkBackend);
+				break;
+			}
+			ij.Context[i]->CirContour = CirContour;
+		}
+
+		if( i == NumThread )
+		{
+			// the models are in parallel, so that each file is parsed in one thread
+			SetObjThread(1);
+			t0 = WallClock();
+			RunJobs(NumThread, NumName, IndexModel, &ij);
+			t1 = WallClock();
+			SetObjThread(0);
+
+			// time of each model, and the files of all models in the order of list.txt
+			fpt = fopen("feature_time.txt", "a");
+			fpt_art_q4 = fopen("all_q4_v1.8.art", "wb");
+			fpt_art_q8 = fopen("all_q8_v1.8.art", "wb");
+			fpt_cir_q8 = fopen("all_q8_v1.8.cir", "wb");
+			fpt_fd_q8 = fopen("all_q8_v1.8.fd", "wb");
+			fpt_ecc_q8 = fopen("all_q8_v1.8.ecc", "wb");
+			Count = Fail = 0;
+			for(j=0; j<NumName; j++)
+			{
+				if( ij.Done[j] == 0 )
+					continue;
+				fprintf(fpt, "%s ( V: %d T: %d )\t: %f sec;\n", ij.Name[j], ij.NumVer[j], ij.NumTri[j], ij.Time[j]);
+				if( ij.Done[j] < 0 )
+				{
+					Fail ++;
+					continue;
+				}
+				AppendFeature(fpt_art_q8, ij.Name[j], "_q8_v1.8.art", ANGLE * CAMNUM * ART_COEF);
+				AppendFeature(fpt_art_q4, ij.Name[j], "_q4_v1.8.art", ANGLE * CAMNUM * ART_COEF_2);
+				AppendFeature(fpt_cir_q8, ij.Name[j], "_q8_v1.8.cir", ANGLE * CAMNUM);
+				AppendFeature(fpt_ecc_q8, ij.Name[j], "_q8_v1.8.ecc", ANGLE * CAMNUM);
+				AppendFeature(fpt_fd_q8, ij.Name[j], "_q8_v1.8.fd", ANGLE * CAMNUM * FD_COEFF_NO);
+				Count ++;
+			}
+			fclose(fpt);
+			fclose(fpt_art_q8);
+			fclose(fpt_art_q4);
+			fclose(fpt_cir_q8);
+			fclose(fpt_ecc_q8);
+			fclose(fpt_fd_q8);
+			printf("%d models by %d workers: %f sec", Count, NumThread, t1 - t0);
+			if( Fail > 0 )
+				printf(", %d models can't be written", Fail);
+			printf("\n");
+		}
+		else
+			printf("Camera set 12_*.obj does not exist, or the renderer of a worker can't be created.\n");
+
+		for(j=0; j<i; j++)
+		{
+			if( j > 0 )
+				FreeRenderBackend(ij.Context[j]->Backend);
+			FreeLfdContext(ij.Context[j]);
+		}
+		Backend->DrawMesh(Backend, NULL);		// the mesh is freed
+		for(j=0; j<NumName; j++)
+			free(ij.Name[j]);
+		free(ij.Name);
+		free(ij.Done);
+		free(ij.NumVer);
+		free(ij.NumTri);
+		free(ij.Time);
 		break;
 
 // *************************************************************************************************
@@ -793,7 +926,7 @@ void keyboard (unsigned char key, int x, int y)
 
 			fname[strlen(fname)-1] = 0x00;
 			// get the translatation and scale of the two model
-			if( ReadObj(fname, &vertex1, &triangle1, &NumVer1, &NumTri1) == 0 )
+			if( ReadObjMesh(fname, &Mesh1) == 0 )
 				continue;
 
 			// ****************************************************************
@@ -801,14 +934,16 @@ void keyboard (unsigned char key, int x, int y)
 			// ****************************************************************
 
 			// Translate and scale model 1
-			TranslateScale(vertex1, NumVer1, triangle1, NumTri1, fname, &Translate1, &Scale1);
+			TranslateScaleMesh(Mesh1, &Translate1, &Scale1);
+			// upload once for all views
+			UploadMesh(Backend, Mesh1);
 
 			// read RED only, so size is winw*winh
 			for(srcCam=0; srcCam<ANGLE; srcCam++)
 			{
 				// capture CAMNUM silhouette of srcfn to memory
 				for(i=0; i<CAMNUM; i++)
-					RenderToMem(srcBuff[i], ColorBuff[i], CamVertex[srcCam]+i, vertex1, triangle1, NumVer1, NumTri1);
+					RenderViewMesh(Backend, srcBuff[i], ColorBuff[i], CamVertex[srcCam]+i, Mesh1);
 
 				// from silhouette
 //				for(i=0; i<CAMNUM; i++)
@@ -845,14 +980,14 @@ void keyboard (unsigned char key, int x, int y)
 			}
 
 			// free memory of 3D model
-			free(vertex1);
-			free(triangle1);
+			UnloadMesh(Backend);
 
 			// record execute time --- end
 			finish = clock();
 			fpt = fopen("feature_time.txt", "a");
-			fprintf(fpt, "%s ( V: %d T: %d )\t: %f sec;\n", fname, NumVer1, NumTri1, (double)(finish - start) / CLOCKS_PER_SEC );
+			fprintf(fpt, "%s ( V: %d T: %d )\t: %f sec;\n", fname, Mesh1->NumVer, Mesh1->NumTri, (double)(finish - start) / CLOCKS_PER_SEC );
 			fclose(fpt);
+			FreeMesh(Mesh1);
 
 			// save feature to file
 /*			sprintf(filename, "%s.art", fname);
@@ -945,7 +1080,7 @@ void keyboard (unsigned char key, int x, int y)
 			free(CamVertex[destCam]);
 			free(CamTriangle[destCam]);
 		}
-		NumTri = 0;
+		Backend->DrawMesh(Backend, NULL);		// the mesh is freed
 		break;
 
 // *************************************************************************************************
@@ -981,7 +1116,7 @@ void keyboard (unsigned char key, int x, int y)
 				// capture CAMNUM silhouette of srcfn to memory
 				for(i=0; i<CAMNUM; i++)
 				{
-					RenderToMem(srcBuff[i], NULL, CamVertex[srcCam]+i, vertex1, triangle1, NumVer1, NumTri1);
+					RenderView(Backend, srcBuff[i], NULL, CamVertex[srcCam]+i, vertex1, triangle1, NumVer1, NumTri1);
 					FourierDescriptor(src_FdCoeff[srcCam][i], srcBuff[i], winw, winh);
 				}
 			}
@@ -1490,46 +1625,414 @@ void keyboard (unsigned char key, int x, int y)
 		free(pTop);
 		break;
 
+// *************************************************************************************************
+	// scaling benchmark of the tile-binned software rasterizer, 1 ~ (number of processors) threads
+	// render all views of each model in list.txt, and check the result is the same with single thread
+	case 't':
+		for(destCam=0; destCam<ANGLE; destCam++)
+		{
+			sprintf(filename, "12_%d", destCam);
+			ReadObj(filename, CamVertex+destCam, CamTriangle+destCam, CamNumVer+destCam, CamNumTri+destCam);
+		}
+
+		BenchRaster = CreateRaster();
+		RefBuff = (unsigned char *) malloc (ANGLE * CAMNUM * WIDTH * HEIGHT * sizeof(unsigned char));
+		ThreadBuff = (unsigned char *) malloc (WIDTH * HEIGHT * sizeof(unsigned char));
+		RefMask = (unsigned __int64 *) malloc (ANGLE * CAMNUM * HEIGHT * MASK_WORDS * sizeof(unsigned __int64));
+		ThreadMask = (unsigned __int64 *) malloc (HEIGHT * MASK_WORDS * sizeof(unsigned __int64));
+		MaxThread = GetCpuNum();
+
+		fpt1 = fopen("list.txt", "r");
+		fpt = fopen("thread_time.txt", "a");
+		while( fgets(fname, 400, fpt1) )
+		{
+			fname[strlen(fname)-1] = 0x00;
+			if( ReadObjMesh(fname, &Mesh1) == 0 )
+				continue;
+			TranslateScaleMesh(Mesh1, &Translate1, &Scale1);
+
+			DepthTime1 = MaskTime1 = 0;
+			for(NumThread=1; NumThread<=MaxThread; NumThread++)
+			{
+				SetRasterThread(BenchRaster, NumThread);
+				Same = 1;
+
+				t0 = WallClock();
+				for(srcCam=0; srcCam<ANGLE; srcCam++)
+					for(i=0; i<CAMNUM; i++)
+					{
+						k = srcCam * CAMNUM + i;
+						if( NumThread == 1 )
+							RasterizeMeshToMem(BenchRaster, RefBuff + k * WIDTH * HEIGHT, NULL, CamVertex[srcCam]+i, Mesh1);
+						else
+						{
+							RasterizeMeshToMem(BenchRaster, ThreadBuff, NULL, CamVertex[srcCam]+i, Mesh1);
+							if( memcmp(ThreadBuff, RefBuff + k * WIDTH * HEIGHT, WIDTH * HEIGHT * sizeof(unsigned char)) )
+								Same = 0;
+						}
+					}
+
+				t1 = WallClock();
+				for(srcCam=0; srcCam<ANGLE; srcCam++)
+					for(i=0; i<CAMNUM; i++)
+					{
+						k = srcCam * CAMNUM + i;
+						if( NumThread == 1 )
+							RasterizeMeshMask(BenchRaster, RefMask + k * HEIGHT * MASK_WORDS, CamVertex[srcCam]+i, Mesh1);
+						else
+						{
+							RasterizeMeshMask(BenchRaster, ThreadMask, CamVertex[srcCam]+i, Mesh1);
+							if( memcmp(ThreadMask, RefMask + k * HEIGHT * MASK_WORDS, HEIGHT * MASK_WORDS * sizeof(unsigned __int64)) )
+								Same = 0;
+						}
+					}
+				t2 = WallClock();
+
+				// speedup is relative to single thread
+				if( NumThread == 1 )
+				{
+					DepthTime1 = t1 - t0;
+					MaskTime1 = t2 - t1;
+				}
+				printf("%s ( V: %d T: %d ) threads %d\t: depth %f sec ( x%.2f ), mask %f sec ( x%.2f ) %s\n", fname, Mesh1->NumVer, Mesh1->NumTri, NumThread, 
+						t1 - t0, DepthTime1 / (t1 - t0), t2 - t1, MaskTime1 / (t2 - t1), Same ? "" : "DIFFERENT");
+				fprintf(fpt, "%s ( V: %d T: %d ) threads %d\t: depth %f sec ( x%.2f ), mask %f sec ( x%.2f ) %s\n", fname, Mesh1->NumVer, Mesh1->NumTri, NumThread, 
+						t1 - t0, DepthTime1 / (t1 - t0), t2 - t1, MaskTime1 / (t2 - t1), Same ? "" : "DIFFERENT");
+			}
+
+			FreeMesh(Mesh1);
+		}
+		fclose(fpt1);
+		fclose(fpt);
+
+		free(RefBuff);
+		free(ThreadBuff);
+		free(RefMask);
+		free(ThreadMask);
+		FreeRaster(BenchRaster);
+		for(destCam=0; destCam<ANGLE; destCam++)
+		{
+			free(CamVertex[destCam]);
+			free(CamTriangle[destCam]);
+		}
+		break;
+
+// *************************************************************************************************
+	// benchmark of the render backend, compare with the software rasterizer
+	// render all views of each model in list.txt, and count the pixels of different silhouette
+	case 'b':
+		for(destCam=0; destCam<ANGLE; destCam++)
+		{
+			sprintf(filename, "12_%d", destCam);
+			ReadObj(filename, CamVertex+destCam, CamTriangle+destCam, CamNumVer+destCam, CamNumTri+destCam);
+		}
+
+		RefBackend = CreateRenderBackend(RENDER_SOFT);
+		RefBuff = (unsigned char *) malloc (WIDTH * HEIGHT * sizeof(unsigned char));
+		ThreadBuff = (unsigned char *) malloc (WIDTH * HEIGHT * sizeof(unsigned char));
+
+		fpt1 = fopen("list.txt", "r");
+		fpt = fopen("backend_time.txt", "a");
+		while( fgets(fname, 400, fpt1) )
+		{
+			fname[strlen(fname)-1] = 0x00;
+			if( ReadObjMesh(fname, &Mesh1) == 0 )
+				continue;
+			TranslateScaleMesh(Mesh1, &Translate1, &Scale1);
+			// upload once for all views
+			UploadMesh(Backend, Mesh1);
+			UploadMesh(RefBackend, Mesh1);
+
+			DepthTime1 = MaskTime1 = 0;
+			DiffPixel = 0;
+			for(srcCam=0; srcCam<ANGLE; srcCam++)
+				for(i=0; i<CAMNUM; i++)
+				{
+					t0 = WallClock();
+					RenderViewMesh(Backend, ThreadBuff, NULL, CamVertex[srcCam]+i, Mesh1);
+					t1 = WallClock();
+					RenderViewMesh(RefBackend, RefBuff, NULL, CamVertex[srcCam]+i, Mesh1);
+					t2 = WallClock();
+					DepthTime1 += t1 - t0;
+					MaskTime1 += t2 - t1;
+					for(k=0; k<WIDTH * HEIGHT; k++)
+						if( (ThreadBuff[k] < 255) != (RefBuff[k] < 255) )
+							DiffPixel ++;
+				}
+
+			printf("%s ( V: %d T: %d ) backend %d\t: %f sec, software %f sec, %d pixels different\n", fname, Mesh1->NumVer, Mesh1->NumTri, RenderType,
+					DepthTime1, MaskTime1, DiffPixel);
+			fprintf(fpt, "%s ( V: %d T: %d ) backend %d\t: %f sec, software %f sec, %d pixels different\n", fname, Mesh1->NumVer, Mesh1->NumTri, RenderType,
+					DepthTime1, MaskTime1, DiffPixel);
+
+			UnloadMesh(Backend);
+			UnloadMesh(RefBackend);
+			FreeMesh(Mesh1);
+		}
+		Backend->DrawMesh(Backend, NULL);		// the mesh is freed
+		fclose(fpt1);
+		fclose(fpt);
+
+		free(RefBuff);
+		free(ThreadBuff);
+		FreeRenderBackend(RefBackend);
+		for(destCam=0; destCam<ANGLE; destCam++)
+		{
+			free(CamVertex[destCam]);
+			free(CamTriangle[destCam]);
+		}
+		break;
+
+// *************************************************************************************************
+	// fidelity of simplified model, compare the q8 ART and Fourier descriptor with the original model
+	// the budget is "-budget=N", or 1/2, 1/4, 1/8 and 1/16 of the triangles
+	case 's':
+		if( (Context = CreateLfdContext(Backend, "12_", UseMaskRender, FdResample)) == NULL )
+		{
+			printf("Camera set 12_*.obj does not exist.\n");
+			break;
+		}
+
+		fpt1 = fopen("list.txt", "r");
+		fpt = fopen("decimate.txt", "a");
+		while( fgets(fname, 400, fpt1) )
+		{
+			fname[strlen(fname)-1] = 0x00;
+			if( ReadObjMesh(fname, &Mesh1) == 0 )
+				continue;
+			TranslateScaleMesh(Mesh1, &Translate1, &Scale1);
+			t0 = WallClock();
+			ExtractShapeQ8(Context, Mesh1, q8_ArtCoeff, q8_FdCoeff);
+			DepthTime1 = WallClock() - t0;
+			printf("%s ( V: %d T: %d )\t: %f sec\n", fname, Mesh1->NumVer, Mesh1->NumTri, DepthTime1);
+			fprintf(fpt, "%s ( V: %d T: %d )\t: %f sec\n", fname, Mesh1->NumVer, Mesh1->NumTri, DepthTime1);
+
+			if( DecimateBudget > 0 )
+			{
+				Budget[0] = DecimateBudget;
+				NumBudget = 1;
+			}
+			else
+				for(NumBudget=0; NumBudget<4; NumBudget++)
+					Budget[NumBudget] = Mesh1->NumTri >> (NumBudget+1);
+
+			for(a=0; a<NumBudget; a++)
+			{
+				// the simplified model is translated and scaled by itself, as in 'n'
+				if( ReadObjMesh(fname, &Mesh2) == 0 )
+					break;
+				CleanMesh(Mesh2, WeldTolerance >= 0 ? WeldTolerance : WELD_TOLERANCE, 0, NULL);
+				t0 = WallClock();
+				DecimateMesh(Mesh2, Budget[a]);
+				t1 = WallClock();
+				TranslateScaleMesh(Mesh2, &Translate2, &Scale2);
+				ExtractShapeQ8(Context, Mesh2, dec_ArtCoeff, dec_FdCoeff);
+				t2 = WallClock();
+
+				ArtMean = FdMean = 0;
+				ArtMax = FdMax = 0;
+				for(i=0; i<ANGLE; i++)
+					for(j=0; j<CAMNUM; j++)
+					{
+						for(k=0; k<ART_COEF; k++)
+						{
+							itmp = abs(q8_ArtCoeff[i][j][k] - dec_ArtCoeff[i][j][k]);
+							ArtMean += itmp;
+							if( itmp > ArtMax )		ArtMax = itmp;
+						}
+						for(k=0; k<FD_COEFF_NO; k++)
+						{
+							itmp = abs(q8_FdCoeff[i][j][k] - dec_FdCoeff[i][j][k]);
+							FdMean += itmp;
+							if( itmp > FdMax )		FdMax = itmp;
+						}
+					}
+				ArtMean /= ANGLE * CAMNUM * ART_COEF;
+				FdMean /= ANGLE * CAMNUM * FD_COEFF_NO;
+
+				printf("\tbudget %d ( V: %d T: %d )\t: decimate %f sec, feature %f sec; ART diff mean %f max %d; FD diff mean %f max %d\n", 
+						Budget[a], Mesh2->NumVer, Mesh2->NumTri, t1 - t0, t2 - t1, ArtMean, ArtMax, FdMean, FdMax);
+				fprintf(fpt, "\tbudget %d ( V: %d T: %d )\t: decimate %f sec, feature %f sec; ART diff mean %f max %d; FD diff mean %f max %d\n", 
+						Budget[a], Mesh2->NumVer, Mesh2->NumTri, t1 - t0, t2 - t1, ArtMean, ArtMax, FdMean, FdMax);
+
+				FreeMesh(Mesh2);
+			}
+
+			FreeMesh(Mesh1);
+		}
+		Backend->DrawMesh(Backend, NULL);		// the mesh is freed
+		fclose(fpt1);
+		fclose(fpt);
+		FreeLfdContext(Context);
+		break;
+
+// *************************************************************************************************
+	// check of simplification, a 50x50 grid (5000 triangles) is simplified to 2500 and 1000 triangles,
+	// as a welded mesh, as a triangle soup (not simplified), and as a soup welded by CleanMesh() first
+	// the silhouette area should be kept, a welded mesh should be simplified to the budget
+	case 'v':
+		BenchRaster = CreateRaster();
+		RefMask = (unsigned __int64 *) malloc (HEIGHT * MASK_WORDS * sizeof(unsigned __int64));
+		Budget[0] = 2500;
+		Budget[1] = 1000;
+		Fail = 0;
+		for(a=0; a<3; a++)
+			for(k=0; k<2; k++)
+			{
+				Mesh1 = GridMesh(50, a > 0);
+				if( a == 2 )
+					CleanMesh(Mesh1, WELD_TOLERANCE, 0, NULL);
+				Area0 = SilhouetteArea(BenchRaster, RefMask, Mesh1);
+				i = Mesh1->NumTri;
+				DecimateMesh(Mesh1, Budget[k]);
+				Area1 = SilhouetteArea(BenchRaster, RefMask, Mesh1);
+				Same = Area1 >= 0.99 * Area0 && ( a == 1 ? Mesh1->NumTri == i : Mesh1->NumTri <= Budget[k] );
+				if( !Same )
+					Fail ++;
+				printf("%s budget %d ( T: %d -> %d )\t: area %d -> %d %s\n", a == 0 ? "grid" : ( a == 1 ? "soup" : "welded soup" ), 
+						Budget[k], i, Mesh1->NumTri, Area0, Area1, Same ? "" : "FAILED");
+				FreeMesh(Mesh1);
+			}
+		printf("%s\n", Fail ? "FAILED" : "passed");
+
+		free(RefMask);
+		FreeRaster(BenchRaster);
+		break;
+
+// *************************************************************************************************
+	// latency of a query, the views of a model are rendered by a pool of workers ( "-threads=N" )
+	// compare with the features of one worker for each model in list.txt
+	// ("-soft" only, the other backends have one context and use one worker)
+	case 'q':
+		NumThread = ( NumIndexThread > 0 ) ? NumIndexThread : GetCpuNum();
+		if( NumThread > MAX_THREAD )		NumThread = MAX_THREAD;
+		if( RenderType != RENDER_SOFT )		NumThread = 1;
+		for(i=0; i<NumThread; i++)
+		{
+			if( (WorkBackend = ( i == 0 ) ? Backend : CreateRenderBackend(RENDER_SOFT)) == NULL )
+				break;
+			if( (ViewContext[i] = CreateLfdContext(WorkBackend, "12_", UseMaskRender, FdResample)) == NULL )
+			{
+				if( i > 0 )
+					FreeRenderBackend(WorkBackend);
+				break;
+			}
+			ViewContext[i]->CirContour = CirContour;
+		}
+
+		if( i == NumThread )
+		{
+			fpt1 = fopen("list.txt", "r");
+			fpt = fopen("query_time.txt", "a");
+			while( fgets(fname, 400, fpt1) )
+			{
+				fname[strlen(fname)-1] = 0x00;
+				if( ReadObjMesh(fname, &Mesh1) == 0 )
+					continue;
+				TranslateScaleMesh(Mesh1, &Translate1, &Scale1);
+
+				t0 = WallClock();
+				ExtractShape(ViewContext[0], Mesh1, src_ArtCoeff, src_FdCoeff, cir_Coeff, ecc_Coeff);
+				t1 = WallClock();
+				ExtractShapeViews(ViewContext, NumThread, Mesh1, dest_ArtCoeff, dest_FdCoeff, view_cirCoeff, view_eccCoeff);
+				t2 = WallClock();
+
+				Same = memcmp(src_ArtCoeff, dest_ArtCoeff, ANGLE * sizeof(*src_ArtCoeff)) == 0 && memcmp(src_FdCoeff, dest_FdCoeff, ANGLE * sizeof(*src_FdCoeff)) == 0
+					&& memcmp(cir_Coeff, view_cirCoeff, sizeof(cir_Coeff)) == 0 && memcmp(ecc_Coeff, view_eccCoeff, sizeof(ecc_Coeff)) == 0;
+				printf("%s ( V: %d T: %d ) workers %d\t: one %f sec, all %f sec ( x%.2f ) %s\n", fname, Mesh1->NumVer, Mesh1->NumTri, NumThread, 
+						t1 - t0, t2 - t1, (t1 - t0) / (t2 - t1), Same ? "" : "DIFFERENT");
+				fprintf(fpt, "%s ( V: %d T: %d ) workers %d\t: one %f sec, all %f sec ( x%.2f ) %s\n", fname, Mesh1->NumVer, Mesh1->NumTri, NumThread, 
+						t1 - t0, t2 - t1, (t1 - t0) / (t2 - t1), Same ? "" : "DIFFERENT");
+
+				FreeMesh(Mesh1);
+			}
+			Backend->DrawMesh(Backend, NULL);		// the mesh is freed
+			fclose(fpt1);
+			fclose(fpt);
+		}
+		else
+			printf("Camera set 12_*.obj does not exist, or the renderer of a worker can't be created.\n");
+
+		for(j=0; j<i; j++)
+		{
+			if( j > 0 )
+				FreeRenderBackend(ViewContext[j]->Backend);
+			FreeLfdContext(ViewContext[j]);
+		}
+		break;
+
 	default:
 		break;
 	}
 }
 
-void init(void) 
+int main(int argc, char** argv)
 {
-	glClearColor (1.0, 1.0, 1.0, 0.0);
-	glClearDepth(1.0);
-	glEnable(GL_DEPTH_TEST);
-//	glShadeModel(GL_FLAT);
-}
+	int		i;
+
+	// "-soft" renders by the software rasterizer, "-fbo" renders by offscreen OpenGL,
+	// and the other arguments are run as keys without window
+	// e.g. "3DAlignment -soft n" calculates features of all models in list.txt
+	// "-mask" extracts features from packed silhouette
+	// "-mt" renders by all processors with "-soft"
+	// "t" is the scaling benchmark of multi-thread rendering, e.g. "3DAlignment -soft t"
+	// "b" is the benchmark of the backend against the software rasterizer, e.g. "3DAlignment -fbo b"
+	// "-budget=N" simplifies each model to N triangles before rendering, the model is welded first as "-weld" (unless "-weld=T")
+	// "s" compares features of simplified models with the original, e.g. "3DAlignment -soft s"
+	// "v" checks that the silhouette area of a simplified grid (welded, and as a triangle soup) is kept
+	// "-fdresample" resamples the contour to FD_SAMPLE points for Fourier descriptor (not comparable with the default)
+	// "-circontour" ("-circontour=moves") gets circularity from the contour of Fourier descriptor (not comparable with the default)
+	// "i" is the same with "n" by a pool of workers, e.g. "3DAlignment -soft -threads=8 i" ("-threads" is all processors by default)
+	// "q" is the latency of a query, the views of each model are rendered by a pool of workers, e.g. "3DAlignment -soft -threads=8 q"
+	// "-cache=DIR" keeps the normalized models of "n" and "i" in DIR, and loads them instead of the .obj files next time
+	// "-weld" ("-weld=T") welds the vertices of "n" and "i" within 1e-6 (T) of the size of the model, and removes degenerate and duplicate triangles
+	for(i=1; i<argc; i++)
+		if( strcmp(argv[i], "-soft") == 0 )
+			RenderType = RENDER_SOFT;
+		else if( strcmp(argv[i], "-fbo") == 0 )
+			RenderType = RENDER_FBO;
+		else if( strcmp(argv[i], "-mask") == 0 )
+			UseMaskRender = 1;
+		else if( strcmp(argv[i], "-mt") == 0 )
+			UseMultiThread = 1;
+		else if( strncmp(argv[i], "-budget=", 8) == 0 )
+			DecimateBudget = atoi(argv[i]+8);
+		else if( strcmp(argv[i], "-fdresample") == 0 )
+			FdResample = 1;
+		else if( strcmp(argv[i], "-circontour") == 0 )
+			CirContour = 2;
+		else if( strcmp(argv[i], "-circontour=moves") == 0 )
+			CirContour = 1;
+		else if( strncmp(argv[i], "-threads=", 9) == 0 )
+			NumIndexThread = atoi(argv[i]+9);
+		else if( strncmp(argv[i], "-cache=", 7) == 0 )
+			MeshCacheDir = argv[i]+7;
+		else if( strcmp(argv[i], "-weld") == 0 )
+			WeldTolerance = WELD_TOLERANCE;
+		else if( strncmp(argv[i], "-weld=", 6) == 0 )
+			WeldTolerance = atof(argv[i]+6);
+	// the models are welded before simplification, otherwise the separate faces lose their triangles
+	if( DecimateBudget > 0 && WeldTolerance < 0 )
+		WeldTolerance = WELD_TOLERANCE;
+
+	if( (Backend = CreateRenderBackend(RenderType)) == NULL )
+	{
+		printf("Render backend %d can't be created.\n", RenderType);
+		return -1;
+	}
+	if( RenderType == RENDER_SOFT && UseMultiThread )
+		SetRasterThread(Backend->ras, GetCpuNum());
 
-void reshape (int w, int h)
-{
-	glMatrixMode (GL_PROJECTION);
-	glLoadIdentity ();
-//	gluPerspective(90.0, (GLfloat) winw/(GLfloat) winh, 0.1, 10.0);
-	glOrtho(-1, 1, -1, 1, 0.0, 2.0);
-//	glOrtho(-1, 1, -1, 1, 0.5, 1.5);
-	glViewport (0, 0, (GLsizei) winw, (GLsizei) winh); 
-
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-	gluLookAt(1,0,0,0,0,0,0,1,0);
-//	gluLookAt(CAMSCALE*-0.85065, CAMSCALE*0.61803, CAMSCALE*-0.20081, 0,0,0,0,1,0);
-//	gluLookAt(-0.85065, 0.61803, -0.20081, 0,0,0,0,1,0);
-}
+	if( RenderType != RENDER_GLUT )
+	{
+		for(i=1; i<argc; i++)
+			if( argv[i][0] != '-' )
+				keyboard(argv[i][0], 0, 0);
+		FreeRenderBackend(Backend);
+		return 0;
+	}
 
-int main(int argc, char** argv)
-{
-	// Init of the GL Window
-	glutInit(&argc, argv);
-	glutInitDisplayMode (GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH);
-	glutInitWindowSize (WIDTH, HEIGHT); 
-	glutInitWindowPosition (100, 100);
-	glutCreateWindow (argv[0]);
-	init ();
-	glutDisplayFunc(display); 
-	glutReshapeFunc(reshape);
+	// GL Window is created by the backend
 	// glutMouseFunc(mouse);
 	// glutMotionFunc(motion);
 	glutKeyboardFunc(keyboard);
@@ -1538,4 +2041,3 @@ int main(int argc, char** argv)
 
 	return 0;
 }
-
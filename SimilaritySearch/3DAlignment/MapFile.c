@@ -0,0 +1,101 @@
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <stdio.h>
+
+#include "ds.h"
+
+LFD_API void UnmapFile(pMappedFile mf)
+{
+#ifdef _WIN32
+	if( mf->data )
+		UnmapViewOfFile(mf->data);
+	if( mf->map )
+		CloseHandle((HANDLE)mf->map);
+	if( mf->file )
+		CloseHandle((HANDLE)mf->file);
+#else
+	if( mf->data )
+		munmap((void *)mf->data, (size_t)mf->size);
+#endif
+	mf->data = NULL;
+	mf->size = 0;
+	mf->file = mf->map = NULL;
+}
+
+// map the whole file to memory (read only), so that it's parsed in place without reading into a buffer,
+// and pages are read by the system when touched, return 0 if the file can't be opened or mapped
+LFD_API int MapFile(char *filename, pMappedFile mf)
+{
+#ifdef _WIN32
+	HANDLE			file, map;
+	LARGE_INTEGER	size;
+#else
+	int				fd;
+	struct stat		st;
+	void			*p;
+#endif
+
+	mf->data = NULL;
+	mf->size = 0;
+	mf->file = mf->map = NULL;
+
+#ifdef _WIN32
+	file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if( file == INVALID_HANDLE_VALUE )
+		return 0;
+	if( !GetFileSizeEx(file, &size) )
+	{
+		CloseHandle(file);
+		return 0;
+	}
+	mf->size = size.QuadPart;
+	mf->file = file;
+	// a mapping of an empty file can't be created
+	if( mf->size == 0 )
+		return 1;
+
+	map = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if( map == NULL )
+	{
+		UnmapFile(mf);
+		return 0;
+	}
+	mf->map = map;
+	mf->data = (const char *) MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+	if( mf->data == NULL )
+	{
+		UnmapFile(mf);
+		return 0;
+	}
+#else
+	if( (fd = open(filename, O_RDONLY)) < 0 )
+		return 0;
+	if( fstat(fd, &st) != 0 )
+	{
+		close(fd);
+		return 0;
+	}
+	mf->size = st.st_size;
+	if( mf->size > 0 )
+	{
+		p = mmap(NULL, (size_t)mf->size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if( p == MAP_FAILED )
+		{
+			close(fd);
+			return 0;
+		}
+		mf->data = (const char *)p;
+	}
+	// the mapping is kept after closing the file
+	close(fd);
+#endif
+
+	return 1;
+}
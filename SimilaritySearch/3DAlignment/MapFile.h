@@ -0,0 +1,2 @@
+LFD_API int MapFile(char *filename, pMappedFile mf);
+LFD_API void UnmapFile(pMappedFile mf);
@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <malloc.h>
+#include <memory.h>
+#include <float.h>
+
+#include "ds.h"
+
+// a mesh of NumVer vertices and NumTri triangles, all of them are material 0 (black)
+LFD_API pMesh CreateMesh(int NumVer, int NumTri)
+{
+	pMesh		m;
+
+	m = (pMesh) malloc (sizeof(Mesh));
+	m->NumVer = NumVer;
+	m->NumTri = NumTri;
+	// malloc(0) may return NULL, so that at least one element
+	m->x = (float *) malloc ((NumVer ? NumVer : 1) * sizeof(float));
+	m->y = (float *) malloc ((NumVer ? NumVer : 1) * sizeof(float));
+	m->z = (float *) malloc ((NumVer ? NumVer : 1) * sizeof(float));
+	m->index = (unsigned int *) malloc ((NumTri ? 3 * NumTri : 3) * sizeof(unsigned int));
+	m->Material = NULL;
+	m->Color = (double *) malloc (3 * sizeof(double));
+	m->Color[0] = m->Color[1] = m->Color[2] = 0;
+	m->NumMaterial = 1;
+
+	return m;
+}
+
+LFD_API void FreeMesh(pMesh m)
+{
+	if( m == NULL )
+		return;
+
+	free(m->x);
+	free(m->y);
+	free(m->z);
+	free(m->index);
+	if( m->Material )
+		free(m->Material);
+	free(m->Color);
+	free(m);
+}
+
+// add a material, return its index
+LFD_API int AddMaterial(pMesh m, double r, double g, double b)
+{
+	m->Color = (double *) realloc (m->Color, 3 * (m->NumMaterial + 1) * sizeof(double));
+	m->Color[3*m->NumMaterial] = r;
+	m->Color[3*m->NumMaterial+1] = g;
+	m->Color[3*m->NumMaterial+2] = b;
+	return m->NumMaterial ++;
+}
+
+// free the material of each triangle if all of them are 0
+LFD_API void TrimMaterial(pMesh m)
+{
+	int			i;
+
+	if( m->Material == NULL )
+		return;
+	for(i=0; i<m->NumTri && m->Material[i]==0; i++)
+		;
+	if( i == m->NumTri )
+	{
+		free(m->Material);
+		m->Material = NULL;
+	}
+}
+
+// convert the polygons of ReadObj(), each polygon is triangulated as a fan (the same with GL_POLYGON),
+// and polygons of less than 3 vertices are removed
+// the color of a polygon is a new material unless it is black or the same with the last one,
+// so that continuous polygons of a color are a material, and the conversion is O(nt)
+LFD_API pMesh MeshFromPolygons(pVer v, pTri t, int nv, int nt)
+{
+	pMesh		m;
+	int			i, j, f, n, mat, last;
+
+	n = 0;
+	for(i=0; i<nt; i++)
+		if( t[i].NodeName > 2 )
+			n += t[i].NodeName - 2;
+
+	m = CreateMesh(nv, n);
+	for(i=0; i<nv; i++)
+	{
+		m->x[i] = (float)v[i].coor[0];
+		m->y[i] = (float)v[i].coor[1];
+		m->z[i] = (float)v[i].coor[2];
+	}
+
+	m->Material = (int *) malloc ((n ? n : 1) * sizeof(int));
+	last = 0;
+	for(i=0, f=0; i<nt; i++)
+	{
+		if( t[i].NodeName < 3 )
+			continue;
+		if( t[i].r == 0 && t[i].g == 0 && t[i].b == 0 )
+			mat = 0;
+		else if( t[i].r == m->Color[3*last] && t[i].g == m->Color[3*last+1] && t[i].b == m->Color[3*last+2] )
+			mat = last;
+		else
+			mat = AddMaterial(m, t[i].r, t[i].g, t[i].b);
+		last = mat;
+
+		for(j=1; j<t[i].NodeName-1; j++, f++)
+		{
+			m->index[3*f] = t[i].v[0];
+			m->index[3*f+1] = t[i].v[j];
+			m->index[3*f+2] = t[i].v[j+1];
+			m->Material[f] = mat;
+		}
+	}
+	TrimMaterial(m);
+
+	return m;
+}
+
+// convert to polygons for the legacy functions, each triangle is a polygon of 3 vertices
+LFD_API void MeshToPolygons(pMesh m, pVer *vertex, pTri *triangle, int *NumVer, int *NumTri)
+{
+	int			i, k;
+	double		*c;
+
+	*NumVer = m->NumVer;
+	*NumTri = m->NumTri;
+	*vertex = (pVer) malloc ((m->NumVer ? m->NumVer : 1) * sizeof(Ver));
+	*triangle = (pTri) malloc ((m->NumTri ? m->NumTri : 1) * sizeof(Tri));
+	memset(*triangle, 0, (m->NumTri ? m->NumTri : 1) * sizeof(Tri));
+
+	for(i=0; i<m->NumVer; i++)
+	{
+		(*vertex)[i].coor[0] = m->x[i];
+		(*vertex)[i].coor[1] = m->y[i];
+		(*vertex)[i].coor[2] = m->z[i];
+	}
+
+	for(i=0; i<m->NumTri; i++)
+	{
+		for(k=0; k<3; k++)
+			(*triangle)[i].v[k] = m->index[3*i+k];
+		(*triangle)[i].NodeName = 3;
+		c = m->Color + 3 * (m->Material ? m->Material[i] : 0);
+		(*triangle)[i].r = c[0];
+		(*triangle)[i].g = c[1];
+		(*triangle)[i].b = c[2];
+	}
+}
+
+static double max3(double a, double b, double c)
+{
+	double d = (a>b)?a:b;
+	return (c>d)?c:d;
+}
+
+// the same with TranslateScale(), move the center of bounding box (of the vertices used by triangles) to the origin,
+// and scale the longest side to 1, computed in double and then stored in float
+LFD_API void TranslateScaleMesh(pMesh m, pVer T, double *S)
+{
+	double		MinCoor[3], MaxCoor[3], Translate[3], p[3];
+	double		scale;
+	int			i, k;
+	unsigned int	vi;
+
+	for(k=0; k<3; k++)
+	{
+		MinCoor[k] = DBL_MAX;
+		MaxCoor[k] = -DBL_MAX;
+	}
+	for(i=0; i<3*m->NumTri; i++)
+	{
+		vi = m->index[i];
+		p[0] = m->x[vi];
+		p[1] = m->y[vi];
+		p[2] = m->z[vi];
+		for(k=0; k<3; k++)
+		{
+			if( p[k] < MinCoor[k] )
+				MinCoor[k] = p[k];
+			if( p[k] > MaxCoor[k] )
+				MaxCoor[k] = p[k];
+		}
+	}
+
+	for(k=0; k<3; k++)
+		Translate[k] = -( MinCoor[k] + MaxCoor[k] ) / 2;
+	scale = 1.0 / max3(MaxCoor[0]-MinCoor[0], MaxCoor[1]-MinCoor[1], MaxCoor[2]-MinCoor[2]);
+
+	for(i=0; i<m->NumVer; i++)
+	{
+		m->x[i] = (float)( (m->x[i] + Translate[0]) * scale );
+		m->y[i] = (float)( (m->y[i] + Translate[1]) * scale );
+		m->z[i] = (float)( (m->z[i] + Translate[2]) * scale );
+	}
+
+	for(k=0; k<3; k++)
+		T->coor[k] = Translate[k];
+	*S = scale;
+}
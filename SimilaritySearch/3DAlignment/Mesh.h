@@ -0,0 +1,7 @@
+LFD_API pMesh CreateMesh(int NumVer, int NumTri);
+LFD_API void FreeMesh(pMesh m);
+LFD_API int AddMaterial(pMesh m, double r, double g, double b);
+LFD_API void TrimMaterial(pMesh m);
+LFD_API pMesh MeshFromPolygons(pVer v, pTri t, int nv, int nt);
+LFD_API void MeshToPolygons(pMesh m, pVer *vertex, pTri *triangle, int *NumVer, int *NumTri);
+LFD_API void TranslateScaleMesh(pMesh m, pVer T, double *S);
@@ -0,0 +1,218 @@
+#ifdef _WIN32
+#include <windows.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include <memory.h>
+
+#include "ds.h"
+#include "Mesh.h"
+#include "MapFile.h"
+
+// cache of the normalized mesh of a model, so that indexing a model again doesn't read the source (.obj or 3D-PDF),
+// and doesn't simplify, triangulate and normalize it
+// a cache file is named by the hash of the full path of the source, and is valid only if the path, size and
+// modified time of the source, the budget of simplification and the tolerance of welding are the same with those when it was written
+// the file is the header, and then the arrays of the mesh in the native byte order:
+//		Color (double), x, y, z (float), index (unsigned int), Material (int, if any), full path of the source (char)
+// so that each array is aligned in the mapped file
+
+#define	MESH_CACHE_MAGIC		"LFDMESH"
+#define	MESH_CACHE_VERSION		3			// increase it if the format or the normalization is changed
+#define	MESH_CACHE_PATH			1024
+
+typedef struct MeshCacheHead_ {
+	char			Magic[8];
+	int				Version;
+	int				HeadSize;				// sizeof(MeshCacheHead), different if compiled differently
+	__int64			SrcSize, SrcTime;		// of the source when it was cached
+	int				Budget;					// the mesh is simplified to this number of triangles, 0 is not simplified
+	int				PathLen;				// length of the full path of the source
+	int				NumVer, NumTri, NumMaterial, HasMaterial;
+	double			Translate[3], Scale;	// of TranslateScaleMesh()
+	double			Weld;					// tolerance of CleanMesh(), negative is not cleaned
+}MeshCacheHead;
+
+// full path, size and modified time of the source, return 0 if it doesn't exist
+static int SourceStamp(char *SrcName, char *FullPath, __int64 *size, __int64 *time)
+{
+#ifdef _WIN32
+	struct __stat64	st;
+
+	if( _fullpath(FullPath, SrcName, MESH_CACHE_PATH) == NULL )
+		return 0;
+	if( _stat64(FullPath, &st) != 0 )
+		return 0;
+#else
+	struct stat		st;
+	char			*p;
+
+	if( (p = realpath(SrcName, NULL)) == NULL )
+		return 0;
+	if( strlen(p) >= MESH_CACHE_PATH )
+	{
+		free(p);
+		return 0;
+	}
+	strcpy(FullPath, p);
+	free(p);
+	if( stat(FullPath, &st) != 0 )
+		return 0;
+#endif
+	*size = (__int64)st.st_size;
+	*time = (__int64)st.st_mtime;
+	return 1;
+}
+
+// name of the cache file of a source in CacheDir, FNV-1a (64 bits) of its full path
+static void CacheName(char *CacheDir, char *FullPath, char *filename)
+{
+	unsigned __int64	h = 14695981039346656037ULL;
+	char				*p;
+
+	for(p=FullPath; *p; p++)
+	{
+		h ^= (unsigned char)*p;
+		h *= 1099511628211ULL;
+	}
+	sprintf(filename, "%s/%08x%08x.msh", CacheDir, (unsigned int)(h >> 32), (unsigned int)h);
+}
+
+// bytes of the arrays after the header
+static __int64 CacheBodySize(MeshCacheHead *head)
+{
+	return (__int64)3 * head->NumMaterial * sizeof(double)
+		 + (__int64)3 * head->NumVer * sizeof(float)
+		 + (__int64)3 * head->NumTri * sizeof(unsigned int)
+		 + (head->HasMaterial ? (__int64)head->NumTri * sizeof(int) : 0)
+		 + head->PathLen;
+}
+
+// load the normalized mesh of SrcName (e.g. "model.obj") and its translate and scale from the cache in CacheDir,
+// return NULL if it isn't cached, or the cache is old
+LFD_API pMesh LoadMeshCache(char *CacheDir, char *SrcName, int Budget, double Weld, pVer Translate, double *Scale)
+{
+	char			FullPath[MESH_CACHE_PATH], filename[MESH_CACHE_PATH + 32];
+	__int64			SrcSize, SrcTime;
+	MappedFile		mf;
+	MeshCacheHead	head;
+	const char		*p;
+	pMesh			m;
+	int				k;
+
+	if( !SourceStamp(SrcName, FullPath, &SrcSize, &SrcTime) )
+		return NULL;
+	CacheName(CacheDir, FullPath, filename);
+	if( !MapFile(filename, &mf) )
+		return NULL;
+
+	if( mf.size < (__int64)sizeof(MeshCacheHead) )
+	{
+		UnmapFile(&mf);
+		return NULL;
+	}
+	memcpy(&head, mf.data, sizeof(MeshCacheHead));
+	if( memcmp(head.Magic, MESH_CACHE_MAGIC, sizeof(head.Magic)) != 0 || head.Version != MESH_CACHE_VERSION
+		|| head.HeadSize != sizeof(MeshCacheHead) || head.SrcSize != SrcSize || head.SrcTime != SrcTime
+		|| head.Budget != Budget || head.Weld != Weld || head.PathLen != (int)strlen(FullPath)
+		|| head.NumVer < 0 || head.NumTri < 0 || head.NumMaterial < 1
+		|| mf.size != (__int64)sizeof(MeshCacheHead) + CacheBodySize(&head)
+		|| memcmp(mf.data + mf.size - head.PathLen, FullPath, head.PathLen) != 0 )
+	{
+		UnmapFile(&mf);
+		return NULL;
+	}
+
+	m = CreateMesh(head.NumVer, head.NumTri);
+	p = mf.data + sizeof(MeshCacheHead);
+	m->Color = (double *) realloc (m->Color, 3 * head.NumMaterial * sizeof(double));
+	memcpy(m->Color, p, 3 * head.NumMaterial * sizeof(double));
+	m->NumMaterial = head.NumMaterial;
+	p += 3 * head.NumMaterial * sizeof(double);
+	memcpy(m->x, p, head.NumVer * sizeof(float));
+	p += head.NumVer * sizeof(float);
+	memcpy(m->y, p, head.NumVer * sizeof(float));
+	p += head.NumVer * sizeof(float);
+	memcpy(m->z, p, head.NumVer * sizeof(float));
+	p += head.NumVer * sizeof(float);
+	memcpy(m->index, p, 3 * head.NumTri * sizeof(unsigned int));
+	p += 3 * head.NumTri * sizeof(unsigned int);
+	if( head.HasMaterial )
+	{
+		m->Material = (int *) malloc ((head.NumTri ? head.NumTri : 1) * sizeof(int));
+		memcpy(m->Material, p, head.NumTri * sizeof(int));
+	}
+	UnmapFile(&mf);
+
+	for(k=0; k<3; k++)
+		Translate->coor[k] = head.Translate[k];
+	*Scale = head.Scale;
+	return m;
+}
+
+// write the normalized mesh of SrcName to the cache in CacheDir, the directory should exist
+// the file is written to a temporary file first, so that a partial file is never read, return 0 if failed
+LFD_API int SaveMeshCache(char *CacheDir, char *SrcName, int Budget, double Weld, pMesh m, pVer Translate, double Scale)
+{
+	char			FullPath[MESH_CACHE_PATH], filename[MESH_CACHE_PATH + 32], TempName[MESH_CACHE_PATH + 64];
+	MeshCacheHead	head;
+	FILE			*fpt;
+	int				k, ok;
+
+	memset(&head, 0, sizeof(MeshCacheHead));
+	if( !SourceStamp(SrcName, FullPath, &head.SrcSize, &head.SrcTime) )
+		return 0;
+	CacheName(CacheDir, FullPath, filename);
+
+	strcpy(head.Magic, MESH_CACHE_MAGIC);
+	head.Version = MESH_CACHE_VERSION;
+	head.HeadSize = sizeof(MeshCacheHead);
+	head.Budget = Budget;
+	head.Weld = Weld;
+	head.PathLen = (int)strlen(FullPath);
+	head.NumVer = m->NumVer;
+	head.NumTri = m->NumTri;
+	head.NumMaterial = m->NumMaterial;
+	head.HasMaterial = m->Material != NULL;
+	for(k=0; k<3; k++)
+		head.Translate[k] = Translate->coor[k];
+	head.Scale = Scale;
+
+	// unique in the processes and the threads indexing at the same time
+#ifdef _WIN32
+	sprintf(TempName, "%s.%lu.%p", filename, (unsigned long)GetCurrentProcessId(), (void *)m);
+#else
+	sprintf(TempName, "%s.%lu.%p", filename, (unsigned long)getpid(), (void *)m);
+#endif
+	if( (fpt = fopen(TempName, "wb")) == NULL )
+		return 0;
+	ok = fwrite(&head, sizeof(MeshCacheHead), 1, fpt) == 1
+	  && fwrite(m->Color, sizeof(double), 3 * m->NumMaterial, fpt) == (size_t)(3 * m->NumMaterial)
+	  && fwrite(m->x, sizeof(float), m->NumVer, fpt) == (size_t)m->NumVer
+	  && fwrite(m->y, sizeof(float), m->NumVer, fpt) == (size_t)m->NumVer
+	  && fwrite(m->z, sizeof(float), m->NumVer, fpt) == (size_t)m->NumVer
+	  && fwrite(m->index, sizeof(unsigned int), 3 * m->NumTri, fpt) == (size_t)(3 * m->NumTri)
+	  && ( !m->Material || fwrite(m->Material, sizeof(int), m->NumTri, fpt) == (size_t)m->NumTri )
+	  && fwrite(FullPath, sizeof(char), head.PathLen, fpt) == (size_t)head.PathLen;
+	if( fclose(fpt) != 0 )
+		ok = 0;
+
+#ifdef _WIN32
+	if( ok && !MoveFileExA(TempName, filename, MOVEFILE_REPLACE_EXISTING) )
+		ok = 0;
+#else
+	if( ok && rename(TempName, filename) != 0 )
+		ok = 0;
+#endif
+	if( !ok )
+		remove(TempName);
+	return ok;
+}
@@ -0,0 +1,2 @@
+LFD_API pMesh LoadMeshCache(char *CacheDir, char *SrcName, int Budget, double Weld, pVer Translate, double *Scale);
+LFD_API int SaveMeshCache(char *CacheDir, char *SrcName, int Budget, double Weld, pMesh m, pVer Translate, double Scale);
@@ -0,0 +1,557 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include <memory.h>
+
+#include "ds.h"
+#include "RWObj.h"
+#include "Mesh.h"
+#include "MapFile.h"
+#include "Thread.h"
+
+// OBJ parser of ReadObj() and ReadObjMesh()
+// the file is mapped to memory and split into chunks at line boundaries, each chunk is parsed by a thread twice:
+//		1. count vertices and faces, and find "mtllib" and the last "usemtl"
+//		2. after the first vertex and face of each chunk are known, parse the chunk into its part of the arrays
+// so that the result is the same with reading the file line by line, and a line can be of any length
+// a face of a vertex index out of range (0, or beyond the vertices of the file) is dropped with a warning
+
+#define	OBJ_CHUNK		(1<<22)		// bytes of a chunk, a chunk begins at the first line after this
+#define	POLYGON_MAX		15			// vertices of a polygon of ReadObj() (Tri.v), the others are dropped
+#define	DROPPED			0xffffffff	// the first index of a triangle (or NodeName of a polygon) of a dropped face
+
+typedef struct ObjChunk_ {
+	__int64			start, end;				// lines beginning in [start, end)
+	int				NumVer, NumFace, NumTri;
+	int				VerBase, FaceBase, TriBase;		// the first vertex, face and triangle of the chunk
+	__int64			*MtlLib;				// offset of the names of "mtllib", in the order of the file
+	int				NumMtlLib;
+	__int64			LastMtl;				// offset of the name of the last "usemtl", -1 if none
+	int				StartMtl;				// material at the beginning of the chunk
+	int				NumDropped;				// faces of an index out of range
+}ObjChunk;
+
+typedef struct ObjJob_ {
+	const char		*data;
+	__int64			size;
+	ObjChunk		*chunk;
+	// material i (1 ~ NumMtl) is Mtl[i-1], in the order of the list of ReadMeterial()
+	pMeterial		*Mtl;
+	int				NumMtl;
+	int				*Hash;					// material of each slot, 0 is empty
+	int				HashSize;				// power of 2
+	int				NumVer;					// of the file, a vertex index is in [0, NumVer)
+	// result, a mesh or polygons
+	pMesh			m;
+	pVer			v;
+	pTri			t;
+}ObjJob;
+
+// threads of parsing a file, 0 is the number of processors
+static int		ObjThread = 0;
+
+// the batch indexer reads many files concurrently, so that each one is parsed by one thread
+LFD_API void SetObjThread(int NumThread)
+{
+	ObjThread = NumThread;
+}
+
+// ************************************************************************************************
+// scanning of a line, never beyond "end" (the mapped file isn't terminated by 0)
+
+#define	IS_BLANK(c)		( (c) == ' ' || (c) == '\t' || (c) == '\r' || (c) == '\v' || (c) == '\f' )
+#define	IS_DIGIT(c)		( (c) >= '0' && (c) <= '9' )
+
+static const char *SkipBlank(const char *p, const char *end)
+{
+	while( p < end && IS_BLANK(*p) )
+		p ++;
+	return p;
+}
+
+static const char *SkipToken(const char *p, const char *end)
+{
+	while( p < end && !IS_BLANK(*p) && *p != '\n' )
+		p ++;
+	return p;
+}
+
+static const char *NextLine(const char *p, const char *end)
+{
+	p = (const char *) memchr(p, '\n', end - p);
+	return p ? p + 1 : end;
+}
+
+static int IsToken(const char *p, const char *q, const char *word)
+{
+	int		n = (int)strlen(word);
+
+	return q - p == n && memcmp(p, word, n) == 0;
+}
+
+// a number as strtod(), exact if it has at most 15 significant digits and an exponent in [-22, 22]
+// (the digits and the power of 10 are exact in double, so one multiply or divide rounds correctly),
+// the others are converted by strtod() from a copy of the token
+static const char *ParseDouble(const char *p, const char *end, double *d)
+{
+	static const double	pow10[23] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+									  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	const char			*s = p, *q;
+	unsigned __int64	mant = 0;
+	int					digits = 0, exp10 = 0, any = 0, slow = 0, neg = 0, eneg = 0, e = 0;
+	char				buf[64];
+
+	if( p < end && ( *p == '-' || *p == '+' ) )
+		neg = *p++ == '-';
+	for(; p < end && IS_DIGIT(*p); p++, any=1)
+		if( mant || *p != '0' )
+		{
+			if( digits < 15 )		{	mant = mant * 10 + (*p - '0');	digits ++;	}
+			else					slow = 1;
+		}
+	if( p < end && *p == '.' )
+		for(p++; p < end && IS_DIGIT(*p); p++, any=1)
+		{
+			if( mant || *p != '0' )
+			{
+				if( digits < 15 )	{	mant = mant * 10 + (*p - '0');	digits ++;	}
+				else				slow = 1;
+			}
+			exp10 --;
+		}
+	if( any && p < end && ( *p == 'e' || *p == 'E' ) )
+	{
+		q = p + 1;
+		if( q < end && ( *q == '-' || *q == '+' ) )
+			eneg = *q++ == '-';
+		if( q < end && IS_DIGIT(*q) )
+			for(p=q; p < end && IS_DIGIT(*p); p++)
+				if( e < 10000 )
+					e = e * 10 + (*p - '0');
+	}
+	exp10 += eneg ? -e : e;
+
+	if( !any || slow || exp10 < -22 || exp10 > 22 )
+	{
+		q = SkipToken(s, end);
+		if( q - s > (int)sizeof(buf) - 1 )
+			q = s + sizeof(buf) - 1;
+		memcpy(buf, s, q - s);
+		buf[q - s] = 0;
+		*d = strtod(buf, NULL);
+		return SkipToken(s, end);
+	}
+
+	*d = (double)mant;
+	*d = exp10 < 0 ? *d / pow10[-exp10] : *d * pow10[exp10];
+	if( neg )
+		*d = -*d;
+	return SkipToken(p, end);
+}
+
+// vertex of a face, "V", "V/VT/VN", "V//VN" or "V/VT", return 0 if it isn't a number
+static int ParseIndex(const char *p, const char *end, int *value)
+{
+	int			neg = 0, n = 0;
+
+	if( p < end && ( *p == '-' || *p == '+' ) )
+		neg = *p++ == '-';
+	if( p >= end || !IS_DIGIT(*p) )
+		return 0;
+	for(; p < end && IS_DIGIT(*p); p++)
+		n = n * 10 + (*p - '0');
+	*value = neg ? -n : n;
+	return 1;
+}
+
+// number of vertices of the face of a line, after the token "f"
+static int CountFaceVer(const char *p, const char *end)
+{
+	int			n = 0, value;
+
+	for(p=SkipBlank(p, end); p < end && *p != '\n'; p=SkipBlank(SkipToken(p, end), end))
+		n += ParseIndex(p, end, &value);
+	return n;
+}
+
+// ************************************************************************************************
+// materials
+
+static unsigned int HashName(const char *p, int len)
+{
+	unsigned int	h = 2166136261u;		// FNV-1a
+	int				i;
+
+	for(i=0; i<len; i++)
+		h = (h ^ (unsigned char)p[i]) * 16777619u;
+	return h;
+}
+
+// material of a name, 0 if unknown
+static int FindMtl(ObjJob *job, const char *p, int len)
+{
+	unsigned int	h;
+	int				i;
+
+	if( job->NumMtl == 0 )
+		return 0;
+	for(h=HashName(p, len) & (job->HashSize-1); (i = job->Hash[h]) != 0; h=(h+1) & (job->HashSize-1))
+		if( (int)strlen(job->Mtl[i-1]->name) == len && memcmp(job->Mtl[i-1]->name, p, len) == 0 )
+			return i;
+	return 0;
+}
+
+// read "mtllib" of all chunks in order, and then the materials are found by the hash of the name
+// a name defined twice is the first one of the list, the same with searching the list
+static void LoadMtl(ObjJob *job, int NumChunk, pMeterial *color)
+{
+	char			name[400];
+	const char		*p, *q;
+	const char		*end = job->data + job->size;
+	pMeterial		pm;
+	unsigned int	h;
+	int				i, k, len;
+
+	for(k=0; k<NumChunk; k++)
+		for(i=0; i<job->chunk[k].NumMtlLib; i++)
+		{
+			p = job->data + job->chunk[k].MtlLib[i];
+			q = SkipToken(p, end);
+			len = q - p < (int)sizeof(name) - 1 ? (int)(q - p) : (int)sizeof(name) - 1;
+			memcpy(name, p, len);
+			name[len] = 0;
+			ReadMeterial(name, color);
+		}
+
+	job->NumMtl = 0;
+	for(pm=*color; pm; pm=pm->pointer)
+		job->NumMtl ++;
+	job->Mtl = (pMeterial *) malloc ((job->NumMtl ? job->NumMtl : 1) * sizeof(pMeterial));
+	for(i=0, pm=*color; pm; pm=pm->pointer)
+		job->Mtl[i++] = pm;
+
+	for(job->HashSize=16; job->HashSize < 2 * job->NumMtl; job->HashSize*=2)
+		;
+	job->Hash = (int *) malloc (job->HashSize * sizeof(int));
+	memset(job->Hash, 0, job->HashSize * sizeof(int));
+	for(i=0; i<job->NumMtl; i++)
+	{
+		len = (int)strlen(job->Mtl[i]->name);
+		if( FindMtl(job, job->Mtl[i]->name, len) )
+			continue;
+		for(h=HashName(job->Mtl[i]->name, len) & (job->HashSize-1); job->Hash[h]; h=(h+1) & (job->HashSize-1))
+			;
+		job->Hash[h] = i + 1;
+	}
+}
+
+// ************************************************************************************************
+// the two passes of a chunk
+
+static void CountWork(void *Param, int id, int k)
+{
+	ObjJob			*job = (ObjJob *)Param;
+	ObjChunk		*c = job->chunk + k;
+	const char		*end = job->data + job->size;
+	const char		*line, *p, *q;
+	int				n, MaxMtlLib = 0;
+
+	c->NumVer = c->NumFace = c->NumTri = 0;
+	c->MtlLib = NULL;
+	c->NumMtlLib = 0;
+	c->LastMtl = -1;
+	for(line=job->data+c->start; line < job->data+c->end; line=NextLine(line, end))
+	{
+		p = SkipBlank(line, end);
+		// Skip blank lines and comments
+		if( p >= end || *p == '\n' || *p == '#' || *p == '$' )
+			continue;
+		q = SkipToken(p, end);
+
+		if( IsToken(p, q, "v") )
+			c->NumVer ++;
+		else if( IsToken(p, q, "f") )
+		{
+			c->NumFace ++;
+			n = CountFaceVer(q, end);
+			if( n > 2 )
+				c->NumTri += n - 2;
+		}
+		else if( IsToken(p, q, "usemtl") )
+			c->LastMtl = SkipBlank(q, end) - job->data;
+		else if( IsToken(p, q, "mtllib") )
+		{
+			if( c->NumMtlLib == MaxMtlLib )
+			{
+				MaxMtlLib = MaxMtlLib ? 2 * MaxMtlLib : 4;
+				c->MtlLib = (__int64 *) realloc (c->MtlLib, MaxMtlLib * sizeof(__int64));
+			}
+			c->MtlLib[c->NumMtlLib++] = SkipBlank(q, end) - job->data;
+		}
+	}
+}
+
+static void FillWork(void *Param, int id, int k)
+{
+	ObjJob			*job = (ObjJob *)Param;
+	ObjChunk		*c = job->chunk + k;
+	const char		*end = job->data + job->size;
+	const char		*line, *p, *q;
+	pMesh			m = job->m;
+	pTri			t;
+	double			r[3];
+	int				i, n, value, index, first, prev, bad, FirstTri;
+	int				VerIndex = c->VerBase, FaceIndex = c->FaceBase, TriIndex = c->TriBase;
+	int				mtl = c->StartMtl;
+
+	c->NumDropped = 0;
+	for(line=job->data+c->start; line < job->data+c->end; line=NextLine(line, end))
+	{
+		p = SkipBlank(line, end);
+		if( p >= end || *p == '\n' || *p == '#' || *p == '$' )
+			continue;
+		q = SkipToken(p, end);
+
+		/*	V X Y Z W
+			Geometric vertex, W is optional		*/
+		if( IsToken(p, q, "v") )
+		{
+			r[0] = r[1] = r[2] = 0;
+			for(i=0, p=SkipBlank(q, end); i<3 && p < end && *p != '\n'; i++)
+				p = SkipBlank(ParseDouble(p, end, r+i), end);
+			if( m )
+			{
+				m->x[VerIndex] = (float)r[0];
+				m->y[VerIndex] = (float)r[1];
+				m->z[VerIndex] = (float)r[2];
+			}
+			else
+				for(i=0; i<3; i++)
+					job->v[VerIndex].coor[i] = r[i];
+			VerIndex ++;
+		}
+		/*	F V1 V2 V3 ... or F V1/VT1/VN1 ...
+			OBJ indices are 1 based, and negative ones are relative to the last vertex		*/
+		else if( IsToken(p, q, "f") )
+		{
+			n = bad = 0;
+			first = prev = 0;
+			FirstTri = TriIndex;
+			t = m ? NULL : job->t + FaceIndex;
+			for(p=SkipBlank(q, end); p < end && *p != '\n'; p=SkipBlank(SkipToken(p, end), end))
+			{
+				if( !ParseIndex(p, end, &value) )
+					continue;
+				index = value < 0 ? VerIndex + value : value - 1;
+				if( index < 0 || index >= job->NumVer )
+					bad = 1;
+				if( m )
+				{
+					// triangulated as a fan, the same with GL_POLYGON
+					if( n >= 2 )
+					{
+						m->index[3*TriIndex] = first;
+						m->index[3*TriIndex+1] = prev;
+						m->index[3*TriIndex+2] = index;
+						if( m->Material )
+							m->Material[TriIndex] = mtl;
+						TriIndex ++;
+					}
+					if( n == 0 )
+						first = index;
+					prev = index;
+				}
+				else if( n < POLYGON_MAX )
+					t->v[n] = index;
+				n ++;
+			}
+
+			if( t )
+			{
+				t->NodeName = n < POLYGON_MAX ? n : POLYGON_MAX;
+				if( mtl )
+				{
+					t->r = job->Mtl[mtl-1]->r;
+					t->g = job->Mtl[mtl-1]->g;
+					t->b = job->Mtl[mtl-1]->b;
+				}
+			}
+			// removed by DropFaces() after all chunks are parsed
+			if( bad )
+			{
+				if( t )
+					t->NodeName = (int)DROPPED;
+				else
+					for(i=FirstTri; i<TriIndex; i++)
+						m->index[3*i] = DROPPED;
+				c->NumDropped ++;
+			}
+			FaceIndex ++;
+		}
+		else if( IsToken(p, q, "usemtl") )
+		{
+			p = SkipBlank(q, end);
+			mtl = FindMtl(job, p, (int)(SkipToken(p, end) - p));
+		}
+	}
+}
+
+// remove the faces marked by FillWork(), keeping the order of the others
+static void DropFaces(ObjJob *job, int *NumTri)
+{
+	pMesh			m = job->m;
+	int				i, n;
+
+	if( m )
+	{
+		for(i=0, n=0; i<m->NumTri; i++)
+			if( m->index[3*i] != DROPPED )
+			{
+				memmove(m->index+3*n, m->index+3*i, 3 * sizeof(unsigned int));
+				if( m->Material )
+					m->Material[n] = m->Material[i];
+				n ++;
+			}
+		m->NumTri = n;
+	}
+	else
+	{
+		for(i=0, n=0; i<*NumTri; i++)
+			if( job->t[i].NodeName != (int)DROPPED )
+				job->t[n++] = job->t[i];
+		*NumTri = n;
+	}
+}
+
+// ************************************************************************************************
+
+// parse an OBJ file into a triangle mesh (mesh is not NULL), or polygons of ReadObj()
+// return 0 if the file can't be opened
+LFD_API int ParseObj(char *filename, pMesh *mesh, pVer *vertex, pTri *triangle, int *NumVer, int *NumTri)
+{
+	MappedFile		mf;
+	ObjJob			job;
+	ObjChunk		*c;
+	pMeterial		color = NULL, pm;
+	pMesh			m = NULL;
+	const char		*p;
+	__int64			b;
+	int				i, k, NumChunk, NumThread, nv, nf, nt, mtl, NumDropped;
+
+	if( !MapFile(filename, &mf) )
+		return 0;
+
+	// chunk k begins at the first line after k * OBJ_CHUNK, so that every line is in one chunk
+	NumChunk = (int)( (mf.size + OBJ_CHUNK - 1) / OBJ_CHUNK );
+	if( NumChunk < 1 )
+		NumChunk = 1;
+	memset(&job, 0, sizeof(ObjJob));
+	job.data = mf.data;
+	job.size = mf.size;
+	job.chunk = (ObjChunk *) malloc (NumChunk * sizeof(ObjChunk));
+	job.chunk[0].start = 0;
+	for(k=1; k<NumChunk; k++)
+	{
+		b = (__int64)k * OBJ_CHUNK;
+		if( b < job.chunk[k-1].start )
+			b = job.chunk[k-1].start;
+		else if( b > 0 )
+		{
+			p = (const char *) memchr(mf.data + b - 1, '\n', (size_t)(mf.size - b + 1));
+			b = p ? p + 1 - mf.data : mf.size;
+		}
+		job.chunk[k].start = job.chunk[k-1].end = b;
+	}
+	job.chunk[NumChunk-1].end = mf.size;
+
+	NumThread = ObjThread > 0 ? ObjThread : GetCpuNum();
+	if( NumThread > NumChunk )
+		NumThread = NumChunk;
+	RunJobs(NumThread, NumChunk, CountWork, &job);
+
+	// the first vertex, face and triangle of each chunk, and the materials
+	nv = nf = nt = 0;
+	for(k=0; k<NumChunk; k++)
+	{
+		c = job.chunk + k;
+		c->VerBase = nv;
+		c->FaceBase = nf;
+		c->TriBase = nt;
+		nv += c->NumVer;
+		nf += c->NumFace;
+		nt += c->NumTri;
+	}
+	job.NumVer = nv;
+	LoadMtl(&job, NumChunk, &color);
+	for(k=0, mtl=0; k<NumChunk; k++)
+	{
+		c = job.chunk + k;
+		c->StartMtl = mtl;
+		if( c->LastMtl >= 0 )
+		{
+			p = mf.data + c->LastMtl;
+			mtl = FindMtl(&job, p, (int)(SkipToken(p, mf.data + mf.size) - p));
+		}
+	}
+
+	if( mesh )
+	{
+		// material i+1 is the i-th of the list, a face without "usemtl" (or unknown material) is material 0
+		m = job.m = CreateMesh(nv, nt);
+		for(i=0; i<job.NumMtl; i++)
+			AddMaterial(m, job.Mtl[i]->r, job.Mtl[i]->g, job.Mtl[i]->b);
+		if( job.NumMtl )
+			m->Material = (int *) malloc ((nt ? nt : 1) * sizeof(int));
+	}
+	else
+	{
+		*NumVer = nv;
+		*NumTri = nf;
+		job.v = *vertex = (pVer) malloc ((nv ? nv : 1) * sizeof(Ver));
+		memset(*vertex, 0, (nv ? nv : 1) * sizeof(Ver));
+		job.t = *triangle = (pTri) malloc ((nf ? nf : 1) * sizeof(Tri));
+		memset(*triangle, 0, (nf ? nf : 1) * sizeof(Tri));
+	}
+
+	RunJobs(NumThread, NumChunk, FillWork, &job);
+	for(k=0, NumDropped=0; k<NumChunk; k++)
+		NumDropped += job.chunk[k].NumDropped;
+	if( NumDropped > 0 )
+	{
+		DropFaces(&job, NumTri);
+		printf("%s: %d faces of a vertex index out of range are dropped\n", filename, NumDropped);
+	}
+
+	if( mesh )
+	{
+		TrimMaterial(m);
+		*mesh = m;
+	}
+
+	// free memory of meterial
+	for(pm=color; pm; pm=color)
+	{
+		color = color->pointer;
+		free(pm);
+	}
+	for(k=0; k<NumChunk; k++)
+		if( job.chunk[k].MtlLib )
+			free(job.chunk[k].MtlLib);
+	free(job.chunk);
+	free(job.Mtl);
+	free(job.Hash);
+	UnmapFile(&mf);
+
+	return 1;
+}
+
+// the same with ReadObj(), but polygons are triangulated as fans while reading,
+// and the materials of "mtllib" are material 1 ~ n, a face without "usemtl" (or unknown material) is material 0
+LFD_API int ReadObjMesh(char *filename, pMesh *mesh)
+{
+	char		fname[400];
+
+	sprintf(fname, "%s.obj", filename);
+	return ParseObj(fname, mesh, NULL, NULL, NULL, NULL);
+}
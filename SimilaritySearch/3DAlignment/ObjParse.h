@@ -0,0 +1,3 @@
+LFD_API void SetObjThread(int NumThread);
+LFD_API int ParseObj(char *filename, pMesh *mesh, pVer *vertex, pTri *triangle, int *NumVer, int *NumTri);
+LFD_API int ReadObjMesh(char *filename, pMesh *mesh);
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <malloc.h>
 #include "ds.h"
+#include "ObjParse.h"
 
 #define		LINE_MAX_LEN	256
 
@@ -52,166 +53,13 @@ int ReadMeterial(char *filename, pMeterial *color)
 	return 1;
 }
 
+// read the polygons of an .obj file, see ParseObj()
 LFD_API int ReadObj(char *filename, pVer *vertex, pTri *triangle, int *NumVer, int *NumTri)
 {
-	FILE		*fpt;
-	char		input[LINE_MAX_LEN];
-	char		token[LINE_MAX_LEN];
-	char		*next;
-	int			width;
-	int			numver, numtri;
-	int			VerIndex, TriIndex;
-	double		r0, r1, r2;
-	char		value[LINE_MAX_LEN];
-	// the face is triangle, but sometimes, the face has 4 vertex, split it to two triangles
-	int			f[50];	// the maximum vertices of a face is defined as 50 ( 3 is normal )
-	int			fn;		// vertex number of a face
-	int			i;
-	// for color
-	pMeterial	color = NULL;
-	pMeterial	pNowMtl = NULL;
 	char			fname[400];
-	
-	sprintf(fname, "%s.obj", filename);
-	if( (fpt = fopen(fname, "r")) == NULL )
-		return 0;	// False
-
-	// one pass: get the number of vertex and triangle
-	numver = 0;
-	numtri = 0;
-	color = NULL;
-	while( fgets(input, LINE_MAX_LEN, fpt) != NULL ) 
-	{
-
-		//  Advance to the first nonspace character in "input"
-		for ( next = input; *next != '\0' && isspace(*next); next++ )
-			;
 
-		// Skip blank lines and comments
-		if ( *next == '\0' || *next == '#' || *next == '$')
-			continue;
-
-		// Extract the first word in this line. 
-		sscanf ( next, "%s%n", token, &width );
-		next = next + width;
-
-		if( strcmp(token, "v") == 0 )
-			numver ++;
-		else if( strcmp(token, "f") == 0 )
-			numtri ++;
-		// read the color
-		else if( strcmp(token, "mtllib") == 0 )
-		{
-			sscanf ( next, "%s", token );
-			if( !ReadMeterial(token, &color) )
-				;//return 0;
-		}
-	}
-	*NumVer = numver;
-	*NumTri = numtri;
-
-	// allocate memory of vertex and triangle
-	*vertex = (pVer) malloc( numver * sizeof(Ver));
-	memset(*vertex, 0, numver * sizeof(Ver));
-	*triangle = (pTri) malloc( numtri * sizeof(Tri));
-	memset(*triangle, 0, numtri * sizeof(Tri));
-
-	// two pass: get data of vertex and triangle
-	fseek(fpt, 0, SEEK_SET);
-
-	VerIndex = 0;
-	TriIndex = 0;
-	pNowMtl = NULL;
-	while( fgets(input, LINE_MAX_LEN, fpt) != NULL )
-	{
-
-		//  Advance to the first nonspace character in INPUT
-		for ( next = input; *next != '\0' && isspace(*next); next++ )
-			;
-
-		// Skip blank lines and comments
-		if ( *next == '\0' || *next == '#' || *next == '$')
-			continue;
-
-		// Extract the first word in this line. 
-		sscanf ( next, "%s%n", token, &width );
-		
-		// Set NEXT to point to just after this token. 
-		next = next + width;
-
-		/*	V X Y Z W
-			Geometric vertex.
-			W is optional, a weight for rational curves and surfaces.
-			The default for W is 1.		*/
-		if( strcmp(token, "v") == 0 )
-		{
-			sscanf ( next, "%lf %lf %lf", &r0, &r1, &r2 );
-
-			(*vertex)[VerIndex].coor[0] = r0;
-			(*vertex)[VerIndex].coor[1] = r1;
-			(*vertex)[VerIndex].coor[2] = r2;
-
-			VerIndex ++;
-		}
-		/*  F V1 V2 V3
-			or
-			F V1/VT1/VN1 V2/VT2/VN2 ...
-			or
-			F V1//VN1 V2//VN2 ...
-			or
-			F V1/VT1/ V2/VT2/ ...
-
-			Face.
-			A face is defined by the vertices.
-			Optionally, slashes may be used to include the texture vertex
-			and vertex normal indices.
-
-			OBJ line node indices are 1 based rather than 0 based.
-			So we have to decrement them before loading them into FACE.			*/
-		// sometimes in a obj file, there maybe use two kind mode of "f" in different group
-		// so, it have to check format when starting read "f"
-		else if( strcmp(token, "f") == 0 )
-		{
-			fn = 0;
-			while( sscanf( next, "%s%n", value, &width) != EOF )
-			{
-				sscanf( value, "%d", f+fn);
-				next = next + width;
-				fn ++;
-			}
-
-			for(i=0; i<fn; i++)
-				(*triangle)[TriIndex].v[i] = f[i] - 1;
-
-			(*triangle)[TriIndex].NodeName = fn;	// record the number of vertex in this triangle
-
-			// color
-			if( pNowMtl )
-			{
-				(*triangle)[TriIndex].r = pNowMtl->r;
-				(*triangle)[TriIndex].g = pNowMtl->g;
-				(*triangle)[TriIndex].b = pNowMtl->b;
-			}
-
-			TriIndex ++;
-		}
-		else if( strcmp(token, "usemtl") == 0 )
-		{
-			sscanf(next, "%s", token);
-			for(pNowMtl=color; pNowMtl && strcmp(pNowMtl->name, token); pNowMtl=pNowMtl->pointer)
-				;
-		}
-	}
-
-	// free memory of meterial
-	for(pNowMtl=color; pNowMtl; pNowMtl=color)
-	{
-		color = color->pointer;
-		free(pNowMtl);
-	}
-
-	fclose(fpt);
-	return 1;	// True
+	sprintf(fname, "%s.obj", filename);
+	return ParseObj(fname, NULL, vertex, triangle, NumVer, NumTri);
 }
 
 void SaveObj(char *filename, pVer vertex, pTri triangle, int NumVer, int NumTri)
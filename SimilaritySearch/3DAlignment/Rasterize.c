@@ -0,0 +1,645 @@
+#include <malloc.h>
+#include <memory.h>
+#include <math.h>
+
+#include "ds.h"
+#include "Thread.h"
+#include "Mesh.h"
+
+// software rasterizer of the fixed camera used for all silhouettes, that is
+//		glOrtho(-1, 1, -1, 1, 0.0, 2.0);
+//		glViewport(0, 0, WIDTH, HEIGHT);
+//		gluLookAt(CamVertex, 0, 0, 0, 0, 1, 0);
+// the result is the same layout with glReadPixels(GL_DEPTH_COMPONENT, GL_UNSIGNED_BYTE),
+// rows from bottom to top, and 255 is background (depth = 1.0)
+// so that it can replace RenderToMem() without any OpenGL window
+
+#define	SUB_BITS		8					// vertex is 24.8 fixed point in window coordinate
+#define	SUB_ONE			(1<<SUB_BITS)
+#define	SUB_HALF		(SUB_ONE>>1)		// center of pixel
+#define	COOR_LIMIT		16384.0				// clamp window coordinate, so edge function never overflow
+#define	MASK_NEAR		0.001f				// depth of a triangle is tested per pixel if any vertex is out of [MASK_NEAR, MASK_FAR]
+#define	MASK_FAR		0.99f				// less than 254.5 / 255, the last depth in byte of foreground
+
+LFD_API pRaster CreateRaster()
+{
+	pRaster		ras;
+
+	ras = (pRaster) malloc (sizeof(Raster));
+	ras->depth = (float *) malloc (WIDTH * HEIGHT * sizeof(float));
+	ras->px = ras->py = NULL;
+	ras->pz = NULL;
+	ras->MaxVer = 0;
+	ras->NumThread = 1;
+	ras->Pool = NULL;
+	ras->Bin = NULL;
+	ras->BinNum = ras->BinMax = NULL;
+
+	return ras;
+}
+
+// render each view by NumThread threads, the result is the same with single thread
+// the screen is split into TILE_NUM tiles, triangles are binned to the tiles they touch,
+// and then each tile is drawn by a thread in the order of triangles
+// the threads are started here and wait for each view, so that no thread is created per view
+LFD_API void SetRasterThread(pRaster ras, int NumThread)
+{
+	int			i;
+
+	if( NumThread < 1 )				NumThread = 1;
+	if( NumThread > MAX_THREAD )	NumThread = MAX_THREAD;
+
+	if( ras->Bin )
+	{
+		for(i=0; i<ras->NumThread * TILE_NUM; i++)
+			if( ras->Bin[i] )
+				free(ras->Bin[i]);
+		free(ras->Bin);
+		free(ras->BinNum);
+		free(ras->BinMax);
+		ras->Bin = NULL;
+		ras->BinNum = ras->BinMax = NULL;
+	}
+	FreeThreadPool(ras->Pool);
+	ras->Pool = NULL;
+
+	ras->NumThread = NumThread;
+	if( NumThread > 1 )
+	{
+		ras->Pool = CreateThreadPool(NumThread);
+		ras->Bin = (int **) malloc (NumThread * TILE_NUM * sizeof(int *));
+		ras->BinNum = (int *) malloc (NumThread * TILE_NUM * sizeof(int));
+		ras->BinMax = (int *) malloc (NumThread * TILE_NUM * sizeof(int));
+		for(i=0; i<NumThread * TILE_NUM; i++)
+		{
+			ras->Bin[i] = NULL;
+			ras->BinNum[i] = ras->BinMax[i] = 0;
+		}
+	}
+}
+
+LFD_API void FreeRaster(pRaster ras)
+{
+	if( ras == NULL )
+		return;
+
+	free(ras->depth);
+	if( ras->px )	free(ras->px);
+	if( ras->py )	free(ras->py);
+	if( ras->pz )	free(ras->pz);
+	SetRasterThread(ras, 1);
+	free(ras);
+}
+
+static int ToFixed(double w)
+{
+	if( w > COOR_LIMIT )		w = COOR_LIMIT;
+	if( w < -COOR_LIMIT )		w = -COOR_LIMIT;
+	return (int)floor(w * SUB_ONE + 0.5);
+}
+
+static void AllocVertex(pRaster ras, int nv)
+{
+	if( nv > ras->MaxVer )
+	{
+		if( ras->px )	free(ras->px);
+		if( ras->py )	free(ras->py);
+		if( ras->pz )	free(ras->pz);
+		ras->px = (int *) malloc (nv * sizeof(int));
+		ras->py = (int *) malloc (nv * sizeof(int));
+		ras->pz = (float *) malloc (nv * sizeof(float));
+		ras->MaxVer = nv;
+	}
+}
+
+// axis of the camera, the same with gluLookAt()
+static void LookAt(pVer CamVertex, double s[3], double u[3], double f[3])
+{
+	double		len;
+	int			k;
+
+	// f = center - eye
+	for(k=0; k<3; k++)
+		f[k] = -CamVertex->coor[k];
+	len = sqrt(f[0]*f[0] + f[1]*f[1] + f[2]*f[2]);
+	for(k=0; k<3; k++)
+		f[k] /= len;
+
+	// s = f x up, up = (0, 1, 0)
+	s[0] = -f[2];
+	s[1] = 0;
+	s[2] = f[0];
+	len = sqrt(s[0]*s[0] + s[2]*s[2]);
+	s[0] /= len;
+	s[2] /= len;
+
+	// u = s x f
+	u[0] = s[1]*f[2] - s[2]*f[1];
+	u[1] = s[2]*f[0] - s[0]*f[2];
+	u[2] = s[0]*f[1] - s[1]*f[0];
+}
+
+// transform vertex [start, end) to window coordinate, the same with gluLookAt() and glOrtho()
+static void ProjectRange(pRaster ras, pVer CamVertex, double *s, double *u, double *f, pMesh m, int start, int end)
+{
+	double		d[3];
+	int			i;
+
+	for(i=start; i<end; i++)
+	{
+		d[0] = m->x[i] - CamVertex->coor[0];
+		d[1] = m->y[i] - CamVertex->coor[1];
+		d[2] = m->z[i] - CamVertex->coor[2];
+		// x and y in [-1, 1] map to [0, WIDTH] and [0, HEIGHT]
+		ras->px[i] = ToFixed( (s[0]*d[0] + s[1]*d[1] + s[2]*d[2] + 1) * WIDTH / 2 );
+		ras->py[i] = ToFixed( (u[0]*d[0] + u[1]*d[1] + u[2]*d[2] + 1) * HEIGHT / 2 );
+		// distance in [0, 2] (near and far plane) map to depth [0, 1]
+		ras->pz[i] = (float)( (f[0]*d[0] + f[1]*d[1] + f[2]*d[2]) / 2 );
+	}
+}
+
+// transform all vertex to window coordinate
+static void ProjectVertex(pRaster ras, pVer CamVertex, pMesh m)
+{
+	double		s[3], u[3], f[3];
+
+	AllocVertex(ras, m->NumVer);
+	LookAt(CamVertex, s, u, f);
+	ProjectRange(ras, CamVertex, s, u, f, m, 0, m->NumVer);
+}
+
+// edge functions of a triangle in fixed point, inside if all of them >= 0
+typedef struct TriEdge_ {
+	__int64		x[3], y[3];		// vertex, counter-clockwise
+	__int64		r[3];			// edge function at the first pixel center of a row
+	__int64		s[3];			// step of edge function from one pixel to the next
+	int			b[3];			// bias of top-left fill rule
+	int			i[3];			// vertex index
+	int			sx, sy, ex, ey;	// pixels to be tested, [sx, ex) x [sy, ey)
+}TriEdge;
+
+// only pixels inside [MinX, MaxX) x [MinY, MaxY) are tested, return 0 if nothing to draw
+// the result of a pixel depends on nothing but the triangle, so any clipping rectangle gives the same pixel
+static int SetupTriangle(pRaster ras, int i0, int i1, int i2, int MinX, int MinY, int MaxX, int MaxY, TriEdge *te)
+{
+	__int64		area, c;
+	int			k, k1, k2;
+
+	te->i[0] = i0;
+	te->i[1] = i1;
+	te->i[2] = i2;
+	for(k=0; k<3; k++)
+	{
+		te->x[k] = ras->px[te->i[k]];
+		te->y[k] = ras->py[te->i[k]];
+	}
+
+	area = (te->x[1]-te->x[0]) * (te->y[2]-te->y[0]) - (te->y[1]-te->y[0]) * (te->x[2]-te->x[0]);
+	if( area == 0 )
+		return 0;
+	// counter-clockwise, so the inside is at the left of each edge
+	if( area < 0 )
+	{
+		te->i[1] = i2;	te->i[2] = i1;
+		c = te->x[1];	te->x[1] = te->x[2];	te->x[2] = c;
+		c = te->y[1];	te->y[1] = te->y[2];	te->y[2] = c;
+	}
+
+	// bounding box of pixel center
+	c = te->x[0]<te->x[1] ? te->x[0] : te->x[1];	c = c<te->x[2] ? c : te->x[2];
+	te->sx = (int)( (c - SUB_HALF + SUB_ONE - 1) >> SUB_BITS );
+	c = te->x[0]>te->x[1] ? te->x[0] : te->x[1];	c = c>te->x[2] ? c : te->x[2];
+	te->ex = (int)( (c - SUB_HALF) >> SUB_BITS ) + 1;
+	c = te->y[0]<te->y[1] ? te->y[0] : te->y[1];	c = c<te->y[2] ? c : te->y[2];
+	te->sy = (int)( (c - SUB_HALF + SUB_ONE - 1) >> SUB_BITS );
+	c = te->y[0]>te->y[1] ? te->y[0] : te->y[1];	c = c>te->y[2] ? c : te->y[2];
+	te->ey = (int)( (c - SUB_HALF) >> SUB_BITS ) + 1;
+	if( te->sx < MinX )		te->sx = MinX;
+	if( te->sy < MinY )		te->sy = MinY;
+	if( te->ex > MaxX )		te->ex = MaxX;
+	if( te->ey > MaxY )		te->ey = MaxY;
+	if( te->sx >= te->ex || te->sy >= te->ey )
+		return 0;
+
+	// edge k is from vertex k1 to k2 (opposite to vertex k)
+	for(k=0; k<3; k++)
+	{
+		k1 = (k+1) % 3;
+		k2 = (k+2) % 3;
+		// top-left fill rule: pixel center on an edge belongs to the triangle only if the edge is top or left
+		te->b[k] = ( te->y[k2]-te->y[k1] < 0 || ( te->y[k2]-te->y[k1] == 0 && te->x[k2]-te->x[k1] < 0 ) ) ? 0 : -1;
+		te->s[k] = (te->y[k2]-te->y[k1]) * SUB_ONE;
+	}
+
+	return 1;
+}
+
+// edge function at pixel (sx, y)
+static void SetupRow(TriEdge *te, int y)
+{
+	__int64		cx, cy;
+	int			k, k1, k2;
+
+	cx = (__int64)te->sx * SUB_ONE + SUB_HALF;
+	cy = (__int64)y * SUB_ONE + SUB_HALF;
+	for(k=0; k<3; k++)
+	{
+		k1 = (k+1) % 3;
+		k2 = (k+2) % 3;
+		te->r[k] = (te->x[k2]-te->x[k1]) * (cy-te->y[k1]) - (te->y[k2]-te->y[k1]) * (cx-te->x[k1]) + te->b[k];
+	}
+}
+
+// depth is linear in window coordinate for orthographic projection, z = zr + dzdx * x
+static void SetupDepth(pRaster ras, TriEdge *te, double *dzdx, double *dzdy)
+{
+	__int64		area;
+	double		z0;
+
+	area = (te->x[1]-te->x[0]) * (te->y[2]-te->y[0]) - (te->y[1]-te->y[0]) * (te->x[2]-te->x[0]);
+	z0 = ras->pz[te->i[0]];
+	*dzdx = ( (ras->pz[te->i[1]]-z0) * (double)(te->y[2]-te->y[0]) - (ras->pz[te->i[2]]-z0) * (double)(te->y[1]-te->y[0]) ) / (double)area;
+	*dzdy = ( (ras->pz[te->i[2]]-z0) * (double)(te->x[1]-te->x[0]) - (ras->pz[te->i[1]]-z0) * (double)(te->x[2]-te->x[0]) ) / (double)area;
+}
+
+static double RowDepth(pRaster ras, TriEdge *te, double dzdx, double dzdy, int y)
+{
+	return ras->pz[te->i[0]] + dzdy * (double)((__int64)y * SUB_ONE + SUB_HALF - te->y[0]) - dzdx * (double)te->x[0];
+}
+
+#define	PIXEL_DEPTH(zr, dzdx, x)	( (float)( (zr) + (dzdx) * (double)((__int64)(x) * SUB_ONE + SUB_HALF) ) )
+
+// draw a triangle to the depth buffer, only pixels inside [MinX, MaxX) x [MinY, MaxY)
+static void DrawTriangle(pRaster ras, int i0, int i1, int i2, unsigned char *bmColor, unsigned char *rgb,
+						 int MinX, int MinY, int MaxX, int MaxY)
+{
+	TriEdge		te;
+	__int64		e0, e1, e2;
+	int			x, y;
+	double		dzdx, dzdy, zr;
+	float		z, *pDepth;
+	unsigned char	*pColor;
+
+	if( !SetupTriangle(ras, i0, i1, i2, MinX, MinY, MaxX, MaxY, &te) )
+		return;
+	SetupDepth(ras, &te, &dzdx, &dzdy);
+
+	for(y=te.sy; y<te.ey; y++)
+	{
+		SetupRow(&te, y);
+		zr = RowDepth(ras, &te, dzdx, dzdy, y);
+
+		pDepth = ras->depth + y * WIDTH;
+		pColor = bmColor ? bmColor + 3 * y * WIDTH : NULL;
+		for(x=te.sx, e0=te.r[0], e1=te.r[1], e2=te.r[2]; x<te.ex; x++)
+		{
+			if( (e0 | e1 | e2) >= 0 )
+			{
+				z = PIXEL_DEPTH(zr, dzdx, x);
+				// clip by near and far plane, and GL_LESS depth test
+				if( z >= 0 && z <= 1 && z < pDepth[x] )
+				{
+					pDepth[x] = z;
+					if( pColor )
+					{
+						pColor[3*x] = rgb[0];
+						pColor[3*x+1] = rgb[1];
+						pColor[3*x+2] = rgb[2];
+					}
+				}
+			}
+			e0 -= te.s[0];
+			e1 -= te.s[1];
+			e2 -= te.s[2];
+		}
+	}
+}
+
+// floor(a / b), b > 0
+static __int64 FloorDiv(__int64 a, __int64 b)
+{
+	__int64		q = a / b;
+
+	if( a % b != 0 && a < 0 )
+		q --;
+	return q;
+}
+
+// set bits [x0, x1) of a packed row
+static void SetSpan(unsigned __int64 *pRow, int x0, int x1)
+{
+	int					w, w0, w1;
+	unsigned __int64	m0, m1;
+
+	w0 = x0 >> 6;
+	w1 = (x1-1) >> 6;
+	m0 = ~(unsigned __int64)0 << (x0 & 63);
+	m1 = ~(unsigned __int64)0 >> (63 - ((x1-1) & 63));
+	if( w0 == w1 )
+		pRow[w0] |= m0 & m1;
+	else
+	{
+		pRow[w0] |= m0;
+		for(w=w0+1; w<w1; w++)
+			pRow[w] = ~(unsigned __int64)0;
+		pRow[w1] |= m1;
+	}
+}
+
+// draw coverage of a triangle to packed silhouette, only pixels inside [MinX, MaxX) x [MinY, MaxY)
+// the covered pixels of each row is a span, so no pixel need to be tested
+static void DrawTriangleMask(pRaster ras, int i0, int i1, int i2, unsigned __int64 *Mask,
+							 int MinX, int MinY, int MaxX, int MaxY)
+{
+	TriEdge		te;
+	__int64		lo, hi, t;
+	int			x, y, k, clip;
+	double		dzdx, dzdy, zr;
+	float		z;
+
+	if( !SetupTriangle(ras, i0, i1, i2, MinX, MinY, MaxX, MaxY, &te) )
+		return;
+
+	// if all vertex are between near and far plane (with a margin of rounding), so does the whole triangle
+	clip = 0;
+	for(k=0; k<3; k++)
+		if( ras->pz[te.i[k]] < MASK_NEAR || ras->pz[te.i[k]] > MASK_FAR )
+			clip = 1;
+	if( clip )
+		SetupDepth(ras, &te, &dzdx, &dzdy);
+
+	for(y=te.sy; y<te.ey; y++)
+	{
+		SetupRow(&te, y);
+
+		// e(x) = r - s * (x-sx) >= 0 for each edge
+		lo = te.sx;
+		hi = te.ex - 1;
+		for(k=0; k<3; k++)
+			if( te.s[k] == 0 )
+			{
+				if( te.r[k] < 0 )
+					hi = lo - 1;
+			}
+			else if( te.s[k] > 0 )
+			{
+				t = te.sx + FloorDiv(te.r[k], te.s[k]);
+				if( t < hi )	hi = t;
+			}
+			else
+			{
+				t = te.sx - FloorDiv(te.r[k], -te.s[k]);
+				if( t > lo )	lo = t;
+			}
+		if( lo > hi )
+			continue;
+
+		if( !clip )
+			SetSpan(Mask + y * MASK_WORDS, (int)lo, (int)hi+1);
+		else
+		{
+			zr = RowDepth(ras, &te, dzdx, dzdy, y);
+			for(x=(int)lo; x<=(int)hi; x++)
+			{
+				z = PIXEL_DEPTH(zr, dzdx, x);
+				// depth of RasterizeToMem() near the far plane is 255 in byte, that is background
+				if( z >= 0 && z * 255 + 0.5f < 255 )
+					Mask[y * MASK_WORDS + (x >> 6)] |= (unsigned __int64)1 << (x & 63);
+			}
+		}
+	}
+}
+
+static unsigned char ColorToByte(double c)
+{
+	if( c <= 0 )	return 0;
+	if( c >= 1 )	return 255;
+	return (unsigned char)(c * 255 + 0.5);
+}
+
+// color of triangle i in byte
+static void TriangleColor(pMesh m, int i, unsigned char *rgb)
+{
+	double		*c;
+
+	c = m->Color + 3 * ( m->Material ? m->Material[i] : 0 );
+	rgb[0] = ColorToByte(c[0]);
+	rgb[1] = ColorToByte(c[1]);
+	rgb[2] = ColorToByte(c[2]);
+}
+
+// a view rendered by many threads
+typedef struct RasterJob_ {
+	pRaster			ras;
+	pVer			CamVertex;
+	pMesh			m;
+	double			s[3], u[3], f[3];	// axis of the camera
+	unsigned char	*bmBits, *bmColor;
+	unsigned __int64 *Mask;				// coverage only if not NULL
+	volatile long	NextTile;			// next tile to be drawn
+}RasterJob;
+
+static void ProjectWork(void *Param, int id)
+{
+	RasterJob	*job = (RasterJob *)Param;
+	int			start, end;
+
+	start = (int)( (__int64)job->m->NumVer * id / job->ras->NumThread );
+	end = (int)( (__int64)job->m->NumVer * (id+1) / job->ras->NumThread );
+	ProjectRange(job->ras, job->CamVertex, job->s, job->u, job->f, job->m, start, end);
+}
+
+// add triangle i to a bin
+static void AddToBin(pRaster ras, int bin, int i)
+{
+	if( ras->BinNum[bin] + 1 > ras->BinMax[bin] )
+	{
+		ras->BinMax[bin] = ras->BinMax[bin] ? 2 * ras->BinMax[bin] : 1024;
+		ras->Bin[bin] = (int *) realloc (ras->Bin[bin], ras->BinMax[bin] * sizeof(int));
+	}
+	ras->Bin[bin][ras->BinNum[bin]++] = i;
+}
+
+// each thread bins a continuous range of triangles, so the triangles in the bins of
+// thread 0, 1, 2 ... are in the same order as single thread
+static void BinWork(void *Param, int id)
+{
+	RasterJob		*job = (RasterJob *)Param;
+	pRaster			ras = job->ras;
+	unsigned int	*index = job->m->index;
+	TriEdge			te;
+	int				i, tx, ty, start, end, *pBin;
+
+	pBin = ras->BinNum + id * TILE_NUM;
+	for(i=0; i<TILE_NUM; i++)
+		pBin[i] = 0;
+
+	start = (int)( (__int64)job->m->NumTri * id / ras->NumThread );
+	end = (int)( (__int64)job->m->NumTri * (id+1) / ras->NumThread );
+	for(i=start; i<end; i++)
+	{
+		if( !SetupTriangle(ras, index[3*i], index[3*i+1], index[3*i+2], 0, 0, WIDTH, HEIGHT, &te) )
+			continue;
+		for(ty=te.sy/TILE_H; ty<=(te.ey-1)/TILE_H; ty++)
+			for(tx=te.sx/TILE_W; tx<=(te.ex-1)/TILE_W; tx++)
+				AddToBin(ras, id * TILE_NUM + ty * TILE_X + tx, i);
+	}
+}
+
+// clear, draw and read back a tile, no other tile touch the same pixel (or word of packed silhouette)
+static void DrawTile(RasterJob *job, int tile)
+{
+	pRaster			ras = job->ras;
+	unsigned int	*index = job->m->index;
+	int				MinX, MinY, MaxX, MaxY;
+	int				x, y, k, n, i, *pBin;
+	unsigned char	rgb[3];
+
+	MinX = (tile % TILE_X) * TILE_W;
+	MinY = (tile / TILE_X) * TILE_H;
+	MaxX = MinX + TILE_W;
+	MaxY = MinY + TILE_H;
+
+	for(y=MinY; y<MaxY; y++)
+	{
+		if( job->Mask )
+		{
+			for(x=MinX; x<MaxX; x+=64)
+				job->Mask[y * MASK_WORDS + (x >> 6)] = 0;
+		}
+		else
+		{
+			for(x=MinX; x<MaxX; x++)
+				ras->depth[y * WIDTH + x] = 1.0f;
+			if( job->bmColor )
+				memset(job->bmColor + 3 * (y * WIDTH + MinX), 255, 3 * TILE_W * sizeof(unsigned char));
+		}
+	}
+
+	for(k=0; k<ras->NumThread; k++)
+	{
+		pBin = ras->Bin[k * TILE_NUM + tile];
+		n = ras->BinNum[k * TILE_NUM + tile];
+		for(; n>0; n--, pBin++)
+		{
+			i = *pBin;
+			if( job->Mask )
+				DrawTriangleMask(ras, index[3*i], index[3*i+1], index[3*i+2], job->Mask, MinX, MinY, MaxX, MaxY);
+			else
+			{
+				TriangleColor(job->m, i, rgb);
+				DrawTriangle(ras, index[3*i], index[3*i+1], index[3*i+2], job->bmColor, rgb, MinX, MinY, MaxX, MaxY);
+			}
+		}
+	}
+
+	if( !job->Mask )
+		for(y=MinY; y<MaxY; y++)
+			for(x=MinX; x<MaxX; x++)
+				job->bmBits[y * WIDTH + x] = (unsigned char)(ras->depth[y * WIDTH + x] * 255 + 0.5f);
+}
+
+static void DrawWork(void *Param, int id)
+{
+	RasterJob	*job = (RasterJob *)Param;
+	long		tile;
+
+	while( (tile = AtomicFetchInc(&job->NextTile)) < TILE_NUM )
+		DrawTile(job, (int)tile);
+}
+
+// multi-thread version of RasterizeMeshToMem() (Mask is NULL) and RasterizeMeshMask()
+static void RasterizeTiles(pRaster ras, unsigned char *bmBits, unsigned char *bmColor, unsigned __int64 *Mask,
+						   pVer CamVertex, pMesh m)
+{
+	RasterJob	job;
+
+	job.ras = ras;
+	job.CamVertex = CamVertex;
+	job.m = m;
+	job.bmBits = bmBits;
+	job.bmColor = bmColor;
+	job.Mask = Mask;
+	job.NextTile = 0;
+
+	// vertex are transformed once, and then shared by all tiles
+	AllocVertex(ras, m->NumVer);
+	LookAt(CamVertex, job.s, job.u, job.f);
+	RunPool(ras->Pool, ProjectWork, &job);
+	RunPool(ras->Pool, BinWork, &job);
+	RunPool(ras->Pool, DrawWork, &job);
+}
+
+// the same with RenderToMem(), bmColor can be NULL
+LFD_API void RasterizeMeshToMem(pRaster ras, unsigned char *bmBits, unsigned char *bmColor, pVer CamVertex, pMesh m)
+{
+	int				i, TotalSize;
+	unsigned int	*index = m->index;
+	unsigned char	rgb[3];
+
+	if( ras->NumThread > 1 )
+	{
+		RasterizeTiles(ras, bmBits, bmColor, NULL, CamVertex, m);
+		return;
+	}
+
+	TotalSize = WIDTH * HEIGHT;
+	// glClearDepth(1.0) and glClearColor(1.0, 1.0, 1.0, 0.0)
+	for(i=0; i<TotalSize; i++)
+		ras->depth[i] = 1.0f;
+	if( bmColor )
+		memset(bmColor, 255, 3 * TotalSize * sizeof(unsigned char));
+
+	ProjectVertex(ras, CamVertex, m);
+
+	for(i=0; i<m->NumTri; i++)
+	{
+		if( bmColor )
+			TriangleColor(m, i, rgb);
+		DrawTriangle(ras, index[3*i], index[3*i+1], index[3*i+2], bmColor, rgb, 0, 0, WIDTH, HEIGHT);
+	}
+
+	// depth [0, 1] to [0, 255]
+	for(i=0; i<TotalSize; i++)
+		bmBits[i] = (unsigned char)(ras->depth[i] * 255 + 0.5f);
+}
+
+// coverage only, the same silhouette with RasterizeMeshToMem() and PackMask(), but no depth test
+// triangle order doesn't matter, each row of a triangle is OR-ed to the mask
+LFD_API void RasterizeMeshMask(pRaster ras, unsigned __int64 *Mask, pVer CamVertex, pMesh m)
+{
+	int				i;
+	unsigned int	*index = m->index;
+
+	if( ras->NumThread > 1 )
+	{
+		RasterizeTiles(ras, NULL, NULL, Mask, CamVertex, m);
+		return;
+	}
+
+	memset(Mask, 0, HEIGHT * MASK_WORDS * sizeof(unsigned __int64));
+
+	ProjectVertex(ras, CamVertex, m);
+
+	for(i=0; i<m->NumTri; i++)
+		DrawTriangleMask(ras, index[3*i], index[3*i+1], index[3*i+2], Mask, 0, 0, WIDTH, HEIGHT);
+}
+
+// polygons of ReadObj(), converted for each call
+LFD_API void RasterizeToMem(pRaster ras, unsigned char *bmBits, unsigned char *bmColor, pVer CamVertex, pVer v, pTri t, int nv, int nt)
+{
+	pMesh		m;
+
+	m = MeshFromPolygons(v, t, nv, nt);
+	RasterizeMeshToMem(ras, bmBits, bmColor, CamVertex, m);
+	FreeMesh(m);
+}
+
+LFD_API void RasterizeMask(pRaster ras, unsigned __int64 *Mask, pVer CamVertex, pVer v, pTri t, int nv, int nt)
+{
+	pMesh		m;
+
+	m = MeshFromPolygons(v, t, nv, nt);
+	RasterizeMeshMask(ras, Mask, CamVertex, m);
+	FreeMesh(m);
+}
@@ -0,0 +1,7 @@
+LFD_API pRaster CreateRaster();
+LFD_API void FreeRaster(pRaster ras);
+LFD_API void RasterizeMeshToMem(pRaster ras, unsigned char *bmBits, unsigned char *bmColor, pVer CamVertex, pMesh m);
+LFD_API void RasterizeMeshMask(pRaster ras, unsigned __int64 *Mask, pVer CamVertex, pMesh m);
+LFD_API void RasterizeToMem(pRaster ras, unsigned char *bmBits, unsigned char *bmColor, pVer CamVertex, pVer v, pTri t, int nv, int nt);
+LFD_API void RasterizeMask(pRaster ras, unsigned __int64 *Mask, pVer CamVertex, pVer v, pTri t, int nv, int nt);
+LFD_API void SetRasterThread(pRaster ras, int NumThread);
@@ -5,10 +5,8 @@
 #include "RWObj.h"
 #include "Rotate.h"
 
-extern char srcfn[];
-extern char destfn[];
-
-double RecoverAffine(double **matrix, double cost[ANGLE][ANGLE][CAMNUM_2][CAMNUM_2], int *MinSrcCam)
+// srcfn and destfn are the names of the two models, for the record in "result.txt" only
+double RecoverAffine(double **matrix, double cost[ANGLE][ANGLE][CAMNUM_2][CAMNUM_2], int *MinSrcCam, char *srcfn, char *destfn)
 {
 	double		err, MinErr;
 	int			align[60][20], i, j, k, angle, index, srcCam;
@@ -9,30 +9,29 @@
 #include "RWObj.h"
 #include "Bitmap.h"
 #include "TranslateScale.h"
+#include "Render.h"
+#include "SilStats.h"
 
 #define	MAX_ITER	1
 
-void RenderToMem(unsigned char *bmBits, pVer CamVertex, pVer v, pTri t, int nv, int nt);
-extern int		winw, winh;
-extern char		srcfn[];
-extern char		destfn[];
-
-double Distance(pVer CamVertex, unsigned char *destBuff[CAMNUM],
+double Distance(pRenderBackend rb, pVer CamVertex, unsigned char *destBuff[CAMNUM],
 				double dest_Coeff[CAMNUM][ART_ANGULAR][ART_RADIAL],
 				double src_Coeff[CAMNUM][ART_ANGULAR][ART_RADIAL],
-				pVer vertex, pTri triangle, int NumVer, int NumTri)
+				pMesh m)
 {
 	int				i;
 	double			dist;
-	double			CenX[CAMNUM], CenY[CAMNUM];
+	SilStats		Stats[CAMNUM];
 
 	for(i=0; i<CAMNUM; i++)
-		RenderToMem(destBuff[i], CamVertex+i, vertex, triangle, NumVer, NumTri);
+		RenderViewMesh(rb, destBuff[i], NULL, CamVertex+i, m);
 
-	FindRadius(destBuff, CenX, CenY);
+	for(i=0; i<CAMNUM; i++)
+		GetSilStats(destBuff[i], Stats+i);
+	FindRadius(Stats);
 
 	for(i=0; i<CAMNUM; i++)
-		ExtractCoefficients(destBuff[i], dest_Coeff[i], NULL, CenX[i], CenY[i]);
+		ExtractCoefficients(destBuff[i], dest_Coeff[i], NULL, Stats+i);
 
 	dist = 0;
 	for(i=0; i<CAMNUM; i++)
@@ -41,9 +40,10 @@ double Distance(pVer CamVertex, unsigned char *destBuff[CAMNUM],
 	return dist;
 }
 
+// srcfn and destfn are the names of the two models, for the record in "refine.txt" only
 double Refine(double src_Coeff[CAMNUM][ART_ANGULAR][ART_RADIAL],
-			  pVer vertex2, pTri triangle2, int NumVer2, int NumTri2, int UseCam,
-			  pVer CamVertex, pTri CamTriangle, int CamNumVer, int CamNumTri)
+			  pMesh m2, int UseCam,
+			  pVer CamVertex, pTri CamTriangle, int CamNumVer, int CamNumTri, pRenderBackend rb, char *srcfn, char *destfn)
 {
 	unsigned char	*destBuff[CAMNUM];	
 	pVer			TmpVertex;
@@ -76,9 +76,9 @@ double Refine(double src_Coeff[CAMNUM][ART_ANGULAR][ART_RADIAL],
 	// ********************************************************************************
 	// capture CAMNUM silhouette of destfn to memory,
 	// and get the cost between srcfn silhouette and destfn silhouette
-	// read REB only, so size is winw*winh
+	// read REB only, so size is WIDTH*HEIGHT
 	for(i=0; i<CAMNUM; i++)
-		destBuff[i] = (unsigned char *) malloc (winw * winh * sizeof(unsigned char));
+		destBuff[i] = (unsigned char *) malloc (WIDTH * HEIGHT * sizeof(unsigned char));
 
 	// initialize matrix and camera of model 1
 	matrix = (double **) malloc (4 * sizeof(double *));
@@ -95,8 +95,11 @@ double Refine(double src_Coeff[CAMNUM][ART_ANGULAR][ART_RADIAL],
 	e1[1].y = CamVertex[1].coor[1];
 	e1[1].z = CamVertex[1].coor[2];
 
+	// the cameras are rotated, but model 2 is not changed until the end, so upload once
+	UploadMesh(rb, m2);
+
 	// initialize dist[1]
-	dist[1] = Distance(CamVertex, destBuff, dest_Coeff, src_Coeff, vertex2, triangle2, NumVer2, NumTri2);
+	dist[1] = Distance(rb, CamVertex, destBuff, dest_Coeff, src_Coeff, m2);
 	// iterative several times until no change
 	iter = 0;
 	do
@@ -113,9 +116,9 @@ double Refine(double src_Coeff[CAMNUM][ART_ANGULAR][ART_RADIAL],
 			for(direct=0; direct<3; direct++)
 			{
 				pRotate[direct](CamVertex, -angle, TmpVertex, CamNumVer);
-				dist[0] = Distance(TmpVertex, destBuff, dest_Coeff, src_Coeff, vertex2, triangle2, NumVer2, NumTri2);
+				dist[0] = Distance(rb, TmpVertex, destBuff, dest_Coeff, src_Coeff, m2);
 				pRotate[direct](CamVertex, angle, TmpVertex, CamNumVer);
-				dist[2] = Distance(TmpVertex, destBuff, dest_Coeff, src_Coeff, vertex2, triangle2, NumVer2, NumTri2);
+				dist[2] = Distance(rb, TmpVertex, destBuff, dest_Coeff, src_Coeff, m2);
 
 				if( dist[0] < dist[1] && dist[0] < dist[2])
 				{	
@@ -133,7 +136,7 @@ double Refine(double src_Coeff[CAMNUM][ART_ANGULAR][ART_RADIAL],
 	//SaveMergeObj(filename, vertex1, triangle1, NumVer1, NumTri1, vertex2, triangle2, NumVer2, NumTri2);
 						pRotate[direct](CamVertex, -angle, CamVertex, CamNumVer);
 						pRotate[direct](CamVertex, -angle, TmpVertex, CamNumVer);
-						dist[1] = Distance(TmpVertex, destBuff, dest_Coeff, src_Coeff, vertex2, triangle2, NumVer2, NumTri2);
+						dist[1] = Distance(rb, TmpVertex, destBuff, dest_Coeff, src_Coeff, m2);
 					}while( dist[1] < dist[0] );
 					dist[1] = dist[0];
 				}
@@ -153,7 +156,7 @@ double Refine(double src_Coeff[CAMNUM][ART_ANGULAR][ART_RADIAL],
 	//SaveMergeObj(filename, vertex1, triangle1, NumVer1, NumTri1, vertex2, triangle2, NumVer2, NumTri2);
 						pRotate[direct](CamVertex, angle, CamVertex, CamNumVer);
 						pRotate[direct](CamVertex, angle, TmpVertex, CamNumVer);
-						dist[1] = Distance(TmpVertex, destBuff, dest_Coeff, src_Coeff, vertex2, triangle2, NumVer2, NumTri2);
+						dist[1] = Distance(rb, TmpVertex, destBuff, dest_Coeff, src_Coeff, m2);
 					}while( dist[1] < dist[2] );
 					dist[1] = dist[2];
 				}
@@ -169,8 +172,9 @@ double Refine(double src_Coeff[CAMNUM][ART_ANGULAR][ART_RADIAL],
 	e2[1].x = CamVertex[1].coor[0];
 	e2[1].y = CamVertex[1].coor[1];
 	e2[1].z = CamVertex[1].coor[2];
+	UnloadMesh(rb);
 	RotateMatrix(matrix, e1, e2);
-	Rotate(vertex2, NumVer2, matrix);
+	RotateMesh(m2, matrix);
 
 	for(i=0; i<4; i++)
 		free(matrix[i]);
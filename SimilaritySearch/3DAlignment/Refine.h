@@ -1,3 +1,3 @@
 double Refine(double src_Coeff[CAMNUM][ART_ANGULAR][ART_RADIAL],
-			  pVer vertex2, pTri triangle2, int NumVer2, int NumTri2, int UseCam,
-			  pVer CamVertex, pTri CamTriangle, int CamNumVer, int CamNumTri);
+			  pMesh m2, int UseCam,
+			  pVer CamVertex, pTri CamTriangle, int CamNumVer, int CamNumTri, pRenderBackend rb, char *srcfn, char *destfn);
@@ -2,18 +2,40 @@
 #include <memory.h>
 #include "ds.h"
 
+// SIMD for summation of basis function, the result is the same with the scalar one
+// the ReleaseAVX2 configuration builds the AVX2 one (/arch:AVX2 /fp:precise)
+#if defined(__AVX2__)
+	#include <immintrin.h>
+	#define ART_AVX2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+	#include <arm_neon.h>
+	#define ART_NEON
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define ART_SSE2
+#endif
+
+// the compiler must not fuse a multiply and an add, the rounding of fused multiply-add is not the one of the scalar
+#if defined(_MSC_VER)
+	#pragma fp_contract (off)
+#elif defined(__clang__)
+	#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+	#pragma GCC optimize ("fp-contract=off")
+#endif
+
 // extract feature:
 	// Initial call                     : GenerateBasisLUT()
-	// then			                    : FindRadius()
+	// then			                    : FindRadius() from GetSilStats() of all silhouettes
 	// then for each silhouette         : ExtractCoefficients()
+	// (or ExtractCoefficientsSpan() for spans of silhouette)
 // compare:
 	// call                             : GetDistance()
 
-static double	m_pBasisR[ART_ANGULAR][ART_RADIAL][ART_LUT_SIZE][ART_LUT_SIZE];	// real-value of RegionShape basis function
-static double	m_pBasisI[ART_ANGULAR][ART_RADIAL][ART_LUT_SIZE][ART_LUT_SIZE];	// imaginary-value of RegionShape basis function
-
-double			m_radius;
-double			r_radius;
+// all basis functions of a LUT point are together, real-value of p*ART_RADIAL+r first, and then imaginary-value
+// so the 4 points of bilinear interpolation are 2 pairs of contiguous ART_BASIS_NUM*2 floats
+// one more row and column of zero, the farthest point of a silhouette is at ART_LUT_SIZE-1 exactly, and reads ix+1 or iy+1
+static float	m_pBasis[ART_LUT_SIZE+1][ART_LUT_SIZE+1][ART_BASIS_NUM*2];		// [y][x]
 
 /*
 double GetReal(int p, int r, double dx, double dy)
@@ -45,14 +67,126 @@ double GetImg(int p, int r, double dx, double dy)
 }
 */
 
-LFD_API void ExtractCoefficients(unsigned char *Y, double m_Coeff[ART_ANGULAR][ART_RADIAL], unsigned char *Edge, double CenX, double CenY)
+// add bilinear interpolation of all basis function at (tx, ty) to Sum[ART_BASIS_NUM*2]
+static __inline void AccumulateBasis(float *Sum, double tx, double ty)
+{
+	int				ix, iy, k;
+	float			dx, dy, w00, w10, w01, w11;
+	float			*b00, *b10, *b01, *b11;
+#if defined(ART_AVX2)
+	__m256			v00, v10, v01, v11, t;
+#elif defined(ART_NEON)
+	float32x4_t		v00, v10, v01, v11, t;
+#elif defined(ART_SSE2)
+	__m128			v00, v10, v01, v11, t;
+#endif
+
+	ix = (int)tx;
+	iy = (int)ty;
+	dx = (float)(tx - ix);
+	dy = (float)(ty - iy);
+	w00 = (1 - dx) * (1 - dy);
+	w10 = dx * (1 - dy);
+	w01 = (1 - dx) * dy;
+	w11 = dx * dy;
+	b00 = m_pBasis[iy][ix];
+	b10 = m_pBasis[iy][ix+1];
+	b01 = m_pBasis[iy+1][ix];
+	b11 = m_pBasis[iy+1][ix+1];
+
+#if defined(ART_AVX2)
+	v00 = _mm256_set1_ps(w00);	v10 = _mm256_set1_ps(w10);	v01 = _mm256_set1_ps(w01);	v11 = _mm256_set1_ps(w11);
+	for(k=0; k<ART_BASIS_NUM*2; k+=8)
+	{
+		t = _mm256_mul_ps(v00, _mm256_loadu_ps(b00+k));
+		t = _mm256_add_ps(t, _mm256_mul_ps(v10, _mm256_loadu_ps(b10+k)));
+		t = _mm256_add_ps(t, _mm256_mul_ps(v01, _mm256_loadu_ps(b01+k)));
+		t = _mm256_add_ps(t, _mm256_mul_ps(v11, _mm256_loadu_ps(b11+k)));
+		_mm256_storeu_ps(Sum+k, _mm256_add_ps(_mm256_loadu_ps(Sum+k), t));
+	}
+#elif defined(ART_NEON)
+	v00 = vdupq_n_f32(w00);	v10 = vdupq_n_f32(w10);	v01 = vdupq_n_f32(w01);	v11 = vdupq_n_f32(w11);
+	for(k=0; k<ART_BASIS_NUM*2; k+=4)
+	{
+		t = vmulq_f32(v00, vld1q_f32(b00+k));
+		t = vaddq_f32(t, vmulq_f32(v10, vld1q_f32(b10+k)));
+		t = vaddq_f32(t, vmulq_f32(v01, vld1q_f32(b01+k)));
+		t = vaddq_f32(t, vmulq_f32(v11, vld1q_f32(b11+k)));
+		vst1q_f32(Sum+k, vaddq_f32(vld1q_f32(Sum+k), t));
+	}
+#elif defined(ART_SSE2)
+	v00 = _mm_set1_ps(w00);	v10 = _mm_set1_ps(w10);	v01 = _mm_set1_ps(w01);	v11 = _mm_set1_ps(w11);
+	for(k=0; k<ART_BASIS_NUM*2; k+=4)
+	{
+		t = _mm_mul_ps(v00, _mm_loadu_ps(b00+k));
+		t = _mm_add_ps(t, _mm_mul_ps(v10, _mm_loadu_ps(b10+k)));
+		t = _mm_add_ps(t, _mm_mul_ps(v01, _mm_loadu_ps(b01+k)));
+		t = _mm_add_ps(t, _mm_mul_ps(v11, _mm_loadu_ps(b11+k)));
+		_mm_storeu_ps(Sum+k, _mm_add_ps(_mm_loadu_ps(Sum+k), t));
+	}
+#else
+	for(k=0; k<ART_BASIS_NUM*2; k++)
+		Sum[k] += w00 * b00[k] + w10 * b10[k] + w01 * b01[k] + w11 * b11[k];
+#endif
+}
+
+// float summation of a row is added to double, to keep the precision of a whole image
+static void FlushRowSum(float *Sum, double m_pCoeffR[ART_ANGULAR][ART_RADIAL], double m_pCoeffI[ART_ANGULAR][ART_RADIAL])
 {
-	int				x, y, ix, iy;
 	int				p, r;
-	double			dx, dy, tx, ty, x1, x2;
+
+	for(p=0 ; p<ART_ANGULAR ; p++)
+	for(r=0 ; r<ART_RADIAL ; r++)
+	{
+		m_pCoeffR[p][r] += Sum[p*ART_RADIAL+r];
+		m_pCoeffI[p][r] -= Sum[ART_BASIS_NUM+p*ART_RADIAL+r];
+	}
+	memset(Sum, 0, ART_BASIS_NUM * 2 * sizeof(float));
+}
+
+// magnitude of the summation, and normalized by m_Coeff[0][0]
+static void NormalizeCoefficients(double m_Coeff[ART_ANGULAR][ART_RADIAL], double m_pCoeffR[ART_ANGULAR][ART_RADIAL],
+								  double m_pCoeffI[ART_ANGULAR][ART_RADIAL], int count)
+{
+	int				p, r;
+
+	// if the 3D model is flat, some camera will render nothing, so count=0 in this case
+	if( count > 0 )
+	{
+		for(p=0 ; p<ART_ANGULAR ; p++)
+		for(r=0 ; r<ART_RADIAL ; r++)
+			m_Coeff[p][r] = HYPOT( m_pCoeffR[p][r]/count, m_pCoeffI[p][r]/count );
+
+		// normalization
+		for(p=0 ; p<ART_ANGULAR ; p++)
+		for(r=0 ; r<ART_RADIAL ; r++)
+			m_Coeff[p][r] /= m_Coeff[0][0];
+			
+	}
+	else
+	{
+		// if didn't add this, the result will also be saved as 0
+		for(p=0 ; p<ART_ANGULAR ; p++)
+		for(r=0 ; r<ART_RADIAL ; r++)
+			m_Coeff[p][r] = 0.0;
+		// use a line to test the number to approximate
+/*		for(p=0 ; p<ART_ANGULAR ; p++)
+		for(r=0 ; r<ART_RADIAL ; r++)
+			m_Coeff[p][r] = 0.010256410;
+		for(p=0 ; p<ART_ANGULAR ; p+=2)
+			m_Coeff[p][0] = 0.980129780;*/
+	}
+}
+
+// only the bounding box of the silhouette is visited
+LFD_API void ExtractCoefficients(unsigned char *Y, double m_Coeff[ART_ANGULAR][ART_RADIAL], unsigned char *Edge, pSilStats st)
+{
+	int				x, y;
+	double			dx, dy, tx, ty;
 	int				count;
 	double			m_pCoeffR[ART_ANGULAR][ART_RADIAL];
 	double			m_pCoeffI[ART_ANGULAR][ART_RADIAL];
+	float			RowSum[ART_BASIS_NUM*2];
 //	double			norm;
 
 	unsigned char *pImage;
@@ -60,6 +194,7 @@ LFD_API void ExtractCoefficients(unsigned char *Y, double m_Coeff[ART_ANGULAR][A
 
 	memset(m_pCoeffR, 0, ART_ANGULAR * ART_RADIAL * sizeof(double) );
 	memset(m_pCoeffI, 0, ART_ANGULAR * ART_RADIAL * sizeof(double) );
+	memset(RowSum, 0, ART_BASIS_NUM * 2 * sizeof(float) );
 //	for(p=0 ; p<ART_ANGULAR ; p++)
 //	for(r=0 ; r<ART_RADIAL ; r++)
 //	{
@@ -68,10 +203,9 @@ LFD_API void ExtractCoefficients(unsigned char *Y, double m_Coeff[ART_ANGULAR][A
 //	}
 
 	count = 0;
-	pImage = Y;
 //	pEdge = Edge;
-	for (y=0 ; y<HEIGHT ; y++)
-	for (x=0 ; x<WIDTH; x++)
+	for (y=st->MinY ; y<=st->MaxY ; y++)
+	for (x=st->MinX, pImage=Y+y*WIDTH+x ; x<=st->MaxX; x++)
 	{
 //		if( *pImage < 127 )
 		if( *pImage < 255 )
@@ -95,98 +229,80 @@ LFD_API void ExtractCoefficients(unsigned char *Y, double m_Coeff[ART_ANGULAR][A
 			// map image coordinate (x,y) to basis function coordinate (tx,ty)
 //			dx = x - CENTER_X;
 //			dy = y - CENTER_Y;
-			dx = x - CenX;
-			dy = y - CenY;
-			tx = dx * r_radius + ART_LUT_RADIUS;
-			ty = dy * r_radius + ART_LUT_RADIUS;
-			ix = (int)tx;
-			iy = (int)ty;
-			dx = tx - ix;
-			dy = ty - iy;
+			dx = x - st->CenX;
+			dy = y - st->CenY;
+			tx = dx * st->ArtScale + ART_LUT_RADIUS;
+			ty = dy * st->ArtScale + ART_LUT_RADIUS;
 
 			// summation of basis function
 //			if(tx >= 0 && tx < ART_LUT_SIZE && ty >= 0 && ty < ART_LUT_SIZE)
-			for(p=0 ; p<ART_ANGULAR ; p++)
-			for(r=0 ; r<ART_RADIAL ; r++)
-			{
-				// GetReal (if call function, the speed will be very slow)
-				// m_pCoeffR[p][r] += GetReal(p, r, tx, ty);
-				x1 = m_pBasisR[p][r][ix][iy] + (m_pBasisR[p][r][ix+1][iy]-m_pBasisR[p][r][ix][iy]) * dx;
-				x2 = m_pBasisR[p][r][ix][iy+1] + (m_pBasisR[p][r][ix+1][iy+1]-m_pBasisR[p][r][ix][iy+1]) * dx;
-//				m_pCoeffR[p][r] += norm * (x1 + (x2-x1) * dy);
-				m_pCoeffR[p][r] += (x1 + (x2-x1) * dy);
-
-				// GetImg (if call function, the speed will be very slow)
-				// m_pCoeffI[p][r] -= GetImg(p, r, tx, ty);
-				x1 = m_pBasisI[p][r][ix][iy] + (m_pBasisI[p][r][ix+1][iy]-m_pBasisI[p][r][ix][iy]) * dx;
-				x2 = m_pBasisI[p][r][ix][iy+1] + (m_pBasisI[p][r][ix+1][iy+1]-m_pBasisI[p][r][ix][iy+1]) * dx;
-//				m_pCoeffI[p][r] -= norm * (x1 + (x2-x1) * dy);
-				m_pCoeffI[p][r] -= (x1 + (x2-x1) * dy);
-			}
+			AccumulateBasis(RowSum, tx, ty);
 
 			count ++;		// how many pixels
 		}
 		pImage++;
 //		pEdge++;
+		if( x == st->MaxX )		// end of a row
+			FlushRowSum(RowSum, m_pCoeffR, m_pCoeffI);
 	}
 
-	// if the 3D model is flat, some camera will render nothing, so count=0 in this case
-	if( count > 0 )
-	{
-		for(p=0 ; p<ART_ANGULAR ; p++)
-		for(r=0 ; r<ART_RADIAL ; r++)
-			m_Coeff[p][r] = HYPOT( m_pCoeffR[p][r]/count, m_pCoeffI[p][r]/count );
+	NormalizeCoefficients(m_Coeff, m_pCoeffR, m_pCoeffI, count);
+}
 
-		// normalization
-		for(p=0 ; p<ART_ANGULAR ; p++)
-		for(r=0 ; r<ART_RADIAL ; r++)
-			m_Coeff[p][r] /= m_Coeff[0][0];
-			
-	}
-	else
+// the same with ExtractCoefficients(), but only visit the pixels of the spans (GetSpans() or GetSpansMask())
+LFD_API void ExtractCoefficientsSpan(pSilSpans sp, double m_Coeff[ART_ANGULAR][ART_RADIAL], pSilStats st)
+{
+	int					x, y, i;
+	double				dx, dy, tx, ty;
+	int					count;
+	double				m_pCoeffR[ART_ANGULAR][ART_RADIAL];
+	double				m_pCoeffI[ART_ANGULAR][ART_RADIAL];
+	float				RowSum[ART_BASIS_NUM*2];
+
+	memset(m_pCoeffR, 0, ART_ANGULAR * ART_RADIAL * sizeof(double) );
+	memset(m_pCoeffI, 0, ART_ANGULAR * ART_RADIAL * sizeof(double) );
+	memset(RowSum, 0, ART_BASIS_NUM * 2 * sizeof(float) );
+
+	count = 0;
+	for (y=st->MinY ; y<=st->MaxY ; y++)
 	{
-		// if didn't add this, the result will also be saved as 0
-		for(p=0 ; p<ART_ANGULAR ; p++)
-		for(r=0 ; r<ART_RADIAL ; r++)
-			m_Coeff[p][r] = 0.0;
-		// use a line to test the number to approximate
-/*		for(p=0 ; p<ART_ANGULAR ; p++)
-		for(r=0 ; r<ART_RADIAL ; r++)
-			m_Coeff[p][r] = 0.010256410;
-		for(p=0 ; p<ART_ANGULAR ; p+=2)
-			m_Coeff[p][0] = 0.980129780;*/
+		// map image coordinate (x,y) to basis function coordinate (tx,ty)
+		dy = y - st->CenY;
+		ty = dy * st->ArtScale + ART_LUT_RADIUS;
+		for (i=sp->RowStart[y] ; i<sp->RowStart[y+1] ; i++)
+		{
+			for (x=sp->x0[i] ; x<=sp->x1[i] ; x++)
+			{
+				dx = x - st->CenX;
+				tx = dx * st->ArtScale + ART_LUT_RADIUS;
+
+				// summation of basis function
+				AccumulateBasis(RowSum, tx, ty);
+			}
+			count += sp->x1[i] - sp->x0[i] + 1;		// how many pixels
+		}
+		FlushRowSum(RowSum, m_pCoeffR, m_pCoeffI);
 	}
+
+	NormalizeCoefficients(m_Coeff, m_pCoeffR, m_pCoeffI, count);
 }
 
-// speed up this function later
-LFD_API void FindRadius(unsigned char *Y[CAMNUM], double *CenX, double *CenY)
+// the max radius of all silhouettes, from GetSilStats()
+// the scale to the basis function is saved to each of them, so that nothing is shared between models
+LFD_API void FindRadius(SilStats Stats[CAMNUM])
 {
-	int				x, y;
-	double			temp_radius;
-	unsigned char	*pImage;
+	double			MaxR2, m_radius;
 	int				i;
 
 	// Find maximum radius from center of mass
-	m_radius = 0;
+	MaxR2 = 0;
 	for(i=0; i<CAMNUM; i++)
-	{
-		pImage = Y[i];
-		for(y=0 ; y<HEIGHT; y++)
-			for(x=0 ; x<WIDTH ; x++)
-			{
-//				if( *pImage < 127 )
-				if( *pImage < 255 )
-				{
-//					temp_radius = HYPOT(x - CENTER_X, y - CENTER_Y);
-					temp_radius = HYPOT(x - CenX[i], y - CenY[i]);
-					if(temp_radius > m_radius)
-						m_radius = temp_radius;
-				}
-				pImage++;
-			}
-	}
+		if( Stats[i].MaxR2 > MaxR2 )
+			MaxR2 = Stats[i].MaxR2;
+	m_radius = sqrt(MaxR2);
 
-	r_radius = ART_LUT_RADIUS / m_radius;
+	for(i=0; i<CAMNUM; i++)
+		Stats[i].ArtScale = ART_LUT_RADIUS / m_radius;
 }
 
 LFD_API void GenerateBasisLUT()
@@ -197,8 +313,8 @@ LFD_API void GenerateBasisLUT()
 
 	maxradius = ART_LUT_RADIUS;
 
-	for(y=0 ; y<ART_LUT_SIZE ; y++)
-	for(x=0 ; x<ART_LUT_SIZE ; x++)
+	for(y=0 ; y<ART_LUT_SIZE+1 ; y++)
+	for(x=0 ; x<ART_LUT_SIZE+1 ; x++)
 	{
 		radius = HYPOT(x-maxradius, y-maxradius);
 		if(radius < maxradius)
@@ -209,19 +325,12 @@ LFD_API void GenerateBasisLUT()
 			for(r=0 ; r<ART_RADIAL ; r++)
 			{
 				temp = cos(radius*PI*r/maxradius);
-				m_pBasisR[p][r][x][y] = temp*cos(angle*p);
-				m_pBasisI[p][r][x][y] = temp*sin(angle*p);
+				m_pBasis[y][x][p*ART_RADIAL+r] = (float)(temp*cos(angle*p));
+				m_pBasis[y][x][ART_BASIS_NUM+p*ART_RADIAL+r] = (float)(temp*sin(angle*p));
 			}
 		}
 		else
-		{
-			for(p=0 ; p<ART_ANGULAR ; p++)
-			for(r=0 ; r<ART_RADIAL ; r++)
-			{
-				m_pBasisR[p][r][x][y] = 0;
-				m_pBasisI[p][r][x][y] = 0;
-			}
-		}
+			memset(m_pBasis[y][x], 0, ART_BASIS_NUM * 2 * sizeof(float));
 	}
 }
 
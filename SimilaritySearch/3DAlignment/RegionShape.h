@@ -1,4 +1,5 @@
 LFD_API void GenerateBasisLUT();
-LFD_API void ExtractCoefficients(unsigned char *Y, double m_Coeff[ART_ANGULAR][ART_RADIAL], unsigned char *Edge, double CenX, double CenY);
-LFD_API void FindRadius(unsigned char *Y[CAMNUM], double *CenX, double *CenY);
+LFD_API void ExtractCoefficients(unsigned char *Y, double m_Coeff[ART_ANGULAR][ART_RADIAL], unsigned char *Edge, pSilStats st);
+LFD_API void FindRadius(SilStats Stats[CAMNUM]);
+LFD_API void ExtractCoefficientsSpan(pSilSpans sp, double m_Coeff[ART_ANGULAR][ART_RADIAL], pSilStats st);
 double GetDistance(double m_Coeff1[ART_ANGULAR][ART_RADIAL], double m_Coeff2[ART_ANGULAR][ART_RADIAL]);
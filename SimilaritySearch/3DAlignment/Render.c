@@ -0,0 +1,681 @@
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+#include <gl/glut.h>
+#include <gl/gl.h>
+#include <gl/glu.h>
+
+#include <stdio.h>
+#include <malloc.h>
+#include <memory.h>
+
+#include "ds.h"
+#include "Rasterize.h"
+#include "BitMask.h"
+#include "Mesh.h"
+
+// render backends of the silhouette, all of them use the same camera
+//		glOrtho(-1, 1, -1, 1, 0.0, 2.0);
+//		glViewport(0, 0, WIDTH, HEIGHT);
+//		gluLookAt(CamVertex, 0, 0, 0, 0, 1, 0);
+// RENDER_GLUT		legacy OpenGL window, only one can be created
+// RENDER_FBO		offscreen OpenGL without window, each thread can use its own backend
+// RENDER_SOFT		software rasterizer (Rasterize.c), each thread can use its own backend
+
+// the GLUT window redraw the mesh of this backend
+static pRenderBackend	GlutBackend = NULL;
+
+// vertex interleaved for the vertex array, and continuous triangles of the same material are a run
+static void BuildRuns(RenderMesh *rm, pMesh m)
+{
+	int				i, mat;
+	double			*c;
+
+	rm->m = m;
+
+	rm->coor = (float *) malloc ((m->NumVer ? 3 * m->NumVer : 3) * sizeof(float));
+	for(i=0; i<m->NumVer; i++)
+	{
+		rm->coor[3*i] = m->x[i];
+		rm->coor[3*i+1] = m->y[i];
+		rm->coor[3*i+2] = m->z[i];
+	}
+
+	rm->RunStart = (int *) malloc ((m->NumTri + 1) * sizeof(int));
+	rm->RunColor = (float *) malloc ((m->NumTri ? 3 * m->NumTri : 3) * sizeof(float));
+	rm->NumRun = 0;
+	for(i=0; i<m->NumTri; i++)
+	{
+		mat = m->Material ? m->Material[i] : 0;
+		if( i == 0 || mat != (m->Material ? m->Material[i-1] : 0) )
+		{
+			c = m->Color + 3 * mat;
+			rm->RunStart[rm->NumRun] = i;
+			rm->RunColor[3*rm->NumRun] = (float)c[0];
+			rm->RunColor[3*rm->NumRun+1] = (float)c[1];
+			rm->RunColor[3*rm->NumRun+2] = (float)c[2];
+			rm->NumRun ++;
+		}
+	}
+	rm->RunStart[rm->NumRun] = m->NumTri;
+}
+
+// free the arrays of the loaded mesh, and the mesh itself if it is converted by LoadMesh()
+static void FreeRuns(RenderMesh *rm)
+{
+	if( rm->coor )			free(rm->coor);
+	if( rm->RunStart )		free(rm->RunStart);
+	if( rm->RunColor )		free(rm->RunColor);
+	if( rm->OwnMesh )
+		FreeMesh(rm->m);
+	memset(rm, 0, sizeof(RenderMesh));
+}
+
+// ************************************************************************************************
+// OpenGL context of RENDER_FBO, WGL of a hidden window (EGL without surface if not Windows)
+
+// EXT_framebuffer_object, the OpenGL 1.1 headers of Windows have no framebuffer object
+#define	FBO_FRAMEBUFFER				0x8D40
+#define	FBO_RENDERBUFFER			0x8D41
+#define	FBO_COLOR_ATTACHMENT0		0x8CE0
+#define	FBO_DEPTH_ATTACHMENT		0x8D00
+#define	FBO_COMPLETE				0x8CD5
+#define	FBO_DEPTH_COMPONENT24		0x81A6
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+typedef void	(APIENTRY *FboGenFunc)(GLsizei n, GLuint *id);
+typedef void	(APIENTRY *FboDeleteFunc)(GLsizei n, const GLuint *id);
+typedef void	(APIENTRY *FboBindFunc)(GLenum target, GLuint id);
+typedef void	(APIENTRY *FboStorageFunc)(GLenum target, GLenum format, GLsizei width, GLsizei height);
+typedef void	(APIENTRY *FboAttachFunc)(GLenum target, GLenum attachment, GLenum RenderTarget, GLuint id);
+typedef GLenum	(APIENTRY *FboStatusFunc)(GLenum target);
+
+static FboGenFunc		FboGenFramebuffers, FboGenRenderbuffers;
+static FboDeleteFunc	FboDeleteFramebuffers, FboDeleteRenderbuffers;
+static FboBindFunc		FboBindFramebuffer, FboBindRenderbuffer;
+static FboStorageFunc	FboRenderbufferStorage;
+static FboAttachFunc	FboAttachRenderbuffer;
+static FboStatusFunc	FboCheckStatus;
+
+#ifdef _WIN32
+static void FboFreeContext(pRenderBackend rb)
+{
+	if( rb->ctx )
+	{
+		if( wglGetCurrentContext() == (HGLRC)rb->ctx )
+			wglMakeCurrent(NULL, NULL);
+		wglDeleteContext((HGLRC)rb->ctx);
+	}
+	if( rb->dc )
+		ReleaseDC((HWND)rb->wnd, (HDC)rb->dc);
+	if( rb->wnd )
+		DestroyWindow((HWND)rb->wnd);
+}
+
+// a window is needed for the pixel format of the context only, it is never shown
+static int FboCreateContext(pRenderBackend rb)
+{
+	static PIXELFORMATDESCRIPTOR	pfd = { sizeof(PIXELFORMATDESCRIPTOR), 1, PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL, PFD_TYPE_RGBA, 24 };
+	WNDCLASSA		wc;
+	int				pf;
+
+	// the class is registered by the first backend, and fails for the others
+	memset(&wc, 0, sizeof(WNDCLASSA));
+	wc.lpfnWndProc = DefWindowProcA;
+	wc.hInstance = GetModuleHandleA(NULL);
+	wc.lpszClassName = "LfdFbo";
+	RegisterClassA(&wc);
+
+	rb->wnd = CreateWindowA("LfdFbo", "LfdFbo", WS_POPUP, 0, 0, 1, 1, NULL, NULL, wc.hInstance, NULL);
+	if( rb->wnd == NULL )
+		return 0;
+	rb->dc = GetDC((HWND)rb->wnd);
+	pf = ChoosePixelFormat((HDC)rb->dc, &pfd);
+	if( pf == 0 || !SetPixelFormat((HDC)rb->dc, pf, &pfd) )
+		return 0;
+	rb->ctx = wglCreateContext((HDC)rb->dc);
+	return rb->ctx && wglMakeCurrent((HDC)rb->dc, (HGLRC)rb->ctx);
+}
+
+// the context may be used by another thread before
+static void FboMakeCurrent(pRenderBackend rb)
+{
+	if( wglGetCurrentContext() != (HGLRC)rb->ctx )
+		wglMakeCurrent((HDC)rb->dc, (HGLRC)rb->ctx);
+}
+
+#define FboGetProc(name)	wglGetProcAddress(name)
+#else
+static void FboFreeContext(pRenderBackend rb)
+{
+	if( rb->ctx )
+	{
+		if( eglGetCurrentContext() == (EGLContext)rb->ctx )
+			eglMakeCurrent((EGLDisplay)rb->dc, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		eglDestroyContext((EGLDisplay)rb->dc, (EGLContext)rb->ctx);
+	}
+}
+
+// the framebuffer object is drawn without surface, so the context has no config (EGL_KHR_no_config_context)
+// and the display needs no window system (EGL_MESA_platform_surfaceless) if there is one
+static int FboCreateContext(pRenderBackend rb)
+{
+	PFNEGLGETPLATFORMDISPLAYEXTPROC		GetPlatformDisplay;
+
+	GetPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+	rb->dc = GetPlatformDisplay ? GetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL) : EGL_NO_DISPLAY;
+	if( rb->dc == EGL_NO_DISPLAY || !eglInitialize((EGLDisplay)rb->dc, NULL, NULL) )
+	{
+		rb->dc = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		if( rb->dc == EGL_NO_DISPLAY || !eglInitialize((EGLDisplay)rb->dc, NULL, NULL) )
+			return 0;
+	}
+	if( !eglBindAPI(EGL_OPENGL_API) )
+		return 0;
+	rb->ctx = eglCreateContext((EGLDisplay)rb->dc, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, NULL);
+	if( rb->ctx == EGL_NO_CONTEXT )
+	{
+		rb->ctx = NULL;
+		return 0;
+	}
+	return eglMakeCurrent((EGLDisplay)rb->dc, EGL_NO_SURFACE, EGL_NO_SURFACE, (EGLContext)rb->ctx);
+}
+
+// the context may be used by another thread before
+static void FboMakeCurrent(pRenderBackend rb)
+{
+	if( eglGetCurrentContext() != (EGLContext)rb->ctx )
+		eglMakeCurrent((EGLDisplay)rb->dc, EGL_NO_SURFACE, EGL_NO_SURFACE, (EGLContext)rb->ctx);
+}
+
+#define FboGetProc(name)	eglGetProcAddress(name)
+#endif
+
+// the entry points are got with a current context
+static int FboLoadProc()
+{
+	FboGenFramebuffers = (FboGenFunc) FboGetProc("glGenFramebuffersEXT");
+	FboGenRenderbuffers = (FboGenFunc) FboGetProc("glGenRenderbuffersEXT");
+	FboDeleteFramebuffers = (FboDeleteFunc) FboGetProc("glDeleteFramebuffersEXT");
+	FboDeleteRenderbuffers = (FboDeleteFunc) FboGetProc("glDeleteRenderbuffersEXT");
+	FboBindFramebuffer = (FboBindFunc) FboGetProc("glBindFramebufferEXT");
+	FboBindRenderbuffer = (FboBindFunc) FboGetProc("glBindRenderbufferEXT");
+	FboRenderbufferStorage = (FboStorageFunc) FboGetProc("glRenderbufferStorageEXT");
+	FboAttachRenderbuffer = (FboAttachFunc) FboGetProc("glFramebufferRenderbufferEXT");
+	FboCheckStatus = (FboStatusFunc) FboGetProc("glCheckFramebufferStatusEXT");
+
+	return FboGenFramebuffers && FboGenRenderbuffers && FboDeleteFramebuffers && FboDeleteRenderbuffers &&
+		   FboBindFramebuffer && FboBindRenderbuffer && FboRenderbufferStorage &&
+		   FboAttachRenderbuffer && FboCheckStatus;
+}
+
+// ************************************************************************************************
+// OpenGL, used by GLUT and the framebuffer object
+
+static void GLProjection()
+{
+	glMatrixMode (GL_PROJECTION);
+	glLoadIdentity ();
+	glOrtho(-1, 1, -1, 1, 0.0, 2.0);
+	glViewport (0, 0, (GLsizei) WIDTH, (GLsizei) HEIGHT);
+
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+	gluLookAt(1,0,0,0,0,0,0,1,0);
+}
+
+static void GLInit()
+{
+	glClearColor (1.0, 1.0, 1.0, 0.0);
+	glClearDepth(1.0);
+	glEnable(GL_DEPTH_TEST);
+	GLProjection();
+}
+
+// the context of a framebuffer object may be used by another thread before
+static void GLMakeCurrent(pRenderBackend rb)
+{
+	if( rb->type == RENDER_FBO )
+		FboMakeCurrent(rb);
+}
+
+static void GLSetCamera(pRenderBackend rb, pVer CamVertex)
+{
+	GLMakeCurrent(rb);
+	rb->CamVertex = CamVertex;
+
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+	gluLookAt(CamVertex->coor[0], CamVertex->coor[1], CamVertex->coor[2],
+				0, 0, 0,
+				0, 1, 0);
+}
+
+// vertex and index array of the loaded mesh, one glDrawElements() for each color
+static void GLDrawArray(RenderMesh *rm)
+{
+	int				i;
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, rm->coor);
+	for(i=0; i<rm->NumRun; i++)
+	{
+		glColor3fv(rm->RunColor + 3 * i);
+		glDrawElements(GL_TRIANGLES, 3 * (rm->RunStart[i+1] - rm->RunStart[i]), GL_UNSIGNED_INT, rm->m->index + 3 * rm->RunStart[i]);
+	}
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+static void GLDrawLoaded(RenderMesh *rm)
+{
+	if( rm->list )
+		glCallList(rm->list);
+	else
+		GLDrawArray(rm);
+}
+
+// a mesh not loaded is sent vertex by vertex
+static void GLDrawImmediate(pMesh m)
+{
+	int				i, k, mat;
+	unsigned int	vi;
+	double			*c;
+
+	glBegin(GL_TRIANGLES);
+	for(i=0, mat=-1; i<m->NumTri; i++)
+	{
+		if( mat != (m->Material ? m->Material[i] : 0) )
+		{
+			mat = m->Material ? m->Material[i] : 0;
+			c = m->Color + 3 * mat;
+			glColor3f((GLfloat)c[0], (GLfloat)c[1], (GLfloat)c[2]);
+		}
+		for(k=0; k<3; k++)
+		{
+			vi = m->index[3*i+k];
+			glVertex3f(m->x[vi], m->y[vi], m->z[vi]);
+		}
+	}
+	glEnd();
+}
+
+static void GLDrawMesh(pRenderBackend rb, pMesh m)
+{
+	GLMakeCurrent(rb);
+	rb->m = m;
+
+	glClear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	glPushMatrix();
+	if( m && m == rb->mesh.m )
+		GLDrawLoaded(&rb->mesh);
+	else if( m )
+		GLDrawImmediate(m);
+	glPopMatrix();
+
+	if( rb->type == RENDER_GLUT )
+		glutSwapBuffers();
+}
+
+static void GLUnloadMesh(pRenderBackend rb)
+{
+	RenderMesh		*rm = &rb->mesh;
+
+	if( rm->m == NULL )
+		return;
+
+	GLMakeCurrent(rb);
+	if( rm->list )
+		glDeleteLists(rm->list, 1);
+	FreeRuns(rm);
+}
+
+// the mesh must not be changed until UnloadMesh()
+// OpenGL 1.1 has no buffer object, so the arrays are compiled to a display list, which is kept by the driver
+static void GLLoadMesh(pRenderBackend rb, pMesh m)
+{
+	RenderMesh		*rm = &rb->mesh;
+
+	GLUnloadMesh(rb);
+	BuildRuns(rm, m);
+
+	GLMakeCurrent(rb);
+	rm->list = glGenLists(1);
+	if( rm->list )
+	{
+		// client state of vertex array is not compiled to the list
+		glNewList(rm->list, GL_COMPILE);
+			GLDrawArray(rm);
+		glEndList();
+	}
+}
+
+static void GLReadDepth(pRenderBackend rb, unsigned char *bmBits)
+{
+	if( rb->type == RENDER_GLUT )
+		glReadBuffer(GL_BACK);
+	glReadPixels(0, 0, WIDTH, HEIGHT, GL_DEPTH_COMPONENT, GL_UNSIGNED_BYTE, bmBits);
+}
+
+static void GLReadColor(pRenderBackend rb, unsigned char *bmColor)
+{
+	if( rb->type == RENDER_GLUT )
+		glReadBuffer(GL_BACK);
+	glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGB, GL_UNSIGNED_BYTE, bmColor);
+}
+
+static void GLReadMask(pRenderBackend rb, unsigned __int64 *Mask)
+{
+	GLReadDepth(rb, rb->depth);
+	PackMask(Mask, rb->depth);
+}
+
+// ************************************************************************************************
+// GLUT
+
+static void display(void)
+{
+	if( GlutBackend && GlutBackend->m )
+		GLDrawMesh(GlutBackend, GlutBackend->m);
+	else
+	{
+		glClear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glutSwapBuffers();
+	}
+}
+
+static void reshape(int w, int h)
+{
+	GLProjection();
+}
+
+static void GlutFree(pRenderBackend rb)
+{
+	GlutBackend = NULL;
+}
+
+static int GlutCreate(pRenderBackend rb)
+{
+	static int		argc = 1;
+	static char		*argv[] = { "3DAlignment", NULL };
+
+	if( GlutBackend )
+		return 0;		// only one window
+
+	glutInit(&argc, argv);
+	glutInitDisplayMode (GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH);
+	glutInitWindowSize (WIDTH, HEIGHT);
+	glutInitWindowPosition (100, 100);
+	glutCreateWindow (argv[0]);
+	GLInit();
+	glutDisplayFunc(display);
+	glutReshapeFunc(reshape);
+
+	rb->SetCamera = GLSetCamera;
+	rb->DrawMesh = GLDrawMesh;
+	rb->ReadDepth = GLReadDepth;
+	rb->ReadColor = GLReadColor;
+	rb->ReadMask = GLReadMask;
+	rb->LoadMesh = GLLoadMesh;
+	rb->UnloadMesh = GLUnloadMesh;
+	rb->Free = GlutFree;
+	GlutBackend = rb;
+	return 1;
+}
+
+// ************************************************************************************************
+// framebuffer object, the color and depth are render buffers of WIDTH * HEIGHT
+
+static void FboFree(pRenderBackend rb)
+{
+	if( rb->fbo )
+	{
+		FboMakeCurrent(rb);
+		FboBindFramebuffer(FBO_FRAMEBUFFER, 0);
+		FboDeleteFramebuffers(1, &rb->fbo);
+		FboDeleteRenderbuffers(1, &rb->FboColor);
+		FboDeleteRenderbuffers(1, &rb->FboDepth);
+	}
+	FboFreeContext(rb);
+}
+
+static int FboCreate(pRenderBackend rb)
+{
+	if( !FboCreateContext(rb) || !FboLoadProc() )
+	{
+		FboFreeContext(rb);
+		return 0;
+	}
+
+	FboGenRenderbuffers(1, &rb->FboColor);
+	FboBindRenderbuffer(FBO_RENDERBUFFER, rb->FboColor);
+	FboRenderbufferStorage(FBO_RENDERBUFFER, GL_RGBA8, WIDTH, HEIGHT);
+	FboGenRenderbuffers(1, &rb->FboDepth);
+	FboBindRenderbuffer(FBO_RENDERBUFFER, rb->FboDepth);
+	FboRenderbufferStorage(FBO_RENDERBUFFER, FBO_DEPTH_COMPONENT24, WIDTH, HEIGHT);
+
+	FboGenFramebuffers(1, &rb->fbo);
+	FboBindFramebuffer(FBO_FRAMEBUFFER, rb->fbo);
+	FboAttachRenderbuffer(FBO_FRAMEBUFFER, FBO_COLOR_ATTACHMENT0, FBO_RENDERBUFFER, rb->FboColor);
+	FboAttachRenderbuffer(FBO_FRAMEBUFFER, FBO_DEPTH_ATTACHMENT, FBO_RENDERBUFFER, rb->FboDepth);
+	if( FboCheckStatus(FBO_FRAMEBUFFER) != FBO_COMPLETE )
+	{
+		FboFree(rb);
+		return 0;
+	}
+	// the read and draw buffer are of the bound framebuffer object
+	glDrawBuffer(FBO_COLOR_ATTACHMENT0);
+	glReadBuffer(FBO_COLOR_ATTACHMENT0);
+	GLInit();
+
+	rb->SetCamera = GLSetCamera;
+	rb->DrawMesh = GLDrawMesh;
+	rb->ReadDepth = GLReadDepth;
+	rb->ReadColor = GLReadColor;
+	rb->ReadMask = GLReadMask;
+	rb->LoadMesh = GLLoadMesh;
+	rb->UnloadMesh = GLUnloadMesh;
+	rb->Free = FboFree;
+	return 1;
+}
+
+// ************************************************************************************************
+// software rasterizer, draw when read, so that the mask needs no depth
+
+static void SoftSetCamera(pRenderBackend rb, pVer CamVertex)
+{
+	rb->CamVertex = CamVertex;
+	rb->DepthReady = 0;
+}
+
+static void SoftDrawMesh(pRenderBackend rb, pMesh m)
+{
+	rb->m = m;
+	rb->DepthReady = 0;
+}
+
+static void SoftReadColor(pRenderBackend rb, unsigned char *bmColor)
+{
+	RasterizeMeshToMem(rb->ras, rb->depth, bmColor, rb->CamVertex, rb->m);
+	rb->DepthReady = 1;
+}
+
+static void SoftReadDepth(pRenderBackend rb, unsigned char *bmBits)
+{
+	if( rb->DepthReady )
+		memcpy(bmBits, rb->depth, WIDTH * HEIGHT * sizeof(unsigned char));
+	else
+		RasterizeMeshToMem(rb->ras, bmBits, NULL, rb->CamVertex, rb->m);
+}
+
+static void SoftReadMask(pRenderBackend rb, unsigned __int64 *Mask)
+{
+	if( rb->DepthReady )
+		PackMask(Mask, rb->depth);
+	else
+		RasterizeMeshMask(rb->ras, Mask, rb->CamVertex, rb->m);
+}
+
+// the software rasterizer reads the mesh directly, only the mesh is kept
+static void SoftUnloadMesh(pRenderBackend rb)
+{
+	if( rb->mesh.OwnMesh )
+		FreeMesh(rb->mesh.m);
+	memset(&rb->mesh, 0, sizeof(RenderMesh));
+}
+
+static void SoftLoadMesh(pRenderBackend rb, pMesh m)
+{
+	SoftUnloadMesh(rb);
+	rb->mesh.m = m;
+}
+
+static void SoftFree(pRenderBackend rb)
+{
+	FreeRaster(rb->ras);
+}
+
+static int SoftCreate(pRenderBackend rb)
+{
+	rb->ras = CreateRaster();
+
+	rb->SetCamera = SoftSetCamera;
+	rb->DrawMesh = SoftDrawMesh;
+	rb->ReadDepth = SoftReadDepth;
+	rb->ReadColor = SoftReadColor;
+	rb->ReadMask = SoftReadMask;
+	rb->LoadMesh = SoftLoadMesh;
+	rb->UnloadMesh = SoftUnloadMesh;
+	rb->Free = SoftFree;
+	return 1;
+}
+
+// ************************************************************************************************
+
+// return NULL if the backend can't be created
+LFD_API pRenderBackend CreateRenderBackend(int type)
+{
+	pRenderBackend	rb;
+	int				ok;
+
+	rb = (pRenderBackend) malloc (sizeof(RenderBackend));
+	memset(rb, 0, sizeof(RenderBackend));
+	rb->type = type;
+	rb->depth = (unsigned char *) malloc (WIDTH * HEIGHT * sizeof(unsigned char));
+
+	switch( type )
+	{
+	case RENDER_GLUT:
+		ok = GlutCreate(rb);
+		break;
+	case RENDER_FBO:
+		ok = FboCreate(rb);
+		break;
+	case RENDER_SOFT:
+		ok = SoftCreate(rb);
+		break;
+	default:
+		ok = 0;
+		break;
+	}
+
+	if( !ok )
+	{
+		free(rb->depth);
+		free(rb);
+		return NULL;
+	}
+	return rb;
+}
+
+LFD_API void FreeRenderBackend(pRenderBackend rb)
+{
+	if( rb == NULL )
+		return;
+
+	rb->UnloadMesh(rb);
+	rb->Free(rb);
+	free(rb->depth);
+	free(rb);
+}
+
+// render a silhouette to memory, bmColor can be NULL
+LFD_API void RenderViewMesh(pRenderBackend rb, unsigned char *bmBits, unsigned char *bmColor, pVer CamVertex, pMesh m)
+{
+	rb->SetCamera(rb, CamVertex);
+	rb->DrawMesh(rb, m);
+	if( bmColor )
+		rb->ReadColor(rb, bmColor);
+	rb->ReadDepth(rb, bmBits);
+}
+
+// render a packed silhouette to memory
+LFD_API void RenderViewMaskMesh(pRenderBackend rb, unsigned __int64 *Mask, pVer CamVertex, pMesh m)
+{
+	rb->SetCamera(rb, CamVertex);
+	rb->DrawMesh(rb, m);
+	rb->ReadMask(rb, Mask);
+}
+
+// upload a mesh once, and then RenderViewMesh() of the same mesh draws it by one call
+// call it again if the mesh is changed, and UnloadMesh() before the mesh is freed
+LFD_API void UploadMesh(pRenderBackend rb, pMesh m)
+{
+	rb->LoadMesh(rb, m);
+}
+
+LFD_API void UnloadMesh(pRenderBackend rb)
+{
+	rb->UnloadMesh(rb);
+}
+
+// ************************************************************************************************
+// polygons of ReadObj(), converted to a mesh unless they are loaded by LoadMesh()
+
+// the same with LoadMesh() and UnloadMesh() of the converted mesh
+LFD_API void LoadMesh(pRenderBackend rb, pVer v, pTri t, int nv, int nt)
+{
+	rb->LoadMesh(rb, MeshFromPolygons(v, t, nv, nt));
+	rb->mesh.OwnMesh = 1;
+	rb->mesh.v = v;
+	rb->mesh.t = t;
+	rb->mesh.nv = nv;
+	rb->mesh.nt = nt;
+}
+
+static void RenderPolygons(pRenderBackend rb, unsigned char *bmBits, unsigned char *bmColor, unsigned __int64 *Mask,
+						   pVer CamVertex, pVer v, pTri t, int nv, int nt)
+{
+	pMesh			m;
+
+	if( v && v == rb->mesh.v && t == rb->mesh.t && nv == rb->mesh.nv && nt == rb->mesh.nt )
+		m = rb->mesh.m;
+	else
+		m = MeshFromPolygons(v, t, nv, nt);
+
+	if( Mask )
+		RenderViewMaskMesh(rb, Mask, CamVertex, m);
+	else
+		RenderViewMesh(rb, bmBits, bmColor, CamVertex, m);
+
+	if( m != rb->mesh.m )
+	{
+		FreeMesh(m);
+		rb->m = NULL;		// nothing to be redrawn
+	}
+}
+
+LFD_API void RenderView(pRenderBackend rb, unsigned char *bmBits, unsigned char *bmColor, pVer CamVertex, pVer v, pTri t, int nv, int nt)
+{
+	RenderPolygons(rb, bmBits, bmColor, NULL, CamVertex, v, t, nv, nt);
+}
+
+LFD_API void RenderViewMask(pRenderBackend rb, unsigned __int64 *Mask, pVer CamVertex, pVer v, pTri t, int nv, int nt)
+{
+	RenderPolygons(rb, NULL, NULL, Mask, CamVertex, v, t, nv, nt);
+}
@@ -0,0 +1,9 @@
+LFD_API pRenderBackend CreateRenderBackend(int type);
+LFD_API void FreeRenderBackend(pRenderBackend rb);
+LFD_API void RenderViewMesh(pRenderBackend rb, unsigned char *bmBits, unsigned char *bmColor, pVer CamVertex, pMesh m);
+LFD_API void RenderViewMaskMesh(pRenderBackend rb, unsigned __int64 *Mask, pVer CamVertex, pMesh m);
+LFD_API void UploadMesh(pRenderBackend rb, pMesh m);
+LFD_API void UnloadMesh(pRenderBackend rb);
+LFD_API void LoadMesh(pRenderBackend rb, pVer v, pTri t, int nv, int nt);
+LFD_API void RenderView(pRenderBackend rb, unsigned char *bmBits, unsigned char *bmColor, pVer CamVertex, pVer v, pTri t, int nv, int nt);
+LFD_API void RenderViewMask(pRenderBackend rb, unsigned __int64 *Mask, pVer CamVertex, pVer v, pTri t, int nv, int nt);
@@ -183,3 +183,27 @@ void RotateZ(pVer SrcVer, double T, pVer DestVer, int NumVer)
 
 	Transform(SrcVer, NumVer, matrix, DestVer);
 }
+
+// the same with Rotate(), computed in double and then stored in float
+void RotateMesh(pMesh m, double **matrix)
+{
+	int			i, j, k;
+	double		sum, p[3], q[3];
+
+	for(i=0; i<m->NumVer; i++)
+	{
+		p[0] = m->x[i];
+		p[1] = m->y[i];
+		p[2] = m->z[i];
+		for(j=0; j<3; j++)
+		{
+			sum = matrix[3][j];
+			for(k=0; k<3; k++)
+				sum += p[k] * matrix[k][j];
+			q[j] = sum;
+		}
+		m->x[i] = (float)q[0];
+		m->y[i] = (float)q[1];
+		m->z[i] = (float)q[2];
+	}
+}
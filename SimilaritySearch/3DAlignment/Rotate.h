@@ -3,4 +3,5 @@ void RotateX(pVer SrcVer, double T, pVer DestVer, int NumVer);
 void RotateY(pVer SrcVer, double T, pVer DestVer, int NumVer);
 void RotateZ(pVer SrcVer, double T, pVer DestVer, int NumVer);
 void Rotate(pVer vertex, int NumVer, double **matrix);
+void RotateMesh(pMesh m, double **matrix);
 vector cross(vector v1, vector v2);
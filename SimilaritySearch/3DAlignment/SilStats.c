@@ -0,0 +1,148 @@
+#include <memory.h>
+#include <limits.h>
+
+#include "ds.h"
+
+// bounding box, center, radius, area and moments of a silhouette in one pass
+// only the first and the last pixel of each row are needed for the radius (the distance is convex),
+// and the moments about the center are from the sums of x, y, x^2, y^2 and xy
+// (all of them are integers or multiple of 0.25 here, so the result is exact, the same with summation about the center)
+
+// ***********************************************************************************************
+// if use "mean" to each 2D shape independnetly, the origin will be moved a lot in 3D
+// if ues "center" to each 2D shape independnetly, the origin will be moved only a little in 3D
+// if center can be defined in 3D, the origin will not be moved any more.
+// But this will not very robust in 3D similarity transformation
+// In addition, to make center of each 2D shape more close to user drawn 2D shapes,
+// it's better to define center for each 2D shape independently
+static void FinishSilStats(pSilStats st, int *RowMin, int *RowMax, double Sx, double Sy, double Sxx, double Syy, double Sxy)
+{
+	int			y;
+	double		dx, dy, r2;
+
+	// uee center of max and min to be center
+	if( st->MaxX > 0 )
+	{
+		st->CenX = (st->MaxX+st->MinX) / 2.0;
+		st->CenY = (st->MaxY+st->MinY) / 2.0;
+	}
+	else
+		st->CenX = st->CenY = -1;		// nothing to be rendered
+
+	st->MaxR2 = 0;
+	for(y=st->MinY; y<=st->MaxY; y++)
+		if( RowMax[y] >= 0 )
+		{
+			dy = y - st->CenY;
+			dx = RowMin[y] - st->CenX;
+			r2 = dx * dx + dy * dy;
+			if( r2 > st->MaxR2 )
+				st->MaxR2 = r2;
+			dx = RowMax[y] - st->CenX;
+			r2 = dx * dx + dy * dy;
+			if( r2 > st->MaxR2 )
+				st->MaxR2 = r2;
+		}
+
+	st->i20 = Sxx - 2 * st->CenX * Sx + st->count * st->CenX * st->CenX;
+	st->i02 = Syy - 2 * st->CenY * Sy + st->count * st->CenY * st->CenY;
+	st->i11 = Sxy - st->CenX * Sy - st->CenY * Sx + st->count * st->CenX * st->CenY;
+}
+
+// depth buffer (WIDTH * HEIGHT), 8 pixels of background are skipped at a time
+LFD_API void GetSilStats(unsigned char *Y, pSilStats st)
+{
+	int					x, y, k, n, sx, sxx;
+	int					RowMin[HEIGHT], RowMax[HEIGHT];
+	double				Sx, Sy, Sxx, Syy, Sxy;
+	unsigned char		*pRow;
+	unsigned __int64	word, all;
+
+	all = ~(unsigned __int64)0;
+	st->count = 0;
+	st->MinX = st->MinY = INT_MAX;
+	st->MaxX = st->MaxY = -1;
+	Sx = Sy = Sxx = Syy = Sxy = 0;
+	for(y=0; y<HEIGHT; y++)
+	{
+		pRow = Y + y * WIDTH;
+		RowMax[y] = -1;
+		n = sx = sxx = 0;
+		for(k=0; k<WIDTH; k+=8)
+		{
+			memcpy(&word, pRow+k, sizeof(unsigned __int64));
+			if( word == all )
+				continue;
+			for(x=k; x<k+8; x++)
+				if( pRow[x] < 255 )
+				{
+					if( RowMax[y] < 0 )
+						RowMin[y] = x;
+					RowMax[y] = x;
+					n ++;
+					sx += x;
+					sxx += x * x;
+				}
+		}
+		if( n == 0 )
+			continue;
+
+		if( RowMin[y] < st->MinX )	st->MinX = RowMin[y];
+		if( RowMax[y] > st->MaxX )	st->MaxX = RowMax[y];
+		if( y < st->MinY )			st->MinY = y;
+		st->MaxY = y;
+		st->count += n;
+		Sx += sx;
+		Sxx += sxx;
+		Sy += (double)n * y;
+		Syy += (double)n * y * y;
+		Sxy += (double)sx * y;
+	}
+
+	FinishSilStats(st, RowMin, RowMax, Sx, Sy, Sxx, Syy, Sxy);
+}
+
+// the same with GetSilStats(), from spans (GetSpans() or GetSpansMask())
+// the sum of x and x^2 of a span are in closed form
+LFD_API void GetSilStatsSpan(pSilSpans sp, pSilStats st)
+{
+	int					y, i, n, sx, sxx, a, b;
+	int					RowMin[HEIGHT], RowMax[HEIGHT];
+	double				Sx, Sy, Sxx, Syy, Sxy;
+
+	st->count = 0;
+	st->MinX = st->MinY = INT_MAX;
+	st->MaxX = st->MaxY = -1;
+	Sx = Sy = Sxx = Syy = Sxy = 0;
+	for(y=0; y<HEIGHT; y++)
+	{
+		RowMax[y] = -1;
+		if( sp->RowStart[y] == sp->RowStart[y+1] )
+			continue;
+
+		n = sx = sxx = 0;
+		for(i=sp->RowStart[y]; i<sp->RowStart[y+1]; i++)
+		{
+			a = sp->x0[i] - 1;
+			b = sp->x1[i];
+			n += b - a;
+			sx += ( b * (b+1) - a * (a+1) ) / 2;
+			sxx += ( b * (b+1) * (2*b+1) - a * (a+1) * (2*a+1) ) / 6;
+		}
+		RowMin[y] = sp->x0[sp->RowStart[y]];
+		RowMax[y] = sp->x1[sp->RowStart[y+1]-1];
+
+		if( RowMin[y] < st->MinX )	st->MinX = RowMin[y];
+		if( RowMax[y] > st->MaxX )	st->MaxX = RowMax[y];
+		if( y < st->MinY )			st->MinY = y;
+		st->MaxY = y;
+		st->count += n;
+		Sx += sx;
+		Sxx += sxx;
+		Sy += (double)n * y;
+		Syy += (double)n * y * y;
+		Sxy += (double)sx * y;
+	}
+
+	FinishSilStats(st, RowMin, RowMax, Sx, Sy, Sxx, Syy, Sxy);
+}
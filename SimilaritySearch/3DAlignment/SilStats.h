@@ -0,0 +1,2 @@
+LFD_API void GetSilStats(unsigned char *Y, pSilStats st);
+LFD_API void GetSilStatsSpan(pSilSpans sp, pSilStats st);
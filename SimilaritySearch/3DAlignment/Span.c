@@ -0,0 +1,169 @@
+#include <memory.h>
+
+#include "ds.h"
+#include "BitMask.h"
+
+// run-length silhouette: each rendered view is converted once to the foreground spans of each row,
+// and then area, bounding box, moments, perimeter, contour start and ART run over spans instead of pixels
+
+// depth buffer (WIDTH * HEIGHT) to spans, 8 pixels of background are skipped at a time
+LFD_API void GetSpans(unsigned char *Y, pSilSpans sp)
+{
+	int					x, y, k, in, n;
+	unsigned char		*pRow;
+	unsigned __int64	word, all;
+
+	all = ~(unsigned __int64)0;
+	n = 0;
+	for(y=0; y<HEIGHT; y++)
+	{
+		sp->RowStart[y] = n;
+		pRow = Y + y * WIDTH;
+		in = 0;
+		for(k=0; k<WIDTH; k+=8)
+		{
+			memcpy(&word, pRow+k, sizeof(unsigned __int64));
+			if( word == all && !in )
+				continue;
+			for(x=k; x<k+8; x++)
+				if( pRow[x] < 255 )
+				{
+					if( !in )
+					{
+						sp->x0[n] = x;
+						in = 1;
+					}
+				}
+				else if( in )
+				{
+					sp->x1[n++] = x - 1;
+					in = 0;
+				}
+		}
+		if( in )
+			sp->x1[n++] = WIDTH - 1;
+	}
+	sp->RowStart[HEIGHT] = sp->NumSpan = n;
+}
+
+// packed silhouette to spans, the runs of bits are found by the lowest bit set (or clear)
+LFD_API void GetSpansMask(unsigned __int64 *Mask, pSilSpans sp)
+{
+	int					y, w, pos, in, n;
+	unsigned __int64	*pRow, rest, all;
+
+	all = ~(unsigned __int64)0;
+	n = 0;
+	for(y=0; y<HEIGHT; y++)
+	{
+		sp->RowStart[y] = n;
+		pRow = Mask + y * MASK_WORDS;
+		in = 0;
+		for(w=0; w<MASK_WORDS; w++)
+			for(pos=0; pos<64; )
+			{
+				// the next bit which is different from "in"
+				rest = ( in ? ~pRow[w] : pRow[w] ) & ( all << pos );
+				if( rest == 0 )
+					break;
+				pos = LowBit64(rest);
+				if( in )
+					sp->x1[n++] = (w << 6) + pos - 1;
+				else
+					sp->x0[n] = (w << 6) + pos;
+				in = !in;
+			}
+		if( in )
+			sp->x1[n++] = WIDTH - 1;
+	}
+	sp->RowStart[HEIGHT] = sp->NumSpan = n;
+}
+
+// position (y * WIDTH + x) of the first foreground pixel, the same with GetStart()
+int GetStartSpan(pSilSpans sp)
+{
+	int		y;
+
+	if( sp->NumSpan == 0 )
+		return -1;
+	for(y=0; sp->RowStart[y+1]==0; y++)
+		;
+	return y * WIDTH + sp->x0[0];
+}
+
+// intersection of two span lists of a row, saved in (x0, x1), return the number of spans
+static int IntersectSpans(short *a0, short *a1, int na, short *b0, short *b1, int nb, short *x0, short *x1)
+{
+	int		i, j, n, lo, hi;
+
+	i = j = n = 0;
+	while( i < na && j < nb )
+	{
+		lo = a0[i] > b0[j] ? a0[i] : b0[j];
+		hi = a1[i] < b1[j] ? a1[i] : b1[j];
+		if( lo <= hi )
+		{
+			x0[n] = lo;
+			x1[n] = hi;
+			n ++;
+		}
+		if( a1[i] < b1[j] )
+			i ++;
+		else
+			j ++;
+	}
+	return n;
+}
+
+// the pixels whose left and right neighbors (inside the image) are also foreground
+static int ShrinkSpans(pSilSpans sp, int y, short *x0, short *x1)
+{
+	int		i, n;
+
+	for(i=sp->RowStart[y], n=0; i<sp->RowStart[y+1]; i++)
+	{
+		x0[n] = sp->x0[i] > 0 ? sp->x0[i] + 1 : 0;
+		x1[n] = sp->x1[i] < WIDTH-1 ? sp->x1[i] - 1 : WIDTH-1;
+		if( x0[n] <= x1[n] )
+			n ++;
+	}
+	return n;
+}
+
+// the number of edge pixels of EdgeDetectSil(): the foreground pixel with background in the 8-neighbors
+// (pixels outside the image are not background), a pixel is inner if the 3 shrinked rows contain it
+int SpanPerimeter(pSilSpans sp)
+{
+	int		y, i, n, nMid, nUp, nDown, inner, area;
+	short	Mid0[WIDTH/2+1], Mid1[WIDTH/2+1], Up0[WIDTH/2+1], Up1[WIDTH/2+1];
+	short	Down0[WIDTH/2+1], Down1[WIDTH/2+1], Tmp0[WIDTH/2+1], Tmp1[WIDTH/2+1];
+
+	area = inner = 0;
+	for(y=0; y<HEIGHT; y++)
+	{
+		if( sp->RowStart[y] == sp->RowStart[y+1] )
+			continue;
+		for(i=sp->RowStart[y]; i<sp->RowStart[y+1]; i++)
+			area += sp->x1[i] - sp->x0[i] + 1;
+
+		nMid = ShrinkSpans(sp, y, Mid0, Mid1);
+		if( y > 0 )
+		{
+			nUp = ShrinkSpans(sp, y-1, Up0, Up1);
+			nMid = IntersectSpans(Mid0, Mid1, nMid, Up0, Up1, nUp, Tmp0, Tmp1);
+			memcpy(Mid0, Tmp0, nMid * sizeof(short));
+			memcpy(Mid1, Tmp1, nMid * sizeof(short));
+		}
+		if( y < HEIGHT-1 )
+		{
+			nDown = ShrinkSpans(sp, y+1, Down0, Down1);
+			nMid = IntersectSpans(Mid0, Mid1, nMid, Down0, Down1, nDown, Tmp0, Tmp1);
+			memcpy(Mid0, Tmp0, nMid * sizeof(short));
+			memcpy(Mid1, Tmp1, nMid * sizeof(short));
+		}
+		for(n=0; n<nMid; n++)
+			inner += Mid1[n] - Mid0[n] + 1;
+	}
+
+	return area - inner;
+}
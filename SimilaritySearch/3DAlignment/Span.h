@@ -0,0 +1,4 @@
+LFD_API void GetSpans(unsigned char *Y, pSilSpans sp);
+LFD_API void GetSpansMask(unsigned __int64 *Mask, pSilSpans sp);
+int GetStartSpan(pSilSpans sp);
+int SpanPerimeter(pSilSpans sp);
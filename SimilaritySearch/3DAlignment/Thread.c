@@ -0,0 +1,422 @@
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <time.h>
+#endif
+#include <malloc.h>
+
+#include "ds.h"
+
+// a thread of RunThreads()
+typedef struct ThreadArg_ {
+	void			(*Work)(void *Param, int id);
+	void			*Param;
+	int				id;
+}ThreadArg;
+
+#ifdef _WIN32
+static DWORD WINAPI ThreadProc(LPVOID p)
+{
+	ThreadArg	*arg = (ThreadArg *)p;
+
+	arg->Work(arg->Param, arg->id);
+	return 0;
+}
+#else
+static void *ThreadProc(void *p)
+{
+	ThreadArg	*arg = (ThreadArg *)p;
+
+	arg->Work(arg->Param, arg->id);
+	return NULL;
+}
+#endif
+
+// number of processors, at most MAX_THREAD
+LFD_API int GetCpuNum()
+{
+	int				n;
+#ifdef _WIN32
+	SYSTEM_INFO		si;
+
+	GetSystemInfo(&si);
+	n = (int)si.dwNumberOfProcessors;
+#else
+	n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	if( n < 1 )				n = 1;
+	if( n > MAX_THREAD )	n = MAX_THREAD;
+	return n;
+}
+
+// run Work(Param, id) for id = 0 ~ NumThread-1 concurrently, and return after all of them finish
+// id 0 runs in the calling thread
+LFD_API void RunThreads(int NumThread, void (*Work)(void *Param, int id), void *Param)
+{
+	ThreadArg		arg[MAX_THREAD];
+	int				i;
+#ifdef _WIN32
+	HANDLE			h[MAX_THREAD];
+#else
+	pthread_t		h[MAX_THREAD];
+	int				ok[MAX_THREAD];
+#endif
+
+	if( NumThread > MAX_THREAD )
+		NumThread = MAX_THREAD;
+
+	for(i=0; i<NumThread; i++)
+	{
+		arg[i].Work = Work;
+		arg[i].Param = Param;
+		arg[i].id = i;
+	}
+
+	// if a thread can't be created, run its work in the calling thread
+	for(i=1; i<NumThread; i++)
+	{
+#ifdef _WIN32
+		h[i] = CreateThread(NULL, 0, ThreadProc, arg+i, 0, NULL);
+		if( h[i] == NULL )
+			Work(Param, i);
+#else
+		ok[i] = pthread_create(h+i, NULL, ThreadProc, arg+i) == 0;
+		if( !ok[i] )
+			Work(Param, i);
+#endif
+	}
+
+	if( NumThread > 0 )
+		Work(Param, 0);
+
+	for(i=1; i<NumThread; i++)
+	{
+#ifdef _WIN32
+		if( h[i] )
+		{
+			WaitForSingleObject(h[i], INFINITE);
+			CloseHandle(h[i]);
+		}
+#else
+		if( ok[i] )
+			pthread_join(h[i], NULL);
+#endif
+	}
+}
+
+// workers of RunPool(), started once and waiting for the work of each call
+struct ThreadPool_ {
+	int					NumThread;
+	void				(*Work)(void *Param, int id);
+	void				*Param;
+	int					Round;			// increased by each RunPool(), a worker runs the work once for a new round
+	int					Busy;			// workers not finished the round
+	int					Quit;
+	ThreadArg			arg[MAX_THREAD];
+#ifdef _WIN32
+	CRITICAL_SECTION	lock;
+	CONDITION_VARIABLE	start, done;
+	HANDLE				h[MAX_THREAD];
+#else
+	pthread_mutex_t		lock;
+	pthread_cond_t		start, done;
+	pthread_t			h[MAX_THREAD];
+	int					ok[MAX_THREAD];
+#endif
+};
+
+#ifdef _WIN32
+	#define	POOL_LOCK(p)			EnterCriticalSection(&(p)->lock)
+	#define	POOL_UNLOCK(p)			LeaveCriticalSection(&(p)->lock)
+	#define	POOL_WAIT(p, c)			SleepConditionVariableCS(&(p)->c, &(p)->lock, INFINITE)
+	#define	POOL_WAKE_ALL(p, c)		WakeAllConditionVariable(&(p)->c)
+	#define	POOL_STARTED(p, i)		( (p)->h[i] != NULL )
+#else
+	#define	POOL_LOCK(p)			pthread_mutex_lock(&(p)->lock)
+	#define	POOL_UNLOCK(p)			pthread_mutex_unlock(&(p)->lock)
+	#define	POOL_WAIT(p, c)			pthread_cond_wait(&(p)->c, &(p)->lock)
+	#define	POOL_WAKE_ALL(p, c)		pthread_cond_broadcast(&(p)->c)
+	#define	POOL_STARTED(p, i)		( (p)->ok[i] )
+#endif
+
+// worker "id" of a pool, arg->Param is the pool
+static void PoolWork(void *Param, int id)
+{
+	pThreadPool		pool = (pThreadPool)Param;
+	int				round = 0;
+
+	POOL_LOCK(pool);
+	for(;;)
+	{
+		while( pool->Round == round && !pool->Quit )
+			POOL_WAIT(pool, start);
+		if( pool->Quit )
+			break;
+		round = pool->Round;
+		POOL_UNLOCK(pool);
+
+		pool->Work(pool->Param, id);
+
+		POOL_LOCK(pool);
+		if( --pool->Busy == 0 )
+			POOL_WAKE_ALL(pool, done);
+	}
+	POOL_UNLOCK(pool);
+}
+
+// start NumThread-1 workers for RunPool(), the calling thread is worker 0
+LFD_API pThreadPool CreateThreadPool(int NumThread)
+{
+	pThreadPool		pool;
+	int				i;
+
+	if( NumThread > MAX_THREAD )	NumThread = MAX_THREAD;
+	if( NumThread < 1 )				NumThread = 1;
+
+	pool = (pThreadPool) malloc (sizeof(struct ThreadPool_));
+	pool->NumThread = NumThread;
+	pool->Round = pool->Busy = pool->Quit = 0;
+#ifdef _WIN32
+	InitializeCriticalSection(&pool->lock);
+	InitializeConditionVariable(&pool->start);
+	InitializeConditionVariable(&pool->done);
+#else
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->start, NULL);
+	pthread_cond_init(&pool->done, NULL);
+#endif
+
+	// if a thread can't be created, its work is run by the calling thread
+	for(i=1; i<NumThread; i++)
+	{
+		pool->arg[i].Work = PoolWork;
+		pool->arg[i].Param = pool;
+		pool->arg[i].id = i;
+#ifdef _WIN32
+		pool->h[i] = CreateThread(NULL, 0, ThreadProc, pool->arg+i, 0, NULL);
+#else
+		pool->ok[i] = pthread_create(pool->h+i, NULL, ThreadProc, pool->arg+i) == 0;
+#endif
+	}
+
+	return pool;
+}
+
+// the same with RunThreads() by the workers of the pool, no thread is created
+LFD_API void RunPool(pThreadPool pool, void (*Work)(void *Param, int id), void *Param)
+{
+	int			i;
+
+	POOL_LOCK(pool);
+	pool->Work = Work;
+	pool->Param = Param;
+	pool->Busy = 0;
+	for(i=1; i<pool->NumThread; i++)
+		pool->Busy += POOL_STARTED(pool, i);
+	pool->Round ++;
+	POOL_WAKE_ALL(pool, start);
+	POOL_UNLOCK(pool);
+
+	Work(Param, 0);
+	for(i=1; i<pool->NumThread; i++)
+		if( !POOL_STARTED(pool, i) )
+			Work(Param, i);
+
+	POOL_LOCK(pool);
+	while( pool->Busy > 0 )
+		POOL_WAIT(pool, done);
+	POOL_UNLOCK(pool);
+}
+
+// stop and join the workers
+LFD_API void FreeThreadPool(pThreadPool pool)
+{
+	int			i;
+
+	if( pool == NULL )
+		return;
+
+	POOL_LOCK(pool);
+	pool->Quit = 1;
+	POOL_WAKE_ALL(pool, start);
+	POOL_UNLOCK(pool);
+
+	for(i=1; i<pool->NumThread; i++)
+	{
+#ifdef _WIN32
+		if( pool->h[i] )
+		{
+			WaitForSingleObject(pool->h[i], INFINITE);
+			CloseHandle(pool->h[i]);
+		}
+#else
+		if( pool->ok[i] )
+			pthread_join(pool->h[i], NULL);
+#endif
+	}
+
+#ifdef _WIN32
+	DeleteCriticalSection(&pool->lock);
+#else
+	pthread_mutex_destroy(&pool->lock);
+	pthread_cond_destroy(&pool->start);
+	pthread_cond_destroy(&pool->done);
+#endif
+	free(pool);
+}
+
+// increase Counter by 1 atomically, return the value before increment
+// used to take the next job of a job list by many threads
+LFD_API long AtomicFetchInc(volatile long *Counter)
+{
+#ifdef _WIN32
+	return InterlockedIncrement(Counter) - 1;
+#else
+	return __sync_fetch_and_add(Counter, 1);
+#endif
+}
+
+// if *Dest == Comparand, set it to Exchange atomically, return the value before (the exchange is done if it's Comparand)
+LFD_API __int64 AtomicCompareExchange64(volatile __int64 *Dest, __int64 Exchange, __int64 Comparand)
+{
+#ifdef _WIN32
+	return InterlockedCompareExchange64(Dest, Exchange, Comparand);
+#else
+	return __sync_val_compare_and_swap(Dest, Comparand, Exchange);
+#endif
+}
+
+// take a lock of a short critical section (0 is free), the waiting thread gives up its time slice to the others
+LFD_API void AcquireLock(volatile __int64 *Lock)
+{
+	while( AtomicCompareExchange64(Lock, 1, 0) != 0 )
+#ifdef _WIN32
+		SwitchToThread();
+#else
+		sched_yield();
+#endif
+}
+
+// the exchange is a full barrier, so the writes in the critical section are seen by the next owner
+LFD_API void ReleaseLock(volatile __int64 *Lock)
+{
+	AtomicCompareExchange64(Lock, 0, 1);
+}
+
+// jobs [lo, hi) of a worker in one word (lo in the low 32 bits), so that it's taken and split by one compare-exchange
+#define		RANGE(lo, hi)		( (__int64)(lo) | ( (__int64)(hi) << 32 ) )
+#define		RANGE_LO(r)			( (int)( (r) & 0xffffffff ) )
+#define		RANGE_HI(r)			( (int)( (r) >> 32 ) )
+
+typedef struct JobPool_ {
+	volatile __int64	Range[MAX_THREAD];
+	int					NumThread;
+	void				(*Job)(void *Param, int id, int job);
+	void				*Param;
+}JobPool;
+
+// atomic read of a range (64 bits are not read at once in 32-bit program), 0 is written only if it's 0
+static __int64 LoadRange(volatile __int64 *Range)
+{
+	return AtomicCompareExchange64(Range, 0, 0);
+}
+
+// take the first job of the range of worker "id", -1 if it's empty
+static int PopJob(JobPool *pool, int id)
+{
+	__int64		r;
+	int			lo, hi;
+
+	do
+	{
+		r = LoadRange(pool->Range+id);
+		lo = RANGE_LO(r);
+		hi = RANGE_HI(r);
+		if( lo >= hi )
+			return -1;
+	}while( AtomicCompareExchange64(pool->Range+id, RANGE(lo+1, hi), r) != r );
+
+	return lo;
+}
+
+// move the second half of the jobs of another worker to worker "id" (whose range is empty), 0 if all are empty
+// only the owner changes an empty range, so the new range is set by an exchange without failure
+static int StealJob(JobPool *pool, int id)
+{
+	__int64		r;
+	int			i, v, lo, hi, mid;
+
+	for(i=1; i<pool->NumThread; i++)
+	{
+		v = (id + i) % pool->NumThread;
+		r = LoadRange(pool->Range+v);
+		lo = RANGE_LO(r);
+		hi = RANGE_HI(r);
+		if( lo >= hi )
+			continue;
+		mid = hi - (hi - lo + 1) / 2;
+		if( AtomicCompareExchange64(pool->Range+v, RANGE(lo, mid), r) != r )
+		{
+			i --;		// the victim changed, try it again
+			continue;
+		}
+		r = LoadRange(pool->Range+id);
+		AtomicCompareExchange64(pool->Range+id, RANGE(mid, hi), r);
+		return 1;
+	}
+
+	return 0;
+}
+
+static void JobWork(void *Param, int id)
+{
+	JobPool		*pool = (JobPool *)Param;
+	int			job;
+
+	do
+		while( (job = PopJob(pool, id)) >= 0 )
+			pool->Job(pool->Param, id, job);
+	while( StealJob(pool, id) );
+}
+
+// run Job(Param, id, job) for job = 0 ~ NumJob-1 by NumThread workers (id = 0 ~ NumThread-1), with work stealing:
+// each worker starts with a contiguous part of the jobs and takes them in order, and the one finished first
+// takes the later half of the jobs left by another one, so that a few long jobs don't leave the others idle
+LFD_API void RunJobs(int NumThread, int NumJob, void (*Job)(void *Param, int id, int job), void *Param)
+{
+	JobPool		pool;
+	int			i;
+
+	if( NumThread > MAX_THREAD )
+		NumThread = MAX_THREAD;
+	if( NumThread < 1 )
+		NumThread = 1;
+
+	pool.NumThread = NumThread;
+	pool.Job = Job;
+	pool.Param = Param;
+	for(i=0; i<NumThread; i++)
+		pool.Range[i] = RANGE( (__int64)NumJob * i / NumThread, (__int64)NumJob * (i+1) / NumThread );
+
+	RunThreads(NumThread, JobWork, &pool);
+}
+
+// wall clock time in second, clock() is CPU time of all threads in some platforms
+LFD_API double WallClock()
+{
+#ifdef _WIN32
+	LARGE_INTEGER	freq, count;
+
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (double)count.QuadPart / (double)freq.QuadPart;
+#else
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
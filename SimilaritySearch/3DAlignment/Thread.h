@@ -0,0 +1,11 @@
+LFD_API int GetCpuNum();
+LFD_API void RunThreads(int NumThread, void (*Work)(void *Param, int id), void *Param);
+LFD_API pThreadPool CreateThreadPool(int NumThread);
+LFD_API void RunPool(pThreadPool pool, void (*Work)(void *Param, int id), void *Param);
+LFD_API void FreeThreadPool(pThreadPool pool);
+LFD_API long AtomicFetchInc(volatile long *Counter);
+LFD_API __int64 AtomicCompareExchange64(volatile __int64 *Dest, __int64 Exchange, __int64 Comparand);
+LFD_API void AcquireLock(volatile __int64 *Lock);
+LFD_API void ReleaseLock(volatile __int64 *Lock);
+LFD_API void RunJobs(int NumThread, int NumJob, void (*Job)(void *Param, int id, int job), void *Param);
+LFD_API double WallClock();
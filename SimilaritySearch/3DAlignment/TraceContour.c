@@ -1,7 +1,10 @@
 #include <stdio.h>
 #include <memory.h>
+#include <math.h>
 #include "bitmap.h"
 #include "ds.h"
+#include "BitMask.h"
+#include "Span.h"
 
 int GetStart(unsigned char *Y, int width, int height)
 {
@@ -14,9 +17,77 @@ int GetStart(unsigned char *Y, int width, int height)
 	return -1;
 }
 
+// foreground test of the pixel at "pos", for image and packed silhouette
+static int IsForeground(void *Image, int pos)
+{
+	return ((unsigned char *)Image)[pos] < 255;
+}
+
+static int IsForegroundMask(void *Image, int pos)
+{
+	return (int)( ( ((unsigned __int64 *)Image)[pos>>6] >> (pos & 63) ) & 1 );
+}
+
+static int Trace(sPOINT *Contour, unsigned char *ContourMask, void *Y, int (*IsFg)(void *, int), int start, int width, int height);
+
 // input is a 1D array
 // the boundary of the input image should be white (background) to avoid overflow
 int TraceContour(sPOINT *Contour, unsigned char *ContourMask, unsigned char *Y, int width, int height)
+{
+	return Trace(Contour, ContourMask, Y, IsForeground, GetStart(Y, width, height), width, height);
+}
+
+// chain code of the contour (the last point is the start), the area is from the shoelace formula
+// of the pixel centers and Pick's theorem (A = I + B/2 - 1), exact if the contour is simple
+static void ChainCode(pContourStats cs, sPOINT *Contour, int num)
+{
+	int		k, dx, dy;
+	double	twice;
+
+	cs->NumStraight = cs->NumDiagonal = 0;
+	cs->area = 0;
+	cs->MultiPart = 0;
+	if( num < 2 )
+		return ;
+
+	twice = 0;
+	for(k=0; k<num-1; k++)
+	{
+		dx = Contour[k+1].x - Contour[k].x;
+		dy = Contour[k+1].y - Contour[k].y;
+		if( dx != 0 && dy != 0 )
+			cs->NumDiagonal ++;
+		else
+			cs->NumStraight ++;
+		twice += (double)Contour[k].x * Contour[k+1].y - (double)Contour[k+1].x * Contour[k].y;
+	}
+	cs->area = fabs(twice) / 2 + ( num - 1 ) / 2.0 + 1;
+}
+
+// the same with TraceContour() (WIDTH * HEIGHT), the start is the first span of the silhouette
+// the chain code is saved to "cs" if it's not NULL
+int TraceContourSpan(sPOINT *Contour, unsigned char *ContourMask, unsigned char *Y, pSilSpans sp, pContourStats cs)
+{
+	int		num;
+
+	num = Trace(Contour, ContourMask, Y, IsForeground, GetStartSpan(sp), WIDTH, HEIGHT);
+	if( cs )
+		ChainCode(cs, Contour, num);
+	return num;
+}
+
+// the same with TraceContourSpan(), for packed silhouette
+int TraceContourMaskSpan(sPOINT *Contour, unsigned char *ContourMask, unsigned __int64 *Mask, pSilSpans sp, pContourStats cs)
+{
+	int		num;
+
+	num = Trace(Contour, ContourMask, Mask, IsForegroundMask, GetStartSpan(sp), WIDTH, HEIGHT);
+	if( cs )
+		ChainCode(cs, Contour, num);
+	return num;
+}
+
+static int Trace(sPOINT *Contour, unsigned char *ContourMask, void *Y, int (*IsFg)(void *, int), int start, int width, int height)
 {
 	//	dirP[0~3] denote down, right, up, left
 	//	dirP[x][0~2] denote P1, P2 and P3
@@ -25,10 +96,10 @@ int TraceContour(sPOINT *Contour, unsigned char *ContourMask, unsigned char *Y,
 	int		nextDir[4][3] = { {3,0,0}, {0,1,1}, {1,2,2}, {2,3,3}};
 
 	int		curPos, curDir;
-	int		i, j, start, walk, mayLoss;
+	int		i, j, walk, mayLoss;
 	int		count;
 
-	if( (start = GetStart(Y, width, height)) < 0 )
+	if( start < 0 )
 		return -1;		// error, no pixel exists
 
 	// there are three case may miss some part (b: background; s: start point; v: foreground)
@@ -37,7 +108,7 @@ int TraceContour(sPOINT *Contour, unsigned char *ContourMask, unsigned char *Y,
 	// v b v    v b b    v b v
 	// and there are no cicle from left 'v' to right 'v'
 	// set mayLoss=1 if in one of the three case
-	if( Y[start+width-1]<255 && Y[start+width]==255 && (Y[start+width+1]<255 || Y[start+1]<255 ) )
+	if( IsFg(Y, start+width-1) && !IsFg(Y, start+width) && ( IsFg(Y, start+width+1) || IsFg(Y, start+1) ) )
 		mayLoss = 1;
 	else
 		mayLoss = 0;
@@ -59,7 +130,7 @@ int TraceContour(sPOINT *Contour, unsigned char *ContourMask, unsigned char *Y,
 		for(j=0; j<4; j++)
 		{
 			for(i=0; i<3; i++)
-				if( Y[ curPos + nextPos[curDir][i] ] < 255 )
+				if( IsFg(Y, curPos + nextPos[curDir][i]) )
 				{
 					curPos += nextPos[curDir][i];
 					curDir = nextDir[curDir][i];
@@ -1,2 +1,4 @@
 int TraceContour(sPOINT *Contour, unsigned char *ContourMask, unsigned char *Y, int width, int height);
+int TraceContourSpan(sPOINT *Contour, unsigned char *ContourMask, unsigned char *Y, pSilSpans sp, pContourStats cs);
+int TraceContourMaskSpan(sPOINT *Contour, unsigned char *ContourMask, unsigned __int64 *Mask, pSilSpans sp, pContourStats cs);
 ;
@@ -4,6 +4,12 @@
 
 #include "ds.h"
 
+// SIMD for the interior of the image, the border is the same with the scalar one
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define EDGE_SSE2
+#endif
+
 typedef struct POINT_
 {
 	int x, y;
@@ -27,6 +33,51 @@ int MaskValue(unsigned char *r, POINT ImageSize, int j, int k, int l, int MaskNu
 	return (int)(tmp+0.5);
 }
 
+// Sobel of a pixel not at the border, the same with two MaskValue() and sqrt in GRAYSCALEEdgeSobel()
+// the weights and pixels are integer, so that (int)(tmp+0.5) is tmp+1 for a negative tmp
+static unsigned char SobelPixel(unsigned char *p, int width)
+{
+	int		x, y, tmp;
+
+	x = ( p[width-1] - p[-width-1] ) + 2 * ( p[width] - p[-width] ) + ( p[width+1] - p[-width+1] );
+	y = ( p[-width+1] - p[-width-1] ) + 2 * ( p[1] - p[-1] ) + ( p[width+1] - p[width-1] );
+	x += ( x < 0 );
+	y += ( y < 0 );
+	tmp = (int)sqrt( x*x + y*y );
+	return ( tmp > 255 ) ? 255 : tmp;
+}
+
+#if defined(EDGE_SSE2)
+// 8 pixels to 16-bit
+static __inline __m128i Load8(unsigned char *p)
+{
+	return _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *)p), _mm_setzero_si128());
+}
+
+// SobelPixel() of 8 pixels, floor of the float sqrt is exact for the integer < 2^21 here,
+// and the saturation of packing is the clamp to 255
+static __inline void Sobel8(unsigned char *dest, unsigned char *p, int width)
+{
+	__m128i		ul, u, ur, l, r, dl, d, dr, x, y, lo, hi;
+
+	ul = Load8(p-width-1);	u = Load8(p-width);		ur = Load8(p-width+1);
+	l = Load8(p-1);								r = Load8(p+1);
+	dl = Load8(p+width-1);	d = Load8(p+width);		dr = Load8(p+width+1);
+
+	x = _mm_add_epi16(_mm_add_epi16(_mm_sub_epi16(dl, ul), _mm_sub_epi16(dr, ur)), _mm_slli_epi16(_mm_sub_epi16(d, u), 1));
+	y = _mm_add_epi16(_mm_add_epi16(_mm_sub_epi16(ur, ul), _mm_sub_epi16(dr, dl)), _mm_slli_epi16(_mm_sub_epi16(r, l), 1));
+	x = _mm_sub_epi16(x, _mm_srai_epi16(x, 15));
+	y = _mm_sub_epi16(y, _mm_srai_epi16(y, 15));
+
+	lo = _mm_unpacklo_epi16(x, y);
+	hi = _mm_unpackhi_epi16(x, y);
+	lo = _mm_cvttps_epi32(_mm_sqrt_ps(_mm_cvtepi32_ps(_mm_madd_epi16(lo, lo))));
+	hi = _mm_cvttps_epi32(_mm_sqrt_ps(_mm_cvtepi32_ps(_mm_madd_epi16(hi, hi))));
+	lo = _mm_packs_epi32(lo, hi);
+	_mm_storel_epi64((__m128i *)dest, _mm_packus_epi16(lo, lo));
+}
+#endif
+
 void GRAYSCALEEdgeSobel(unsigned char *dest, unsigned char *src, POINT ImageSize)
 {
 	int		TotalSize = ImageSize.x * ImageSize.y;
@@ -54,6 +105,17 @@ void GRAYSCALEEdgeSobel(unsigned char *dest, unsigned char *src, POINT ImageSize
 	for(j=0, l=0; j<TotalSize; j+=ImageSize.x, l++)
 		for(k=0; k<ImageSize.x; k++)
 		{
+			// the interior is done by SobelPixel() (or Sobel8()), the mask of border pixel is out of the image
+			if( l > 0 && l < ImageSize.y-1 && k > 0 && k < ImageSize.x-1 )
+			{
+#if defined(EDGE_SSE2)
+				for(; k+8<=ImageSize.x-1; k+=8)
+					Sobel8(dest+j+k, src+j+k, ImageSize.x);
+#endif
+				for(; k<ImageSize.x-1; k++)
+					*(dest+j+k) = SobelPixel(src+j+k, ImageSize.x);
+			}
+
 			x = MaskValue(src, ImageSize, j, k, l, 6, MaskCoor1, MaskWeight1);
 			y = MaskValue(src, ImageSize, j, k, l, 6, MaskCoor2, MaskWeight2);
 			tmp = (int)sqrt( x*x + y*y );
@@ -72,39 +134,75 @@ LFD_API void EdgeDetect(unsigned char *dest, unsigned char *src, int width, int
 	GRAYSCALEEdgeSobel(dest, src, ImageSize);
 }
 
+// edge of silhouette pixel (k, l), 0 is edge and 255 is not
+static unsigned char SilEdgePixel(unsigned char *src, int width, int height, int k, int l)
+{
+	int		j = l * width;
+
+	if( *(src+j+k) < 255 )	// inside
+	{
+		// enhence edge
+//		*(src+j+k) = 128;
+		if( l>0 && *(src+j+k-width) == 255 )
+			return 0;		// edge
+		if( k>0 && *(src+j+k-1) == 255 )
+			return 0;		// edge
+		if( l<height-1 && *(src+j+k+width) == 255 )
+			return 0;		// edge
+		if( k<width-1 && *(src+j+k+1) == 255 )
+			return 0;		// edge
+
+		if( l>0 && k>0 && *(src+j+k-width-1) == 255 )
+			return 0;		// edge
+		if( l>0 && k<width-1 && *(src+j+k-width+1) == 255 )
+			return 0;		// edge
+		if( l<height-1 && k>0 && *(src+j+k+width-1) == 255 )
+			return 0;		// edge
+		if( l<height-1 && k<width-1 && *(src+j+k+width+1) == 255 )
+			return 0;		// edge
+	}
+
+	// edge only
+	return 255;
+}
+
+#if defined(EDGE_SSE2)
+// background of 16 pixels, 0xff if the pixel is 255
+static __inline __m128i IsBackground16(unsigned char *p)
+{
+	return _mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)p), _mm_set1_epi8((char)0xff));
+}
+
+// 16 foreground pixels with background in the 8-neighbors, 0xff is edge
+static __inline __m128i SilEdge16(unsigned char *p, int width)
+{
+	__m128i		bg;
+
+	bg = _mm_or_si128(IsBackground16(p-width-1), IsBackground16(p-width));
+	bg = _mm_or_si128(bg, IsBackground16(p-width+1));
+	bg = _mm_or_si128(bg, IsBackground16(p-1));
+	bg = _mm_or_si128(bg, IsBackground16(p+1));
+	bg = _mm_or_si128(bg, IsBackground16(p+width-1));
+	bg = _mm_or_si128(bg, IsBackground16(p+width));
+	bg = _mm_or_si128(bg, IsBackground16(p+width+1));
+	return _mm_andnot_si128(IsBackground16(p), bg);
+}
+#endif
+
 // test edge from silhouette
+// the rows and columns at the border are checked by SilEdgePixel(), and the interior without checking
 LFD_API void EdgeDetectSil(unsigned char *edge, unsigned char *src, int width, int height)
 {
-	int		TotalSize = width * height;
-	int		j, k, l;
+	int				k, l;
 
-	for(j=0, l=0; j<TotalSize; j+=width, l++)	// y
-		for(k=0; k<width; k++)					// x
-			if( *(src+j+k) < 255 )	// inside
-			{
-				// edge only
-				*(edge+j+k) = 255;
-				// enhence edge
-//				*(src+j+k) = 128;
-				if( l>0 && *(src+j+k-width) == 255 )
-					*(edge+j+k) = 0;		// edge
-				if( k>0 && *(src+j+k-1) == 255 )
-					*(edge+j+k) = 0;		// edge
-				if( l<height-1 && *(src+j+k+width) == 255 )
-					*(edge+j+k) = 0;		// edge
-				if( k<width-1 && *(src+j+k+1) == 255 )
-					*(edge+j+k) = 0;		// edge
-
-				if( l>0 && k>0 && *(src+j+k-width-1) == 255 )
-					*(edge+j+k) = 0;		// edge
-				if( l>0 && k<width-1 && *(src+j+k-width+1) == 255 )
-					*(edge+j+k) = 0;		// edge
-				if( l<height-1 && k>0 && *(src+j+k+width-1) == 255 )
-					*(edge+j+k) = 0;		// edge
-				if( l<height-1 && k<width-1 && *(src+j+k+width+1) == 255 )
-					*(edge+j+k) = 0;		// edge
-			}
-			else						// background
-				*(edge+j+k) = 255;
+	for(l=0; l<height; l++)		// y
+		for(k=0; k<width; k++)	// x
+		{
+#if defined(EDGE_SSE2)
+			if( l > 0 && l < height-1 && k > 0 )
+				for(; k+16<=width-1; k+=16)
+					_mm_storeu_si128((__m128i *)(edge+l*width+k), _mm_xor_si128(SilEdge16(src+l*width+k, width), _mm_set1_epi8((char)0xff)));
+#endif
+			*(edge+l*width+k) = SilEdgePixel(src, width, height, k, l);
+		}
 }
-
@@ -1,72 +1,171 @@
+#include <malloc.h>
+#include <memory.h>
+
+#include "ds.h"
+#include "BitMask.h"
+#include "Arena.h"
 
 unsigned char DelTab[256] = {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0, 1, 1, 0, 1, 0, 0, 0, 0, 0, 1, 1, 0, 1, 0, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 1, 0, 1, 0, 1, 1, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 1, 1, 0, 1, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 1, 0, 1, 0, 1, 0, 1, 0, 0, 0, 1, 0, 1, 0, 1, 1, 1, 0, 1, 0, 1, 0, 1, 1, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 0, 0, 0, 1, 0, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1};
-unsigned char IsDel(unsigned char *flag, int coor, int *MaskCoor)
-{
-	int		k, index;
 
-	index = 0;
-	for(k=1; k<9; k++)
-		index += flag[coor+MaskCoor[k]] << (k-1);
+// bit-parallel thinning, the same skeleton with deleting the border pixels of each side "in parallel"
+// until nothing changes, and the same DelTab
+// each row is packed 64 pixels a word (pixel x is bit (x & 63) of word (x >> 6)), so that a neighbor of
+// 64 pixels is a shifted word, and only the border pixels of the side are looked up in DelTab
+// a word can change only if a pixel in its 3x3 neighborhood is deleted, so each side has a queue of such words
 
-	return DelTab[index];
+// neighbor at x-1 and x+1 of the 64 pixels of word j
+static unsigned __int64 West(unsigned __int64 *row, int j)
+{
+	return ( row[j] << 1 ) | ( j > 0 ? row[j-1] >> 63 : 0 );
 }
 
-int DelSide(unsigned char *flag, unsigned char *src, unsigned char *SilhMask, int width, int TotalSize, int *MaskCoor, int side)
+static unsigned __int64 East(unsigned __int64 *row, int j, int NumWord)
 {
-	int		j, k;
-	int		change;
+	return ( row[j] >> 1 ) | ( j < NumWord-1 ? row[j+1] << 63 : 0 );
+}
 
-	change = 0;
+// pixels of word j in row y to be deleted from "side" (1~4 of MaskCoor[] in Thin())
+// Fg: foreground, Bg: SilhMask is background, Inner: not the first and last column
+static unsigned __int64 DelWord(unsigned __int64 *Fg, unsigned __int64 *Bg, unsigned __int64 *Inner, int NumWord, int y, int j, int side)
+{
+	unsigned __int64	*up, *mid, *down;
+	unsigned __int64	nb[8], cand, del;
+	int					b, k, index;
 
-	// left-right, top-bottom
-	for(j=width; j<TotalSize-width; j+=width)
-		for(k=1; k<width-1; k++)
-			// if the point is border in this side, and is not a simple
-			// The deletion of border points from a given side of S should be done "in parallel"
-			if( flag[j+k] &&							// the pixel 
-				flag[j+k+MaskCoor[side]] == 0 &&		// this side is nothing (so is a border)
-				IsDel(flag, j+k, MaskCoor) &&
-				SilhMask[j+k]==255 )						// if the pixel is background
-			{
-				src[j+k] = 255;		// set to be background
-				change = 1;
-			}
+	up = Fg + (y-1) * NumWord;
+	mid = Fg + y * NumWord;
+	down = Fg + (y+1) * NumWord;
+	// the same order with MaskCoor[1~8], bit (k-1) of the index of DelTab
+	nb[0] = East(mid, j, NumWord);
+	nb[1] = up[j];
+	nb[2] = West(mid, j);
+	nb[3] = down[j];
+	nb[4] = East(down, j, NumWord);
+	nb[5] = East(up, j, NumWord);
+	nb[6] = West(up, j);
+	nb[7] = West(down, j);
 
-	// "flag" is also used for recording which pixel is foreground before doing the above loop
-	if( change )
+	// the pixel is border in this side
+	cand = mid[j] & ~nb[side-1] & Bg[y * NumWord + j] & Inner[j];
+	del = 0;
+	while( cand )
 	{
-		// left-right, top-bottom
-		for(j=width; j<TotalSize-width; j+=width)
-			for(k=1; k<width-1; k++)
-				if( flag[j+k] && src[j+k] == 255 )
-					flag[j+k] = 0;
+		b = LowBit64(cand);
+		cand &= cand - 1;
+		index = 0;
+		for(k=0; k<8; k++)
+			index |= (int)( ( nb[k] >> b ) & 1 ) << k;
+		if( DelTab[index] )
+			del |= (unsigned __int64)1 << b;
 	}
 
-	return change;
+	return del;
 }
 
 // get thin from "src", and save back to "src" and "flag"
-void Thin(unsigned char *src, unsigned char *SilhMask, unsigned char *flag, int width, int TotalSize)
+// the buffers are taken from "ar" and given back before return
+void Thin(unsigned char *src, unsigned char *SilhMask, unsigned char *flag, int width, int TotalSize, pArena ar)
 {
-	int				i, change;
+	int					i, j, k, x, y, b, s, q, change, mark;
+	int					height, NumWord, total, nDel, y0, y1, j0, j1;
+	unsigned __int64	*Fg, *Bg, *Inner, *DelBits, d;
+	int					*Queue[4], NumQueue[4], *DelIdx;
+	unsigned char		*InQueue[4];
 	//				coordinate offset of the neighborhood
 	//				7 2 6
 	//		        3 0 1
 	//			    8 4 5
-	int				MaskCoor[9] = {0, 1, -width, -1, width, 1+width, 1-width, -1-width, -1+width};
-	int				SideOrder[8] = {2, 4, 3, 1, 7, 5, 8, 6};
+	int				SideOrder[4] = {2, 4, 3, 1};
+
+	height = TotalSize / width;
+	NumWord = (width + 63) >> 6;
+	total = height * NumWord;
+
+	mark = ArenaMark(ar);
+	Fg = (unsigned __int64 *) ArenaCalloc(ar, (int)(total * sizeof(unsigned __int64)));
+	Bg = (unsigned __int64 *) ArenaCalloc(ar, (int)(total * sizeof(unsigned __int64)));
+	Inner = (unsigned __int64 *) ArenaCalloc(ar, (int)(NumWord * sizeof(unsigned __int64)));
+	DelBits = (unsigned __int64 *) ArenaAlloc(ar, (int)(total * sizeof(unsigned __int64)));
+	DelIdx = (int *) ArenaAlloc(ar, (int)(total * sizeof(int)));
 
 	// here assume the boundary is 255, foreground is <255 and >=0
-	for(i=0; i<TotalSize; i++)
-		flag[i] = (src[i]<255) ? 1 : 0;
+	for(y=0, i=0; y<height; y++)
+		for(x=0; x<width; x++, i++)
+		{
+			flag[i] = (src[i]<255) ? 1 : 0;
+			if( flag[i] )
+				Fg[y * NumWord + (x >> 6)] |= (unsigned __int64)1 << (x & 63);
+			if( SilhMask[i] == 255 )
+				Bg[y * NumWord + (x >> 6)] |= (unsigned __int64)1 << (x & 63);
+		}
+	for(x=1; x<width-1; x++)
+		Inner[x >> 6] |= (unsigned __int64)1 << (x & 63);
+
+	// all the words (except the first and last row) are checked at first
+	for(s=0; s<4; s++)
+	{
+		Queue[s] = (int *) ArenaAlloc(ar, (int)(total * sizeof(int)));
+		InQueue[s] = (unsigned char *) ArenaCalloc(ar, (int)(total * sizeof(unsigned char)));
+		NumQueue[s] = 0;
+		for(i=NumWord; i<total-NumWord; i++)
+		{
+			Queue[s][NumQueue[s]++] = i;
+			InQueue[s][i] = 1;
+		}
+	}
 
 	do	{
 		change = 0;
 
 		// 4-neighbor
-		for(i=0; i<4; i++)
-			if( DelSide(flag, src, SilhMask, width, TotalSize, MaskCoor, SideOrder[i]) )
+		for(s=0; s<4; s++)
+		{
+			// The deletion of border points from a given side of S should be done "in parallel"
+			nDel = 0;
+			for(q=0; q<NumQueue[s]; q++)
+			{
+				i = Queue[s][q];
+				InQueue[s][i] = 0;
+				d = DelWord(Fg, Bg, Inner, NumWord, i / NumWord, i % NumWord, SideOrder[s]);
+				if( d )
+				{
+					DelIdx[nDel] = i;
+					DelBits[nDel++] = d;
+				}
+			}
+			NumQueue[s] = 0;
+
+			for(q=0; q<nDel; q++)
+			{
+				i = DelIdx[q];
+				y = i / NumWord;
+				j = i % NumWord;
+				Fg[i] &= ~DelBits[q];
+				for(d=DelBits[q]; d; d&=d-1)
+				{
+					b = LowBit64(d);
+					src[y * width + (j << 6) + b] = 255;		// set to be background
+					flag[y * width + (j << 6) + b] = 0;
+				}
+
+				// check the 3x3 neighborhood again in all sides
+				y0 = y > 1 ? y-1 : 1;
+				y1 = y < height-2 ? y+1 : height-2;
+				j0 = j > 0 ? j-1 : 0;
+				j1 = j < NumWord-1 ? j+1 : NumWord-1;
+				for(y=y0; y<=y1; y++)
+					for(j=j0; j<=j1; j++)
+						for(k=0; k<4; k++)
+							if( !InQueue[k][y * NumWord + j] )
+							{
+								Queue[k][NumQueue[k]++] = y * NumWord + j;
+								InQueue[k][y * NumWord + j] = 1;
+							}
+			}
+			if( nDel )
 				change = 1;
+		}
 	}while( change );
 
+	ArenaRelease(ar, mark);
 }
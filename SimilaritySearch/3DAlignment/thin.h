@@ -1 +1 @@
-void Thin(unsigned char *src, unsigned char *SilhMask, unsigned char *area, int width, int TotalSize);
+void Thin(unsigned char *src, unsigned char *SilhMask, unsigned char *flag, int width, int TotalSize, pArena ar);
@@ -12,6 +12,7 @@
 #include <msclr\marshal_cppstd.h>
 
 #include "Face.h"
+#include "TessMesh.h"
 
 using namespace msclr::interop;
 using namespace System;
@@ -52,6 +53,35 @@ namespace SimilaritySearch
 			}
 
 			int ReadPdf3D(String^ pdf3DFileName, [Out] List<Face^>^% faceList)
+			{
+				A3DAsmModelFile* pModelFile;
+				int iRet = LoadModelFile(pdf3DFileName, pModelFile);
+				if (iRet != A3D_SUCCESS)
+					return iRet;
+
+				faceList = gcnew List<Face^>();
+				return TraverseModel(pModelFile, faceList, NULL);
+			}
+
+			/// <summary>
+			/// Read the triangles of all faces into one indexed mesh, without the managed Face objects.
+			/// The points are appended to mesh->Coords as they are in the tessellations, and the triangles index them.
+			/// </summary>
+			int ReadPdf3D(String^ pdf3DFileName, TessMesh* mesh)
+			{
+				A3DAsmModelFile* pModelFile;
+				int iRet = LoadModelFile(pdf3DFileName, pModelFile);
+				if (iRet != A3D_SUCCESS)
+					return iRet;
+
+				return TraverseModel(pModelFile, nullptr, mesh);
+			}
+
+		internal:
+			/// <summary>
+			/// Load the model of the first PRC stream of a 3D-PDF.
+			/// </summary>
+			int LoadModelFile(String^ pdf3DFileName, A3DAsmModelFile*& pModelFile)
 			{
 				if (!Init())
 				{
@@ -59,7 +89,7 @@ namespace SimilaritySearch
 					return A3D_ERROR;
 				}
 				
-				A3DAsmModelFile* pModelFile = sHoopsExchangeLoader->m_psModelFile;
+				pModelFile = sHoopsExchangeLoader->m_psModelFile;
 
 				A3DStream3DPDFData* pStream3DPDFData;
 				A3DInt32 iNumStreams;
@@ -89,11 +119,9 @@ namespace SimilaritySearch
 				CHECK_RET(A3DAsmGetFilesPathFromModelFile(sHoopsExchangeLoader->m_psModelFile, &nbFiles, &ppPaths, &nbAssemblyFiles,
 					&ppAssemblyPaths, &nbMissingFiles, &ppMissingPaths));
 
-				faceList = gcnew List<Face^>();
-				return TraverseModel(pModelFile, faceList);
+				return A3D_SUCCESS;
 			}
 
-		internal:
 			/// <summary>
 			/// Load HOOPS Exchange DLL and check if the license is valid.
 			/// </summary>
@@ -156,7 +184,7 @@ namespace SimilaritySearch
 				}
 			}
 
-			static A3DStatus TraverseModel(const A3DAsmModelFile* pModelFile, List<Face^>^% faceList)
+			static A3DStatus TraverseModel(const A3DAsmModelFile* pModelFile, List<Face^>^ faceList, TessMesh* mesh)
 			{
 				A3DStatus iRet = A3D_SUCCESS;
 				A3DAsmModelFileData sData;
@@ -167,7 +195,7 @@ namespace SimilaritySearch
 				{
 					A3DUns32 ui;
 					for (ui = 0; ui < sData.m_uiPOccurrencesSize; ++ui)
-						TraversePOccurrence(sData.m_ppPOccurrences[ui], faceList);
+						TraversePOccurrence(sData.m_ppPOccurrences[ui], faceList, mesh);
 
 					CHECK_RET(A3DAsmModelFileGet(NULL, &sData));
 				}
@@ -179,7 +207,7 @@ namespace SimilaritySearch
 				return iRet;
 			}
 
-			static A3DStatus TraversePOccurrence(const A3DAsmProductOccurrence* pOccurrence, List<Face^>^% faceList)
+			static A3DStatus TraversePOccurrence(const A3DAsmProductOccurrence* pOccurrence, List<Face^>^ faceList, TessMesh* mesh)
 			{
 				A3DStatus iRet = A3D_SUCCESS;
 				A3DAsmProductOccurrenceData sData;
@@ -195,19 +223,19 @@ namespace SimilaritySearch
 
 					if (sData.m_pPrototype)
 					{
-						TraversePOccurrence(sData.m_pPrototype, faceList);
+						TraversePOccurrence(sData.m_pPrototype, faceList, mesh);
 					}
 
 					if (sData.m_pExternalData)
 					{
-						TraversePOccurrence(sData.m_pExternalData, faceList);
+						TraversePOccurrence(sData.m_pExternalData, faceList, mesh);
 					}
 
 					for (ui = 0; ui < sData.m_uiPOccurrencesSize; ++ui)
-						TraversePOccurrence(sData.m_ppPOccurrences[ui], faceList);
+						TraversePOccurrence(sData.m_ppPOccurrences[ui], faceList, mesh);
 
 					if (sData.m_pPart)
-						TraversePartDef(sData.m_pPart, faceList);
+						TraversePartDef(sData.m_pPart, faceList, mesh);
 
 					CHECK_RET(A3DAsmProductOccurrenceGet(NULL, &sData));
 				}
@@ -219,7 +247,7 @@ namespace SimilaritySearch
 				return iRet;
 			}
 
-			static A3DStatus TraversePartDef(const A3DAsmPartDefinition* pPart, List<Face^>^% faceList)
+			static A3DStatus TraversePartDef(const A3DAsmPartDefinition* pPart, List<Face^>^ faceList, TessMesh* mesh)
 			{
 				A3DStatus iRet = A3D_SUCCESS;
 				A3DAsmPartDefinitionData sData;
@@ -232,7 +260,7 @@ namespace SimilaritySearch
 
 					for (ui = 0; ui < sData.m_uiRepItemsSize; ++ui)
 					{
-						TraverseRepItem(sData.m_ppRepItems[ui], faceList);
+						TraverseRepItem(sData.m_ppRepItems[ui], faceList, mesh);
 					}
 
 					A3DAsmPartDefinitionGet(NULL, &sData);
@@ -245,7 +273,7 @@ namespace SimilaritySearch
 				return iRet;
 			}
 
-			static A3DStatus TraverseRepItem(const A3DRiRepresentationItem* pRepItem, List<Face^>^% faceList)
+			static A3DStatus TraverseRepItem(const A3DRiRepresentationItem* pRepItem, List<Face^>^ faceList, TessMesh* mesh)
 			{
 				A3DStatus iRet = A3D_SUCCESS;
 				A3DEEntityType eType;
@@ -255,7 +283,7 @@ namespace SimilaritySearch
 				switch (eType)
 				{
 				case kA3DTypeRiBrepModel:
-					iRet = TraverseRepItemContent(pRepItem, faceList);
+					iRet = TraverseRepItemContent(pRepItem, faceList, mesh);
 					break;
 				default:
 					iRet = A3D_NOT_IMPLEMENTED;
@@ -264,7 +292,7 @@ namespace SimilaritySearch
 				return iRet;
 			}
 
-			static A3DStatus TraverseRepItemContent(const A3DRiRepresentationItem* pRi, List<Face^>^% faceList)
+			static A3DStatus TraverseRepItemContent(const A3DRiRepresentationItem* pRi, List<Face^>^ faceList, TessMesh* mesh)
 			{
 				A3DStatus iRet = A3D_SUCCESS;
 				A3DRiRepresentationItemData sData;
@@ -273,7 +301,7 @@ namespace SimilaritySearch
 				iRet = A3DRiRepresentationItemGet(pRi, &sData);
 				if (iRet == A3D_SUCCESS)
 				{
-					TraverseTessBase(sData.m_pTessBase, faceList);
+					TraverseTessBase(sData.m_pTessBase, faceList, mesh);
 
 					A3DRiRepresentationItemGet(NULL, &sData);
 				}
@@ -285,7 +313,7 @@ namespace SimilaritySearch
 				return A3D_SUCCESS;
 			}
 
-			static A3DStatus TraverseTessBase(const A3DTessBase* pTess, List<Face^>^% faceList)
+			static A3DStatus TraverseTessBase(const A3DTessBase* pTess, List<Face^>^ faceList, TessMesh* mesh)
 			{
 				A3DEEntityType eType;
 				A3DStatus iRet = A3DEntityGetType(pTess, &eType);
@@ -294,7 +322,7 @@ namespace SimilaritySearch
 					switch (eType)
 					{
 					case kA3DTypeTess3D:
-						Traverse3DTess(pTess, faceList);
+						Traverse3DTess(pTess, faceList, mesh);
 						break;
 					default:
 						break;
@@ -304,7 +332,7 @@ namespace SimilaritySearch
 				return iRet;
 			}
 
-			static A3DStatus Traverse3DTess(const A3DTess3D* pTess, List<Face^>^% faceList)
+			static A3DStatus Traverse3DTess(const A3DTess3D* pTess, List<Face^>^ faceList, TessMesh* mesh)
 			{
 				A3DTessBaseData sBaseData;
 				A3D_INITIALIZE_DATA(A3DTessBaseData, sBaseData);
@@ -316,6 +344,14 @@ namespace SimilaritySearch
 
 				if (iBaseRet == A3D_SUCCESS && iRet == A3D_SUCCESS && sData.m_bHasFaces)
 				{
+					// The points of this tessellation follow those of the previous ones in the mesh
+					A3DUns32 firstPoint = 0;
+					if (mesh != NULL)
+					{
+						firstPoint = (A3DUns32)(mesh->Coords.size() / 3);
+						mesh->Coords.insert(mesh->Coords.end(), sBaseData.m_pdCoords, sBaseData.m_pdCoords + sBaseData.m_uiCoordSize);
+					}
+
 					// Face data: From here we can retrieve the necessary data form the 3 arrays.
 					for (A3DUns32 ui = 0; ui < sData.m_uiFaceTessSize; ++ui)
 					{
@@ -341,8 +377,11 @@ namespace SimilaritySearch
 							// Number of normal per triangle
 							int normalsPerTriangle = GetNormalsPerTriangle(flags);
 
-							// Add face data for this face to the list
-							faceList->Add(CreateFaceData(indexesPerEntry, normalsPerTriangle, numberOfTriangles, startTriangulated, sBaseData, sData));
+							// Add the triangles of this face to the mesh, or face data for this face to the list
+							if (mesh != NULL)
+								AddFaceTriangles(flags, numberOfTriangles, startTriangulated, firstPoint, sData, mesh);
+							else
+								faceList->Add(CreateFaceData(indexesPerEntry, normalsPerTriangle, numberOfTriangles, startTriangulated, sBaseData, sData));
 						}
 						else
 						{
@@ -362,6 +401,51 @@ namespace SimilaritySearch
 				return iRet;
 			}
 
+			/// <summary>
+			/// Add the point indexes of the triangles of a face to the mesh, the points are not copied.
+			/// </summary>
+			static void AddFaceTriangles(A3DUns16 flags, A3DUns32 numberOfTriangles, A3DUns32 startTriangulated, A3DUns32 firstPoint,
+				const A3DTess3DData& sData, TessMesh* mesh)
+			{
+				// Layout of the indexes of a triangle (N = normal, U = UV, P = point coordinates index):
+				// kA3DTessFaceDataTriangle:					N, P		N, P		N, P
+				// kA3DTessFaceDataTriangleTextured:			N, U, P		N, U, P		N, U, P
+				// kA3DTessFaceDataTriangleOneNormal:			N, P, P, P
+				// kA3DTessFaceDataTriangleOneNormalTextured:	N, U, P, U, P, U, P
+				int entriesPerTriangle, firstP, stepP;
+				if (flags & kA3DTessFaceDataTriangle)
+				{
+					entriesPerTriangle = 6; firstP = 1; stepP = 2;
+				}
+				else if (flags & kA3DTessFaceDataTriangleTextured)
+				{
+					entriesPerTriangle = 9; firstP = 2; stepP = 3;
+				}
+				else if (flags & kA3DTessFaceDataTriangleOneNormal)
+				{
+					entriesPerTriangle = 4; firstP = 1; stepP = 1;
+				}
+				else
+				{
+					entriesPerTriangle = 7; firstP = 2; stepP = 2;
+				}
+
+				if (numberOfTriangles == 0)
+					return;
+
+				// A point index is the index of its x in A3DTessBaseData::m_pdCoords
+				size_t current = mesh->Indices.size();
+				mesh->Indices.resize(current + numberOfTriangles * 3);
+				unsigned int* indices = &mesh->Indices[0] + current;
+				const A3DUns32* entry = sData.m_puiTriangulatedIndexes + startTriangulated;
+				for (A3DUns32 ui = 0; ui < numberOfTriangles; ++ui, entry += entriesPerTriangle)
+				{
+					*indices++ = firstPoint + entry[firstP] / 3;
+					*indices++ = firstPoint + entry[firstP + stepP] / 3;
+					*indices++ = firstPoint + entry[firstP + 2 * stepP] / 3;
+				}
+			}
+
 			// ToDo: Handle normalsPerTriangle
 			static Face^ CreateFaceData(int indexesPerEntry, int normalsPerTriangle, A3DUns32 numberOfTriangles, A3DUns32 startTriangulated,
 				const A3DTessBaseData& sBaseData, const A3DTess3DData& sData)
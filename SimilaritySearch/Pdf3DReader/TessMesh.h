@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+
+/// <summary>
+/// The triangles of all faces of a 3D-PDF as one indexed mesh, native only (no managed objects in between).
+/// The points are the A3DTessBaseData::m_pdCoords of each tessellation, so that the points shared by
+/// triangles are stored once, and the triangles index them the same as HOOPS does.
+/// </summary>
+struct TessMesh
+{
+	/// <summary>
+	/// x, y, z of each point.
+	/// </summary>
+	std::vector<double> Coords;
+
+	/// <summary>
+	/// 0-based point indexes, 3 for each triangle.
+	/// </summary>
+	std::vector<unsigned int> Indices;
+};
+
+// used by the callers in the other assemblies (StartLFD)
+#pragma make_public(TessMesh)
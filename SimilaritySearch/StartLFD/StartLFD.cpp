@@ -8,26 +8,33 @@
 
 int			winw = WIDTH, winh = HEIGHT;
 
-pVer		vertex = NULL;
-pTri		triangle = NULL;
-int			NumVer = 0, NumTri = 0;		// total number of vertex and triangle.
-
-
 // translate and scale of model 1
 Ver Translate1; 
 double Scale1;
 
+// render backend, GLUT window is default, "-fbo" and "-soft" in command line render without window
+int				RenderType = RENDER_GLUT;
+pRenderBackend	Backend = NULL;
+// simplify the model to at most this number of triangles before rendering, 0 is not simplified
+int				DecimateBudget = 0;
+// workers rendering the views of the model at the same time ("-soft" only), 1 renders by the backend only
+int				NumViewThread = 1;
+// directory of the cache of normalized models, NULL is not cached
+char			*MeshCacheDir = NULL;
+// weld the points within this tolerance (relative to the size of the model), and remove the degenerate and duplicate triangles, negative is not cleaned
+double			WeldTolerance = -1;
+
 //std::ofstream pt("C:\\Program Files (x86)\\Aras\\Innovator\\Innovator\\Server\\temp\\ShapeDescriptors\\DATA_desc2.xml"); // Testenvironment server
 std::ofstream pt("D:\\DATA_desc2.xml");
 
 
-int ReadFacesFrom3DPdf(String^ pdf3dFileName, List<Face^>^% faceList)
+int ReadTessFrom3DPdf(String^ pdf3dFileName, TessMesh* tess)
 {
 	Pdf3DReaderService^ reader = nullptr;
 	try
 	{
 		reader = gcnew Pdf3DReaderService();
-		return reader->ReadPdf3D(pdf3dFileName, faceList);
+		return reader->ReadPdf3D(pdf3dFileName, tess);
 	}
 	finally
 	{
@@ -36,188 +43,87 @@ int ReadFacesFrom3DPdf(String^ pdf3dFileName, List<Face^>^% faceList)
 	}
 }
 
-// Used in Modell-method
-void FindCenter(unsigned char *srcBuff, int width, int height, double *CenX, double *CenY)
+// read the faces of a 3D-PDF as a triangle mesh, simplified to DecimateBudget triangles, translated and scaled (Translate1 and Scale1)
+int ReadMeshFrom3DPdf(String^ pdf3dFileName, pMesh *mesh)
 {
-	int					x, y, count;
-	unsigned char		*pImage;
-	int					maxX, minX, maxY, minY;
-
-	count = 0;
-	pImage = srcBuff;
-
-	// ***********************************************************************************************
-	// if use "mean" to each 2D shape independnetly, the origin will be moved a lot in 3D
-	// if ues "center" to each 2D shape independnetly, the origin will be moved only a little in 3D
-	// if center can be defined in 3D, the origin will not be moved any more.
-	// But this will not very robust in 3D similarity transformation
-	// In addition, to make center of each 2D shape more close to user drawn 2D shapes,
-	// it's better to define center for each 2D shape independently
-
-	// uee center of max and min to be center
-	maxX = maxY = -1;
-	minX = minY = INT_MAX;
-	for (y = 0; y<height; y++)
-		for (x = 0; x<width; x++)
-		{
-			if (*pImage < 255)
-			{
-				if (x > maxX) maxX = x;
-				if (x < minX) minX = x;
-				if (y > maxY) maxY = y;
-				if (y < minY) minY = y;
-			}
-			pImage++;
-		}
-
-	if (maxX > 0)
+	// the points and triangles of the tessellations as they are indexed by HOOPS
+	TessMesh tess;
+	int result = ReadTessFrom3DPdf(pdf3dFileName, &tess);
+	if (result != 0)
+		return result;
+
+	int numver = (int)(tess.Coords.size() / 3);
+	int numtri = (int)(tess.Indices.size() / 3);
+
+	// the renderer draws the triangle mesh in float, the triangles index the points of HOOPS as they are
+	*mesh = CreateMesh(numver, numtri);
+	for (int i = 0; i < numver; i++)
 	{
-		*CenX = (maxX + minX) / 2.0;
-		*CenY = (maxY + minY) / 2.0;
+		(*mesh)->x[i] = (float)tess.Coords[3 * i];
+		(*mesh)->y[i] = (float)tess.Coords[3 * i + 1];
+		(*mesh)->z[i] = (float)tess.Coords[3 * i + 2];
 	}
-	else
-		*CenX = *CenY = -1;		// nothing to be rendered
-}
-
-// used in Main
-void display(void)
-{
-	int				i, j;
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	if (numtri > 0)
+		memcpy((*mesh)->index, &tess.Indices[0], 3 * numtri * sizeof(unsigned int));
 
-	glPushMatrix();
-	//		glColor3f((GLfloat)0.0, (GLfloat)0.0, (GLfloat)0.0);
-	for (i = 0; i<NumTri; i++)
+	// the points of the seams between the faces (and tessellations) are welded
+	if (WeldTolerance >= 0)
 	{
-		glColor3f((GLfloat)triangle[i].r, (GLfloat)triangle[i].g, (GLfloat)triangle[i].b);
-		glBegin(GL_POLYGON);
-		for (j = 0; j<triangle[i].NodeName; j++)
-			glVertex3d(vertex[triangle[i].v[j]].coor[0], vertex[triangle[i].v[j]].coor[1], vertex[triangle[i].v[j]].coor[2]);
-		glEnd();
+		CleanInfo info;
+		CleanMesh(*mesh, WeldTolerance, 0, &info);
+		printf_s("\nCleaned ( V: %d -> %d, welded %d, unreferenced %d; T: %d -> %d, degenerate %d, duplicate %d )", info.NumVer, (*mesh)->NumVer,
+			info.Welded, info.Unreferenced, info.NumTri, (*mesh)->NumTri, info.Degenerate, info.Duplicate);
 	}
-	glPopMatrix();
 
-	glutSwapBuffers();
-}
+	// large CAD tessellations are simplified first, the outline of each face is kept
+	if (DecimateBudget > 0)
+		DecimateMesh(*mesh, DecimateBudget);
 
-// Used in Modell-method
-void RenderToMem(unsigned char *bmBits, unsigned char *bmColor, pVer CamVertex, pVer v, pTri t, int nv, int nt)
-{
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-	//	gluLookAt(CAMSCALE*CamVertex->coor[0], CAMSCALE*CamVertex->coor[1], CAMSCALE*CamVertex->coor[2],
-	gluLookAt(CamVertex->coor[0], CamVertex->coor[1], CamVertex->coor[2],
-		0, 0, 0,
-		0, 1, 0);
-	//				v3.x, v3.y, v3.z);
-
-	vertex = v;
-	triangle = t;
-	NumVer = nv;
-	NumTri = nt;
-	display();
-
-	glReadBuffer(GL_BACK);
-	//	glReadPixels(0, 0, winw, winh, GL_RED, GL_UNSIGNED_BYTE, bmBits);
-	glReadPixels(0, 0, winw, winh, GL_DEPTH_COMPONENT, GL_UNSIGNED_BYTE, bmBits);
-	if (bmColor)
-		glReadPixels(0, 0, winw, winh, GL_RGB, GL_UNSIGNED_BYTE, bmColor);
+	// Translate and scale model 1
+	TranslateScaleMesh(*mesh, &Translate1, &Scale1);
+	return 0;
 }
 
 // Calculate shape descriptors from given model
-bool CalculateShapeDescriptors(const std::string& currentPath, pVer vertex, int NumVer, pTri triangle, int NumTri, double src_FdCoeff[ANGLE][CAMNUM][FD_COEFF_NO], double cir_Coeff[ANGLE][CAMNUM], double ecc_Coeff[ANGLE][CAMNUM], double src_ArtCoeff[ANGLE][CAMNUM][ART_ANGULAR][ART_RADIAL])
+bool CalculateShapeDescriptors(const std::string& currentPath, pMesh mesh, double src_FdCoeff[ANGLE][CAMNUM][FD_COEFF_NO], double cir_Coeff[ANGLE][CAMNUM], double ecc_Coeff[ANGLE][CAMNUM], double src_ArtCoeff[ANGLE][CAMNUM][ART_ANGULAR][ART_RADIAL])
 {
-	unsigned char *srcBuff[CAMNUM], *ColorBuff[CAMNUM], *EdgeBuff, *YuvBuff; // CAMNNUM = 10
-	int destCam, i, srcCam;
-	int CamNumVer[ANGLE], CamNumTri[ANGLE];
-	char filename[400];
-	pVer CamVertex[ANGLE]; // type pVer only contains coord[3]
-	pTri CamTriangle[ANGLE]; // type pTri contains int vertex[15] |int NodeName | double r,g,b
+	pLfdContext		ctx[MAX_THREAD];
+	pRenderBackend	rb;
+	int				i, n;
 	clock_t	start, finish;	
 
-	// for fourier descriptor
-	sPOINT			*Contour;
-	unsigned char	*ContourMask;
-
-	double			CenX[CAMNUM], CenY[CAMNUM];
-	int				total;
-
-	// initialize ART
-	GenerateBasisLUT();
-	// initialize: read camera set
-	for (destCam = 0; destCam < ANGLE; destCam++) // #define ANGLE 10
+	// initialize ART and the other tables, read camera set, and buffers of the views
+	// worker 0 uses the backend of the program, the others render by their own software rasterizer
+	for (n = 0; n < NumViewThread; n++)
 	{
-		sprintf_s(filename, (currentPath + "/../../../3DAlignment/12_%d").c_str(), destCam);
-		if (ReadObj(filename, CamVertex + destCam, CamTriangle + destCam, CamNumVer + destCam, CamNumTri + destCam) != 1)
-			return false;
-	}
-
-	for (i = 0; i < CAMNUM; i++)
-	{
-		srcBuff[i] = (unsigned char *)malloc(winw * winh * sizeof(unsigned char));
-		ColorBuff[i] = (unsigned char *)malloc(3 * winw * winh * sizeof(unsigned char));
+		if ((rb = (n == 0) ? Backend : CreateRenderBackend(RENDER_SOFT)) == NULL)
+			break;
+		if ((ctx[n] = CreateLfdContext(rb, (char *)(currentPath + "/../../../3DAlignment/12_").c_str(), 0, 0)) == NULL)
+		{
+			if (n > 0)
+				FreeRenderBackend(rb);
+			break;
+		}
 	}
-	YuvBuff = (unsigned char *)malloc(3 * winw * winh * sizeof(unsigned char));
-	// add edge to test retrieval
-	EdgeBuff = (unsigned char *)malloc(winw * winh * sizeof(unsigned char));
-
-	// for Fourier Descriptor
-	total = winw * winh;
-	Contour = (sPOINT *)malloc(total * sizeof(sPOINT));
-	ContourMask = (unsigned char *)malloc(total * sizeof(unsigned char));
+	if (n == 0)
+		return false;
 
 	// record execute time --- start
 	start = clock();
 
-	// get the translatation and scale of the two model
-
-	// ****************************************************************
-	// Corase alignment
-	// ****************************************************************
-
-	// Translate and scale model 1
-	// fname not needed here:
-	// fname[strlen(fname) - 1] = 0x00;
-	TranslateScale(vertex, NumVer, triangle, NumTri, NULL, &Translate1, &Scale1);
+	// the model is translated and scaled by ReadMeshFrom3DPdf() or loaded from the cache
+	// Zernike moment and Fourier descriptor of all views (eccentricity and circularity are not used)
+	Console::Write("\nStart Calculating ShapeDescriptors ");
+	if (n > 1)
+		ExtractShapeViews(ctx, n, mesh, src_ArtCoeff, src_FdCoeff, NULL, NULL);
+	else
+		ExtractShape(ctx[0], mesh, src_ArtCoeff, src_FdCoeff, NULL, NULL);
 
-	// read RED only, so size is winw*winh
-	for (srcCam = 0; srcCam < ANGLE; srcCam++)
+	for (i = 0; i < n; i++)
 	{
-		// capture CAMNUM silhouette of srcfn to memory
-		for (i = 0; i<CAMNUM; i++)
-			// RenderToMem(srcBuff[i], ColorBuff[i], CamVertex[srcCam]+i, vertex1, triangle1, NumVer1, NumTri1);
-			RenderToMem(srcBuff[i], NULL, CamVertex[srcCam] + i, vertex, triangle, NumVer, NumTri);
-
-		// find center for each shape
-		for (i = 0; i<CAMNUM; i++)
-			FindCenter(srcBuff[i], winw, winh, CenX + i, CenY + i);
-
-		// get Zernike moment
-		FindRadius(srcBuff, CenX, CenY);
-		for (i = 0; i<CAMNUM; i++)
-		{
-			// from depth
-			EdgeDetect(EdgeBuff, srcBuff[i], winw, winh);
-			ExtractCoefficients(srcBuff[i], src_ArtCoeff[srcCam][i], EdgeBuff, CenX[i], CenY[i]);
-		}
-
-		Console::Write("\nStart Calculating FourierDescriptors "); Console::Write(srcCam);
-		// get Fourier descriptor
-		for (i = 0; i < CAMNUM; i++)
-		{
-		//	Console::Write(" .");
-			FourierDescriptor(src_FdCoeff[srcCam][i], srcBuff[i], winw, winh, Contour, ContourMask, CenX[i], CenY[i]);
-		}
-		// get eccentricity
-//		for (i = 0; i<CAMNUM; i++)
-	//		ecc_Coeff[srcCam][i] = Eccentricity(srcBuff[i], winw, winh, CenX[i], CenY[i]);
-
-		// get circularity
-	//	for (i = 0; i<CAMNUM; i++)
-	//	{
-	//		EdgeDetectSil(EdgeBuff, srcBuff[i], winw, winh);
-	//		cir_Coeff[srcCam][i] = Circularity(srcBuff[i], winw, winh, EdgeBuff);
-	//	}
+		if (i > 0)
+			FreeRenderBackend(ctx[i]->Backend);
+		FreeLfdContext(ctx[i]);
 	}
 
 	// record execute time --- end
@@ -226,101 +132,77 @@ bool CalculateShapeDescriptors(const std::string& currentPath, pVer vertex, int
 	return true;
 }
 
-void init(void)
-{
-	glClearColor(1.0, 1.0, 1.0, 0.0);
-	glClearDepth(1.0);
-	glEnable(GL_DEPTH_TEST);
-}
-
-void reshape(int w, int h)
-{
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
-
-	glOrtho(-1, 1, -1, 1, 0.0, 2.0);
-	glViewport(0, 0, (GLsizei)winw, (GLsizei)winh);
-
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-	gluLookAt(1, 0, 0, 0, 0, 0, 0, 1, 0);
-}
-
 int main(int argc, char** argv)
 {
-	glutInit(&argc, argv);
-
-	glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH); 
-	glutInitWindowSize(WIDTH, HEIGHT);
-	glutInitWindowPosition(100, 100);
-	glutCreateWindow(argv[0]);
-
-	init();
-	glutDisplayFunc(display);
-	glutReshapeFunc(reshape);
+	// optional "-soft" (software rasterizer) or "-fbo" (offscreen OpenGL) before the file name renders without GL window
+	// optional "-budget=N" simplifies the tessellation to at most N triangles before rendering (welded as "-weld" unless "-weld=T")
+	// optional "-threads=N" renders the views by N workers with "-soft" (0 is the number of processors)
+	// optional "-cache=DIR" keeps the normalized model in DIR, and loads it instead of the 3D-PDF next time
+	// optional "-weld" ("-weld=T") welds the points within 1e-6 (T) of the size of the model, and removes degenerate and duplicate triangles
+	while (argc > 2 && argv[1][0] == '-')
+	{
+		if (strcmp(argv[1], "-soft") == 0)
+			RenderType = RENDER_SOFT;
+		else if (strcmp(argv[1], "-fbo") == 0)
+			RenderType = RENDER_FBO;
+		else if (strncmp(argv[1], "-budget=", 8) == 0)
+			DecimateBudget = atoi(argv[1] + 8);
+		else if (strncmp(argv[1], "-threads=", 9) == 0)
+			NumViewThread = atoi(argv[1] + 9);
+		else if (strncmp(argv[1], "-cache=", 7) == 0)
+			MeshCacheDir = argv[1] + 7;
+		else if (strcmp(argv[1], "-weld") == 0)
+			WeldTolerance = WELD_TOLERANCE;
+		else if (strncmp(argv[1], "-weld=", 6) == 0)
+			WeldTolerance = atof(argv[1] + 6);
+		argv++;
+		argc--;
+	}
+	// the tessellation is welded before simplification, otherwise the faces (and the triangles of a soup) lose their triangles
+	if (DecimateBudget > 0 && WeldTolerance < 0)
+		WeldTolerance = WELD_TOLERANCE;
 
 	if (argc != 2)
 	{
 		printf_s("Please pass the path of the 3D-PDF file to be analyzed as the first parameter.");
 		return -1;
 	}
+
+	Backend = CreateRenderBackend(RenderType);
+	if (Backend == NULL)
+	{
+		printf_s("The render backend can't be created.");
+		return -1;
+	}
+	// the views are rendered by a pool of workers, or large tessellations of CAD models are rendered by all processors,
+	// the result is the same with single thread
+	if (NumViewThread <= 0)
+		NumViewThread = GetCpuNum();
+	if (NumViewThread > MAX_THREAD)
+		NumViewThread = MAX_THREAD;
+	if (RenderType != RENDER_SOFT)
+		NumViewThread = 1;
+	else if (NumViewThread == 1)
+		SetRasterThread(Backend->ras, GetCpuNum());
 	
 	// Read 3D-PDF and determine faces
 	String^ pdf3dFileName = gcnew String(argv[1]); Console::Write("3d-PDF FileName: "); Console::WriteLine(pdf3dFileName);
-	List<Face^>^ faceList = nullptr;
-	int result = ReadFacesFrom3DPdf(pdf3dFileName, faceList);
+	// a 3D-PDF indexed before is loaded from the cache without reading it again, unless the file is changed
+	pMesh mesh = NULL;
+	int result = 0;
+	if (MeshCacheDir != NULL)
+		mesh = LoadMeshCache(MeshCacheDir, argv[1], DecimateBudget, WeldTolerance, &Translate1, &Scale1);
+	if (mesh == NULL)
+	{
+		result = ReadMeshFrom3DPdf(pdf3dFileName, &mesh);
+		if (result == 0 && MeshCacheDir != NULL)
+			SaveMeshCache(MeshCacheDir, argv[1], DecimateBudget, WeldTolerance, mesh, &Translate1, Scale1);
+	}
 
 
 	// Next steps
 	if (result == 0)
 	{
-		// Translate faces into raw C
-		int numver = 0;
-		for each (Face^ face in faceList)
-		{
-			numver += face->VertexCoords->Length / 3;
-		}
-		// allocate memory of vertex
-		pVer vertex = (pVer)malloc(numver * sizeof(Ver));
-		memset(vertex, 0, numver * sizeof(Ver));
-		// Assign vertices
-		int currentVertex = 0;
-		for each (Face^ face in faceList)
-		{
-			for (int i = 0; i < face->VertexCoords->Length; i += 3)
-			{
-				vertex[currentVertex].coor[0] = (double)face->VertexCoords[i];
-				vertex[currentVertex].coor[1] = (double)face->VertexCoords[i + 1];
-				vertex[currentVertex].coor[2] = (double)face->VertexCoords[i + 2];
-
-				currentVertex++;
-			}
-		}
-
-		int numtri = 0;
-		for each (Face^ face in faceList)
-		{
-			numtri += face->VertexIndices->Length / 3;
-		}
-		// allocate memory of triangle
-		pTri triangle = (pTri)malloc(numtri * sizeof(Tri));
-		memset(triangle, 0, numtri * sizeof(Tri));
-		// Assign triangles
-		int currentTriangle = 0;
-		int previousVertexIndices = 0;
-		for each (Face^ face in faceList)
-		{
-			for (int i = 0; i < face->VertexIndices->Length; i += 3)
-			{
-				triangle[currentTriangle].v[0] = (int)face->VertexIndices[i] + previousVertexIndices;
-				triangle[currentTriangle].v[1] = (int)face->VertexIndices[i + 1] + previousVertexIndices;
-				triangle[currentTriangle].v[2] = (int)face->VertexIndices[i + 2] + previousVertexIndices;
-				triangle[currentTriangle].NodeName = 3;
-				currentTriangle++;
-			}
-			previousVertexIndices += face->VertexIndices->Length;
-		}
-
 		// Calculate shape descriptors based on image rendered by OpenGL
 		double			ecc_Coeff[ANGLE][CAMNUM];
 		double			cir_Coeff[ANGLE][CAMNUM];
@@ -330,7 +212,7 @@ int main(int argc, char** argv)
 		String^ codeBase = Assembly::GetEntryAssembly()->CodeBase;
 		System::UriBuilder^ uri = gcnew System::UriBuilder(codeBase);
 		String^ currentPath = System::IO::Path::GetDirectoryName(Uri::UnescapeDataString(uri->Path));
-		bool bResult = CalculateShapeDescriptors(marshal_as<std::string>(currentPath), vertex, numver, triangle, numtri, src_FdCoeff, cir_Coeff, ecc_Coeff, src_ArtCoeff);
+		bool bResult = CalculateShapeDescriptors(marshal_as<std::string>(currentPath), mesh, src_FdCoeff, cir_Coeff, ecc_Coeff, src_ArtCoeff);
 		
 		int q8_FdCoeff[ANGLE][CAMNUM][FD_COEFF_NO];
 
@@ -462,10 +344,11 @@ int main(int argc, char** argv)
 		} //end if pt
 
 		// free memory of 3D model
-		free(vertex);
-		free(triangle);
+		FreeMesh(mesh);
 
 	}
 
+	FreeRenderBackend(Backend);
+
 return result;
 }
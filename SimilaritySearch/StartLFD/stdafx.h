@@ -23,6 +23,9 @@
 #include <iostream>
 #include <string>
 
+// the native tessellation of Pdf3DReaderService
+#include "../Pdf3DReader/TessMesh.h"
+
 extern "C" {
 #include "../3DAlignment/ds.h"
 #include "../3DAlignment/RegionShape.h"
@@ -33,6 +36,17 @@ extern "C" {
 #include "../3DAlignment/Edge.h"
 #include "../3DAlignment/TranslateScale.h"
 #include "../3DAlignment/Bitmap.h"
+#include "../3DAlignment/Rasterize.h"
+#include "../3DAlignment/BitMask.h"
+#include "../3DAlignment/Thread.h"
+#include "../3DAlignment/Render.h"
+#include "../3DAlignment/Decimate.h"
+#include "../3DAlignment/SilStats.h"
+#include "../3DAlignment/Span.h"
+#include "../3DAlignment/Context.h"
+#include "../3DAlignment/Mesh.h"
+#include "../3DAlignment/MeshCache.h"
+#include "../3DAlignment/CleanMesh.h"
 }
 
 using namespace msclr::interop;